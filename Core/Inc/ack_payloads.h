@@ -0,0 +1,122 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "nrf24l01p.h"
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief Depth of each pipe's reply queue.
+ */
+#define ACK_QUEUE_DEPTH         4
+
+/**
+ * @brief A loaded payload older than this is flushed when it blocks another pipe.
+ */
+#define ACK_MAX_AGE_MS          250
+
+/**
+ * @brief Per-pipe ACK-payload queues over the nRF24's TX FIFO (three payloads, all pipes).
+ * @note One payload per pipe is kept loaded. A queued reply stays at the head of its
+ *       queue until an auto-ack takes it, so a flush requeues it as it is. A pipe whose
+ *       payload was flushed for age is parked until its sender is heard again.
+ *       queue() from any task; everything else from RadioTask.
+ */
+class AckPayloads
+{
+public:
+    /**
+     * @brief Builds a payload rebuilt fresh for every auto-ack (sync request, bulk
+     *        status) for a pipe with nothing queued.
+     * @param out NRF24L01P_PAYLOAD_LENGTH bytes.
+     * @return Its length; 0 if the pipe has none.
+     */
+    typedef length (*Generator)(uint8_t pipe, uint8_t* out, void* context);
+
+    struct Stats
+    {
+        uint32_t loads;             // Payloads written to the TX FIFO
+        uint32_t replies;           // Queued replies taken by an auto-ack
+        uint32_t flushes;           // FLUSH_TX forced by a payload older than ACK_MAX_AGE_MS
+        uint32_t fifo_full;         // Refills cut short by a full TX FIFO
+    };
+
+    AckPayloads();
+
+    void set_generator(Generator generator, void* context);
+
+    /**
+     * @brief Pipes that can carry ACK payloads: open with auto_ack and dynamic_payload.
+     */
+    void set_pipe_enabled(uint8_t pipe, bool enabled);
+
+    /**
+     * @brief No auto-acks (FEC mode): nothing is loaded or taken, replies stay queued.
+     */
+    void set_suspended(bool suspended);
+
+    /**
+     * @brief Queues a reply for pipe's next auto-ack (data copied). Any task.
+     * @return false if the queue is full, the pipe is not enabled or len is out of range.
+     */
+    bool queue(uint8_t pipe, const uint8_t* data, length len);
+
+    /**
+     * @brief A packet arrived on pipe at arrival (DWT cycles): its auto-ack took the
+     *        loaded payload if that was written before.
+     */
+    void on_packet(uint8_t pipe, uint32_t arrival);
+
+    /**
+     * @brief Loads the next payload of every idle pipe: its queue's head, else the
+     *        generator's.
+     */
+    void refill(void);
+
+    /**
+     * @brief Flushes the TX FIFO when it is full, a payload in it is older than
+     *        ACK_MAX_AGE_MS and another pipe waits. now is DWT->CYCCNT.
+     */
+    void expire(uint32_t now);
+
+    /**
+     * @brief Writes a one-off payload behind whatever pipe has loaded.
+     * @return false if the TX FIFO is full.
+     */
+    bool load(uint8_t pipe, const uint8_t* data, length len);
+
+    bool is_loaded(uint8_t pipe) const;
+    const Stats& get_stats(void) const;
+
+private:
+    struct Entry
+    {
+        uint8_t data[NRF24L01P_PAYLOAD_LENGTH];
+        length len;
+    };
+
+    struct Queue
+    {
+        Entry entries[ACK_QUEUE_DEPTH];
+        uint8_t head;
+        uint8_t count;
+        bool loaded;                // A payload for this pipe sits in the TX FIFO
+        bool loaded_entry;          // ...and it is entries[head], popped once an auto-ack takes it
+        bool parked;                // Flushed for age: nothing is loaded until the sender is heard
+        uint32_t loaded_cycles;     // DWT->CYCCNT when it was written: earlier arrivals did not take it
+    };
+
+    bool waiting(uint8_t pipe);
+    void write(uint8_t pipe, const uint8_t* data, length len);
+
+    Queue queues[NRF24L01P_PIPE_COUNT];
+    volatile uint8_t enabled;       // Bit n: pipe n can carry ACK payloads
+    bool suspended;
+    Generator generator;
+    void* context;
+    Stats stats;
+};
+
+#endif // __cplusplus
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * ChaCha20-Poly1305 AEAD (RFC 8439), 32-bit portable code for the Cortex-M4:
+ * no tables (constant time), no AES hardware needed, Poly1305 on 26-bit limbs
+ * so every product is one UMULL/UMLAL.
+ */
+#define CHACHAPOLY_KEY_LENGTH   32
+#define CHACHAPOLY_NONCE_LENGTH 12
+#define CHACHAPOLY_TAG_LENGTH   16
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Encrypts data in place and computes its tag over aad and the ciphertext.
+ */
+void chachapoly_seal(const uint8_t key[CHACHAPOLY_KEY_LENGTH], const uint8_t nonce[CHACHAPOLY_NONCE_LENGTH],
+                     const uint8_t* aad, size_t aad_len, uint8_t* data, size_t len,
+                     uint8_t tag[CHACHAPOLY_TAG_LENGTH]);
+
+/**
+ * @brief Checks the tag, then decrypts data in place.
+ * @param tag_len 1..CHACHAPOLY_TAG_LENGTH: a truncated tag is compared on its first bytes.
+ * @return false (data untouched) if the tag does not match.
+ */
+bool chachapoly_open(const uint8_t key[CHACHAPOLY_KEY_LENGTH], const uint8_t nonce[CHACHAPOLY_NONCE_LENGTH],
+                     const uint8_t* aad, size_t aad_len, uint8_t* data, size_t len,
+                     const uint8_t* tag, size_t tag_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "nrf24l01p.h"
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief Time in RX per channel before RPD is read:
+ *        130 us PLL/RX settling (Tstby2a) + 40 us AGC (Tdelay_AGC).
+ */
+#define SCAN_DWELL_US           170
+
+/**
+ * @brief Channels per sweep_step() from scan_pass(): receive is suspended for
+ *        about SCAN_CHUNK_CHANNELS * SCAN_DWELL_US at a time (8 chunks per sweep).
+ */
+#define SCAN_CHUNK_CHANNELS     16
+
+/**
+ * @brief Occupancy EWMA weight: each sweep moves a channel by 1/2^SCAN_EWMA_SHIFT.
+ */
+#define SCAN_EWMA_SHIFT         3
+
+/**
+ * @brief Peak-hold fall per sweep (out of 255).
+ */
+#define SCAN_PEAK_DECAY         2
+
+/**
+ * @brief Spectrum sweep over all nRF24 channels using RPD (received power >= -64 dBm).
+ * @note sweep_step() and measure() drive CE and the RF channel directly: RadioTask
+ *       calls them with the receive engine paused and restores the channel afterwards.
+ *       Levels and peaks run 0..255 (fraction of sweeps the channel was busy).
+ */
+class ChannelScanner
+{
+public:
+    ChannelScanner();
+
+    /**
+     * @brief Clears the histogram.
+     */
+    void reset(void);
+
+    /**
+     * @brief Samples the next count channels of the sweep over 0..NRF24L01P_CHANNEL_COUNT-1,
+     *        ~SCAN_DWELL_US each; the caller may receive in between.
+     * @note The dwell sleeps on TIM2 (us_timer_sleep()), so other tasks run meanwhile.
+     * @return true if this call finished a sweep.
+     */
+    bool sweep_step(uint8_t count);
+
+    /**
+     * @brief Sweeps a candidate list repeatedly (at least once) until budget_us is used up.
+     * @note Resets the histogram first. The time taken is get_sweep_cycles().
+     * @return The quietest candidate.
+     */
+    uint8_t measure(const uint8_t* channels, uint8_t count, uint32_t budget_us);
+
+    const uint8_t* get_levels(void) const;
+    const uint8_t* get_peaks(void) const;
+
+    /**
+     * @brief Channel in [first, last] with the lowest peak (ties: the lowest level).
+     */
+    uint8_t get_quietest(uint8_t first, uint8_t last) const;
+
+    /**
+     * @brief Same, over a list of channels.
+     */
+    uint8_t get_quietest_in(const uint8_t* channels, uint8_t count) const;
+
+    uint32_t get_sweeps(void) const;
+
+    /**
+     * @brief Duration of the last sweep in DWT cycles (first to last channel,
+     *        including whatever ran between the steps).
+     */
+    uint32_t get_sweep_cycles(void) const;
+
+private:
+    /**
+     * @brief Samples RPD on one channel and updates its level and peak.
+     */
+    void sample(uint8_t ch);
+
+    /**
+     * @brief True if channel a is quieter than channel b.
+     */
+    bool quieter(uint8_t a, uint8_t b) const;
+
+    uint16_t level_acc[NRF24L01P_CHANNEL_COUNT];    // Level << SCAN_EWMA_SHIFT
+    uint8_t levels[NRF24L01P_CHANNEL_COUNT];
+    uint8_t peaks[NRF24L01P_CHANNEL_COUNT];
+    uint32_t sweeps;
+    uint32_t sweep_cycles;
+    uint8_t next_channel;           // Where sweep_step() carries on
+    uint32_t sweep_start;           // DWT->CYCCNT at channel 0 of the running sweep
+};
+
+#endif // __cplusplus
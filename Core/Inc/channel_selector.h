@@ -0,0 +1,104 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief Longest wait on the rendezvous channel for a transmitter to take the announcement.
+ */
+#define CHANNEL_RENDEZVOUS_MS   2000
+
+/**
+ * @brief Earliest re-evaluation after a move.
+ */
+#define CHANNEL_RESELECT_MIN_MS 10000
+
+/**
+ * @brief Fixed-channel selection with a rendezvous handoff: measure, announce the
+ *        chosen channel on the rendezvous channel, move once a packet took the
+ *        announcement (or after CHANNEL_RENDEZVOUS_MS), re-select when the link degrades.
+ * @note Policy only: the caller measures, loads the announcement and tunes when
+ *       update() says so. Times are ticks passed in by the caller. request() from
+ *       any task; the rest from RadioTask.
+ */
+class ChannelSelector
+{
+public:
+    enum State
+    {
+        CHANNEL_FIXED,              // rf_channel as configured, no selection
+        CHANNEL_RENDEZVOUS,         // On the rendezvous channel, announcing the chosen one
+        CHANNEL_SELECTED            // On the chosen channel
+    };
+
+    /**
+     * @brief What update() asks of the caller.
+     */
+    enum Action
+    {
+        CHANNEL_STAY,
+        CHANNEL_SELECT,             // Measure, announce, then call on_selected()
+        CHANNEL_MOVE                // Tune to get_channel()
+    };
+
+    /**
+     * @brief Selection report. Scan times are microseconds of RPD measurement.
+     */
+    struct Stats
+    {
+        uint32_t selections;
+        uint32_t reselections;      // Started because the link degraded
+        uint32_t announced;         // Handoffs confirmed by a packet taking the announcement
+        uint32_t rendezvous_timeouts;
+        uint32_t last_scan_us;
+        uint32_t max_scan_us;
+        uint8_t channel;            // Last chosen channel (0 before the first selection)
+    };
+
+    ChannelSelector();
+
+    /**
+     * @brief Asks for a selection on the next update().
+     */
+    void request(void);
+
+    /**
+     * @brief A selection was made and the caller is on the rendezvous channel.
+     * @param announce_packets Packets on the rendezvous pipe until the announcement
+     *        is out (0 if it could not be loaded).
+     */
+    void on_selected(uint8_t channel, uint32_t scan_us, uint8_t announce_packets, TickType_t now);
+
+    /**
+     * @brief A packet arrived on the rendezvous pipe; its auto-ack carried the next
+     *        payload in the TX FIFO.
+     */
+    void on_rendezvous_packet(void);
+
+    /**
+     * @param degraded The link is poor enough for a re-selection.
+     */
+    Action update(TickType_t now, bool degraded);
+
+    State get_state(void) const;
+
+    /**
+     * @brief Channel to listen on outside the rendezvous: the chosen one once
+     *        selected, else fixed_channel.
+     */
+    uint8_t get_channel(uint8_t fixed_channel) const;
+
+    const Stats& get_stats(void) const;
+
+private:
+    volatile bool requested;
+    State state;
+    uint8_t announce_packets;       // Packets on the rendezvous pipe until the announcement is out
+    TickType_t since;               // Entry into the current state
+    Stats stats;
+};
+
+#endif // __cplusplus
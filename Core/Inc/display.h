@@ -3,6 +3,7 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include "main.h"
+#include "nrf24l01p.h"
 
 // --- C-Wrappers ---
 // C-callable functions for starting the task and initialization.
@@ -32,6 +33,8 @@ extern SemaphoreHandle_t g_i2c_tx_done_sem;
 // --- C++ World ---
 #ifdef __cplusplus
 
+#include "spsc_ring.h"
+
 /**
  * @brief Main class for managing the OLED Display.
  * This class encapsulates all logic for the display task,
@@ -53,11 +56,68 @@ public:
     void task(void);
 
     void set_main_text(const char* text);
+    /**
+     * @brief Sets the main text from a buffer that is not null-terminated.
+     * @param text Characters to display.
+     * @param len Number of characters (clipped to the main text buffer).
+     * @note Call from the post_packet() producer (RadioTask): the text replaces the
+     *       packets queued before it, and packets queued after it replace the text.
+     */
+    void set_main_text(const char* text, size_t len);
     /**
          * @brief Public API to set the top-left status bar text.
          * @param text The new string to display.
          */
     void set_status_text(const char* text);
+
+    /**
+     * @brief Number of bars in the signal indicator.
+     */
+    static const uint8_t SIGNAL_BARS = 4;
+
+    /**
+     * @brief Sets the signal indicator in the top-right corner.
+     * @param bars 0 (no link) .. SIGNAL_BARS.
+     */
+    void set_signal_level(uint8_t bars);
+
+    /**
+     * @brief What the main area below the status bar shows.
+     */
+    enum Mode
+    {
+        MODE_TEXT,                  // Main text / received payload
+        MODE_SPECTRUM               // Channel occupancy bar graph
+    };
+
+    void set_mode(Mode mode);
+
+    /**
+     * @brief Copies a spectrum sweep for the bar graph.
+     * @param levels Occupancy per channel, NRF24L01P_CHANNEL_COUNT values 0..255.
+     * @param peaks Peak-hold per channel, same scale.
+     * @note Cheap and non-blocking: the producer never waits for a redraw.
+     *       A redraw that overlaps the copy may mix two sweeps for one frame.
+     */
+    void set_spectrum(const uint8_t* levels, const uint8_t* peaks);
+
+    /**
+     * @brief Depth of the received-packet queue (RadioTask -> DisplayTask).
+     */
+    static const uint32_t RX_QUEUE_DEPTH = 4;
+
+    /**
+     * @brief Queues a received packet slot; its payload becomes the main text.
+     * @note Lock-free and non-blocking: callable from RadioTask or an ISR (one producer).
+     *       On success DisplayTask owns the slot and renders straight from it.
+     * @return false if the queue is full (counted in get_rx_overflows()); the caller keeps the slot.
+     */
+    bool post_packet(nrf24l01p_packet_handle handle);
+
+    /**
+     * @brief Packets dropped because DisplayTask had not caught up.
+     */
+    uint32_t get_rx_overflows(void) const;
 private:
     /**
      * @brief Initializes the SSD1306 controller.
@@ -70,11 +130,42 @@ private:
      */
     void update_screen(void);
 
+    /**
+     * @brief Draws the signal indicator into the top-right corner of the status bar.
+     */
+    void draw_signal_bars(void);
+
+    /**
+     * @brief Draws the spectrum bar graph into the main area, one column per channel.
+     */
+    void draw_spectrum(void);
+
+    /**
+     * @brief Takes queued packets; the newest one is shown, older slots are freed.
+     */
+    void consume_packets(void);
+
+    /**
+     * @brief Frees the packet slot on screen, if any.
+     */
+    void release_shown_packet(void);
+
     // --- Class State ---
     I2C_HandleTypeDef *hi2c;    // I2C handle
     char main_text[33];           // The last key pressed ('\0' = none)
     bool needs_update;          // Flag to trigger a screen redraw
     char status_text[24];
+    uint8_t signal_level;         // 0..SIGNAL_BARS
+    volatile Mode mode;
+    uint8_t spectrum_levels[NRF24L01P_CHANNEL_COUNT];
+    uint8_t spectrum_peaks[NRF24L01P_CHANNEL_COUNT];
+    SpscRing<nrf24l01p_packet_handle, RX_QUEUE_DEPTH> rx_queue;
+    nrf24l01p_packet_handle shown_packet;   // Slot whose payload is on screen (NONE = main_text)
+    const char* shown_text;                 // main_text or the shown slot's payload
+    volatile bool text_pending;             // set_main_text() ran since the last pass
+    volatile uint32_t text_mark;            // posted_packets when it ran (older packets go first)
+    uint32_t posted_packets;                // Pushed by post_packet() (RadioTask)
+    uint32_t taken_packets;                 // Popped by consume_packets() (DisplayTask)
 };
 
 #endif // __cplusplus
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf24l01p.h"
+
+/*
+ * FEC payload (MyRadio::set_fec_mode): hardware CRC and auto-ack off, static
+ * NRF24L01P_PAYLOAD_LENGTH-byte payloads.
+ *
+ *   block    byte 0 length, 1..13 data, 14..15 CRC-16/CCITT of bytes 0..13 (big endian)
+ *   coding   each block byte -> two Hamming(8,4) SECDED codewords (low nibble first)
+ *   air      32 codewords bit-interleaved: air byte 4k+g holds bit k of codewords
+ *            8g..8g+7, so any burst of up to 32 bits hits a codeword at most once
+ *
+ * One bit error per codeword is corrected, two are detected; the CRC catches what
+ * slips through (three or more in one codeword).
+ */
+#define FEC_BLOCK_LENGTH        (NRF24L01P_PAYLOAD_LENGTH / 2)
+#define FEC_DATA_LENGTH         (FEC_BLOCK_LENGTH - 3)      // 13 bytes
+#define FEC_CODED_LENGTH        NRF24L01P_PAYLOAD_LENGTH
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+{
+    FEC_OK,                     // Decoded (possibly after correcting bits)
+    FEC_UNCORRECTABLE,          // A codeword had two bit errors
+    FEC_CRC_ERROR               // Decoded, but the CRC does not match
+} fec_result;
+
+/**
+ * @brief Encodes up to FEC_DATA_LENGTH bytes into FEC_CODED_LENGTH air bytes.
+ */
+void fec_encode(const uint8_t* data, length len, uint8_t coded[FEC_CODED_LENGTH]);
+
+/**
+ * @brief Decodes FEC_CODED_LENGTH air bytes in place: on FEC_OK buf starts with the data.
+ * @param len Data length on FEC_OK.
+ * @param corrected Bits corrected (may be NULL).
+ */
+fec_result fec_decode(uint8_t buf[FEC_CODED_LENGTH], length* len, uint8_t* corrected);
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).
+ */
+uint16_t fec_crc16(const uint8_t* data, length len);
+
+#ifdef __cplusplus
+}
+#endif
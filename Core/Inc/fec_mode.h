@@ -0,0 +1,69 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "nrf24l01p.h"
+#include "fec.h"
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief The FEC air format (fec.h) for every pipe: the requested/active switch,
+ *        the pipe and CRC settings it overrides, and the decoder with its counters.
+ * @note Policy only: the caller reprograms the chip when needs_switch() says so and
+ *       then calls set_enabled(). request() from any task; the rest from RadioTask.
+ */
+class FecMode
+{
+public:
+    /**
+     * @brief Decoder counters.
+     */
+    struct Stats
+    {
+        uint32_t decoded;
+        uint32_t corrected_packets; // Decoded after correcting at least one bit
+        uint32_t corrected_bits;
+        uint32_t uncorrectable;     // Two errors in one codeword
+        uint32_t crc_errors;        // Decoded, software CRC mismatch (or noise without CRC)
+    };
+
+    FecMode();
+
+    void request(bool enable);
+
+    /**
+     * @brief True while the requested format differs from the active one.
+     */
+    bool needs_switch(void) const;
+
+    void set_enabled(bool enable);
+    bool is_enabled(void) const;
+
+    /**
+     * @brief Overrides a pipe's configuration while enabled: no CRC means no
+     *        auto-ack, and the coded length is fixed.
+     */
+    void configure_pipe(nrf24l01p_pipe_config* config) const;
+
+    /**
+     * @brief CRC length to program: none while enabled, else the profile's.
+     */
+    uint8_t crc_bytes(uint8_t profile_crc_bytes) const;
+
+    /**
+     * @brief While enabled, replaces the coded payload with its data.
+     * @return false if the packet did not decode (always true while disabled).
+     */
+    bool decode(nrf24l01p_rx_packet* packet);
+
+    const Stats& get_stats(void) const;
+
+private:
+    volatile bool requested;
+    bool enabled;
+    Stats stats;
+};
+
+#endif // __cplusplus
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf24l01p.h"
+
+/*
+ * Framed payload (pipes set with MyRadio::set_pipe_framed):
+ *
+ *   byte 0   seq      per-sender packet counter (LinkQuality reads it as payload[0])
+ *   byte 1   type     FRAME_TYPE_*
+ *   byte 2   msg_id   per-sender message counter
+ *   byte 3   frag     bits 0-5 fragment index, bit 7 set on the last fragment
+ *   4..31    data     FRAME_DATA_LENGTH bytes in every fragment but the last
+ *
+ * A message of up to FRAME_MAX_MESSAGE bytes is sent as fragments 0..n-1;
+ * a single-packet message is fragment 0 with FRAME_FRAG_LAST.
+ * FRAME_TYPE_BULK_* payloads share bytes 0-1 and lay out the rest themselves.
+ * Hop beacons (freq_hopper.h) share bytes 0-1 on any pipe, framed or not.
+ */
+#define FRAME_HEADER_LENGTH     4
+#define FRAME_DATA_LENGTH       (NRF24L01P_PAYLOAD_LENGTH - FRAME_HEADER_LENGTH)
+#define FRAME_FRAG_LAST         0x80
+#define FRAME_FRAG_INDEX_MASK   0x3F
+#define FRAME_MAX_FRAGMENTS     37
+#define FRAME_MAX_MESSAGE       (FRAME_MAX_FRAGMENTS * FRAME_DATA_LENGTH)   // 1036 bytes
+
+// Message types
+#define FRAME_TYPE_TEXT         0x01    // Text for the main display zone
+#define FRAME_TYPE_DATA         0x02    // Opaque application data
+#define FRAME_TYPE_BULK_START   0x10    // Bulk transfer announcement (bulk_receiver.h)
+#define FRAME_TYPE_BULK_DATA    0x11    // Bulk transfer block (bulk_receiver.h)
+#define FRAME_TYPE_BEACON       0x20    // Hop beacon (freq_hopper.h)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint8_t seq;
+    uint8_t type;
+    uint8_t msg_id;
+    uint8_t index;              // Fragment index
+    bool last;                  // Last fragment of the message
+    const uint8_t* data;        // Points into the payload
+    length data_len;
+} frame_view;
+
+/**
+ * @brief Splits a payload into header fields and data, without copying.
+ * @return false if the payload is too short or the fragment index is out of range.
+ */
+static inline bool frame_parse(const uint8_t* payload, length len, frame_view* frame)
+{
+    if (len < FRAME_HEADER_LENGTH) {
+        return false;
+    }
+
+    frame->seq = payload[0];
+    frame->type = payload[1];
+    frame->msg_id = payload[2];
+    frame->index = payload[3] & FRAME_FRAG_INDEX_MASK;
+    frame->last = (payload[3] & FRAME_FRAG_LAST) != 0;
+    frame->data = &payload[FRAME_HEADER_LENGTH];
+    frame->data_len = len - FRAME_HEADER_LENGTH;
+
+    return frame->index < FRAME_MAX_FRAGMENTS;
+}
+
+#ifdef __cplusplus
+}
+#endif
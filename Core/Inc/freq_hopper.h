@@ -0,0 +1,174 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief Channels visited per hop cycle (a permutation of HOP_FIRST_CHANNEL..HOP_LAST_CHANNEL).
+ */
+#define HOP_SEQUENCE_LENGTH     16
+#define HOP_FIRST_CHANNEL       2
+#define HOP_LAST_CHANNEL        125
+
+/**
+ * @brief Time on each channel.
+ */
+#define HOP_DWELL_US            10000
+
+/**
+ * @brief Hops without a beacon before sync counts as lost. Until then the
+ *        receiver coasts on its own clock, which re-acquires a short fade for free.
+ */
+#define HOP_SYNC_LOSS_HOPS      (2 * HOP_SEQUENCE_LENGTH)
+
+/**
+ * @brief Hops after the last beacon that the coasting schedule is still trusted
+ *        for re-acquisition: at 100 ppm between the two clocks it drifts 128 µs,
+ *        well inside the beacon's offset into its hop.
+ */
+#define HOP_PREDICTION_HOPS     (8 * HOP_SEQUENCE_LENGTH)
+
+/**
+ * @brief Beacon payload: sequence number, FRAME_TYPE_BEACON (frame.h), hop index,
+ *        then the microseconds from the start of that hop to the start of the
+ *        beacon's transmission (little-endian). The type byte keeps ordinary
+ *        short payloads on the beacon pipe from moving the schedule.
+ */
+#define HOP_BEACON_LENGTH       5
+
+/**
+ * @brief Frequency-hopping mode: the schedule shared with the transmitter and the
+ *        beacons that keep it in step.
+ * @note The hop sequence comes from the pipe address:
+ *       seed = FNV-1a-32 over the address bytes (0 -> 1), then xorshift32
+ *       (13, 17, 5) drives a Fisher-Yates shuffle of HOP_FIRST_CHANNEL..HOP_LAST_CHANNEL.
+ *       The first HOP_SEQUENCE_LENGTH channels of the shuffle are the sequence.
+ *       All times are in ticks of a free-running 32-bit counter (DWT->CYCCNT on
+ *       target, simulated time on a host). Intervals must stay below 2^31 ticks.
+ *       No hardware access: the caller tunes the radio to the channel it returns.
+ *       request() from any task; the rest from the task that tunes.
+ */
+class FreqHopper
+{
+public:
+    /**
+     * @note After a sync loss the receiver alternates HOP_ACQUIRE windows with a
+     *       cycle of HOP_REACQUIRE while the coasting schedule is trusted. A
+     *       transmitter that only faded is caught within a hop of coming back
+     *       (parking alone waits up to HOP_SEQUENCE_LENGTH + 1 dwells); one that
+     *       restarted on a new schedule is still caught by the parked window.
+     *       With one beacon per hop no blind scan order beats parking on an
+     *       unknown schedule (N + 1 dwells worst case), so the prediction is
+     *       the only thing that makes re-acquisition faster.
+     */
+    enum State
+    {
+        HOP_ACQUIRE,                // Parked on one channel of the sequence, waiting for a beacon
+        HOP_REACQUIRE,              // Following the coasting schedule after a sync loss
+        HOP_SYNCED                  // Following the transmitter's schedule
+    };
+
+    struct Stats
+    {
+        uint32_t hops;
+        uint32_t beacons;
+        uint32_t sync_losses;
+        uint32_t acquisitions;      // ACQUIRE/REACQUIRE -> SYNCED
+        uint32_t reacquisitions;    // ...of them caught while following the prediction
+        int32_t last_error_us;      // Beacon time minus the coasting prediction
+    };
+
+    FreqHopper();
+
+    /**
+     * @brief Asks for hopping (true) or the fixed channel; beacons arrive on beacon_pipe.
+     */
+    void request(bool enable, uint8_t beacon_pipe);
+
+    /**
+     * @brief True while the requested mode differs from the active one.
+     */
+    bool needs_switch(void) const;
+    bool is_requested(void) const;
+    uint8_t get_requested_pipe(void) const;
+
+    /**
+     * @brief Builds the hop sequence and starts acquisition.
+     * @param beacon_pipe Pipe whose beacons is_beacon() accepts.
+     * @param address Pipe address (seed), LSB first as programmed into the nRF24.
+     * @param width Address width in bytes.
+     * @param ticks_per_us Clock rate of the tick values passed in.
+     * @param now Current time.
+     */
+    void start(uint8_t beacon_pipe, const uint8_t* address, uint8_t width, uint32_t ticks_per_us, uint32_t now);
+
+    /**
+     * @brief Leaves hopping: nothing is a beacon any more.
+     */
+    void stop(void);
+    bool is_active(void) const;
+
+    /**
+     * @brief True for a beacon payload (HOP_BEACON_LENGTH bytes, FRAME_TYPE_BEACON)
+     *        on the beacon pipe while hopping.
+     */
+    bool is_beacon(uint8_t pipe, const uint8_t* payload, uint8_t len) const;
+
+    /**
+     * @brief Feeds a payload is_beacon() accepted into the schedule.
+     * @param air_us Its time on air: the beacon counts from the start of its
+     *        transmission, arrival is its end.
+     */
+    void take_beacon(const uint8_t* payload, uint32_t air_us, uint32_t arrival);
+
+    /**
+     * @brief A beacon arrived.
+     * @param index Hop index from the beacon.
+     * @param elapsed_us Microseconds since that hop began, at the moment of arrival.
+     * @param arrival Arrival time.
+     */
+    void on_beacon(uint8_t index, uint32_t elapsed_us, uint32_t arrival);
+
+    /**
+     * @brief Advances the schedule to now.
+     * @return true if the radio must be retuned to get_channel().
+     */
+    bool update(uint32_t now);
+
+    /**
+     * @brief Ticks until the next scheduled channel change (0 if it is due).
+     */
+    uint32_t ticks_to_next(uint32_t now) const;
+
+    uint8_t get_channel(void) const;
+    uint8_t channel_at(uint8_t index) const;
+    State get_state(void) const;
+    const Stats& get_stats(void) const;
+
+private:
+    void enter_acquire(uint8_t index, uint32_t now);
+
+    volatile bool requested;
+    volatile uint8_t requested_pipe;
+    bool active;
+    uint8_t beacon_pipe;
+
+    uint8_t sequence[HOP_SEQUENCE_LENGTH];
+    uint32_t ticks_per_us;
+    uint32_t dwell_ticks;
+    State state;
+    bool predicting;                // index/hop_start follow the transmitter (a beacon was heard)
+    uint8_t index;                  // Transmitter's current hop, by the last beacon
+    uint32_t hop_start;             // Start of that hop
+    uint16_t hops_since_beacon;
+    uint8_t parked;                 // Hop listened on in ACQUIRE
+    uint32_t phase_start;           // Start of the ACQUIRE / REACQUIRE window
+    uint32_t phase_length;
+    uint8_t tuned;                  // Channel the radio was last told to use
+    Stats stats;
+};
+
+#endif // __cplusplus
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "nrf24l01p.h"
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief EWMA weight: each sample moves a score by 1/2^LINK_EWMA_SHIFT of the difference.
+ */
+#define LINK_EWMA_SHIFT         3
+
+/**
+ * @brief A pipe that received nothing for this long scores 0.
+ */
+#define LINK_STALE_MS           1000
+
+/**
+ * @brief Sequence numbers remembered per sender (the duplicate bitmap width).
+ */
+#define LINK_SEQ_WINDOW         64
+
+/**
+ * @brief Silence after which an older number is a restarted sender, taken at once.
+ *        Retransmissions (ARD x ARC) and reordering never span this long; a reboot does.
+ */
+#define LINK_RESTART_GAP_MS     100
+
+/**
+ * @brief Old duplicates with consecutive numbers (n, n+1, ...) that mean the
+ *        sender restarted its counter within LINK_SEQ_WINDOW of the old one without
+ *        a silence; retransmissions repeat one number instead.
+ */
+#define LINK_RESYNC_DUPLICATES  3
+
+/**
+ * @brief Per-sender link quality from RPD and payload sequence numbers.
+ * @note One sender per pipe. On sequenced pipes payload[0] is an 8-bit counter
+ *       the transmitter increments per packet; other pipes are scored on RPD only.
+ *       A bitmap of the last LINK_SEQ_WINDOW numbers makes the duplicate check O(1):
+ *       an older number in it is a duplicate if its bit is set, else late. A number
+ *       further back is a restarted sender.
+ *       Scores run 0..255. Call from RadioTask only.
+ */
+class LinkQuality
+{
+public:
+    /**
+     * @brief What record() made of a packet's sequence number.
+     */
+    enum Verdict
+    {
+        LINK_NEW,                   // Next in sequence (or the pipe is not sequenced)
+        LINK_DUPLICATE,             // Number already received (retransmission after a lost auto-ack)
+        LINK_LATE                   // Older than the newest packet: arrived out of order
+    };
+
+    struct Stats
+    {
+        uint32_t received;
+        uint32_t lost;              // Sequence gaps not filled by late packets
+        uint32_t duplicates;        // Packets received again (sequenced pipes)
+        uint32_t reordered;
+        uint32_t resyncs;           // Sender restarts (counter started over)
+        uint32_t rpd_hits;          // Packets read with RPD set (>= -64 dBm)
+        uint8_t rpd_score;          // EWMA of RPD
+        uint8_t delivery_score;     // EWMA of delivered (255) vs. lost (0) packets
+        uint8_t duplicate_score;    // EWMA of duplicate (255) vs. new (0) packets: lost auto-acks
+        uint8_t score;              // Combined score, 0 while stale
+        TickType_t last_tick;       // Tick of the newest packet
+    };
+
+    LinkQuality();
+
+    /**
+     * @brief Enables sequence tracking on a pipe (payload[0] = sequence number).
+     */
+    void set_sequenced(uint8_t pipe, bool sequenced);
+
+    /**
+     * @brief Scores one received packet.
+     */
+    Verdict record(const nrf24l01p_rx_packet* packet);
+
+    /**
+     * @brief Same, with the sequence number given (a sealed packet's counter,
+     *        no longer in the opened payload).
+     */
+    Verdict record(const nrf24l01p_rx_packet* packet, uint8_t seq);
+
+    /**
+     * @brief Zeroes the score of pipes that went quiet for LINK_STALE_MS.
+     */
+    void age(TickType_t now);
+
+    const Stats& get_stats(uint8_t pipe) const;
+
+    /**
+     * @brief Best score over all pipes.
+     */
+    uint8_t get_score(void) const;
+
+    /**
+     * @brief get_score() as 0..4 signal bars (0 = every pipe stale).
+     */
+    uint8_t get_bars(void) const;
+
+    /**
+     * @brief True if a live sequenced pipe delivers below min_delivery. Stale
+     *        pipes do not count: with every pipe stale the link is idle, not degraded.
+     */
+    bool is_degraded(uint8_t min_delivery) const;
+
+private:
+    struct PipeState
+    {
+        Stats stats;
+        uint16_t rpd_acc;           // Score << LINK_EWMA_SHIFT
+        uint16_t delivery_acc;
+        uint16_t duplicate_acc;
+        uint64_t seen;              // Bit n: sequence number last_seq - n received
+        uint8_t last_seq;
+        uint8_t old_duplicates;     // Run length, see LINK_RESYNC_DUPLICATES
+        uint8_t old_seq;            // Last number of that run
+        bool seq_valid;
+        bool sequenced;
+        bool stale;
+    };
+
+    Verdict record(const nrf24l01p_rx_packet* packet, bool has_seq, uint8_t seq);
+
+    static void ewma(uint16_t* acc, uint8_t sample);
+    void update_score(PipeState* state);
+
+    PipeState pipes[NRF24L01P_PIPE_COUNT];
+};
+
+#endif // __cplusplus
@@ -12,26 +12,49 @@
 #define __NRF24L01P_H__
 
 #include "main.h" // Повинен вже бути
-#include "spi.h"
 #include "spi.h"    // header from stm32cubemx code generate
+#include "FreeRTOS.h"
+#include "task.h"
 #include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" { // <<< ВИПРАВЛЕНО: Додано лапки
 #endif
 /* User Configurations */
-#define NRF24L01P_SPI               &hspi1
+// Radio behind the C API (the Nrf24Device instance in nrf24l01p.cpp)
+#define NRF24L01P_SPI_HANDLE        hspi1
+#define NRF24L01P_SPI               &NRF24L01P_SPI_HANDLE
 
 #define NRF24L01P_SPI_CS_PIN_PORT   NRF24_CSN_GPIO_Port
+#define NRF24L01P_SPI_CS_PIN_BASE   GPIOA_BASE
 #define NRF24L01P_SPI_CS_PIN_NUMBER NRF24_CSN_Pin
 
 #define NRF24L01P_CE_PIN_PORT       NRF24_CE_GPIO_Port
+#define NRF24L01P_CE_PIN_BASE       GPIOB_BASE
 #define NRF24L01P_CE_PIN_NUMBER     NRF24_CE_Pin
 
 #define NRF24L01P_IRQ_PIN_PORT            NRF24_IRQ_Port
 #define NRF24L01P_IRQ_PIN_NUMBER          NRF24_IRQ_Pin
 
 #define NRF24L01P_PAYLOAD_LENGTH    32
+#define NRF24L01P_RX_FIFO_DEPTH     3
+#define NRF24L01P_PIPE_COUNT        6
+#define NRF24L01P_CHANNEL_COUNT     126     // RF_CH 0..125 = 2400..2525 MHz
+
+// Timeout for a DMA transaction started with nrf24l01p_transfer_async()
+#define NRF24L01P_ASYNC_TIMEOUT_MS  10
+
+// Task-notification bit set on DMA completion; the other bits belong to the application
+#define NRF24L01P_NOTIFY_SPI_DONE   (1UL << 31)
+
+// Packets buffered by the interrupt-driven receive engine (power of two)
+#define NRF24L01P_RX_RING_SIZE      8
+
+// Received-packet slots shared by the driver and the consumers holding them
+#define NRF24L01P_RX_POOL_SIZE      16
+
+// Free-running clock for packet arrival stamps (DWT cycle counter, enabled by the application)
+#define NRF24L01P_TIMESTAMP()       (DWT->CYCCNT)
 
 
 /* nRF24L01+ typedefs */
@@ -56,6 +79,105 @@ typedef enum
     _18dBm = 0
 } output_power;
 
+// Air format: everything both ends of the link must agree on, apart from channel and addresses
+typedef struct
+{
+    const char* name;
+    air_data_rate bps;
+    length crc_bytes;           // 1 or 2 (0 = off, only with auto-ack off on every pipe)
+    widths address_bytes;       // 3..5
+    output_power dBm;
+} nrf24l01p_profile;
+
+extern const nrf24l01p_profile NRF24L01P_PROFILE_DEFAULT;         // 1 Mbps, 1-byte CRC, 5-byte address
+extern const nrf24l01p_profile NRF24L01P_PROFILE_MAX_THROUGHPUT;  // 2 Mbps, 1-byte CRC, 3-byte address
+extern const nrf24l01p_profile NRF24L01P_PROFILE_LONG_RANGE;      // 250 kbps, 2-byte CRC, 5-byte address
+
+typedef struct
+{
+    const uint8_t* address;     // SETUP_AW bytes for pipes 0-1; pipes 2-5 use address[0] only
+    bool auto_ack;
+    bool dynamic_payload;
+    widths payload_width;       // Static RX_PW_Pn, ignored with dynamic_payload
+} nrf24l01p_pipe_config;
+
+// Full configuration register image, applied in one pass by nrf24l01p_apply_image().
+// Build it at compile time with Nrf24ConfigBuilder (nrf24l01p_config.h).
+typedef struct
+{
+    uint8_t config;
+    uint8_t en_aa;
+    uint8_t en_rxaddr;
+    uint8_t setup_aw;
+    uint8_t setup_retr;
+    uint8_t rf_ch;
+    uint8_t rf_setup;
+    uint8_t rx_pw[NRF24L01P_PIPE_COUNT];
+    uint8_t dynpd;
+    uint8_t feature;
+} nrf24l01p_register_image;
+
+// RX_PW_Pn is only written for enabled pipes without dynamic payloads
+static inline bool nrf24l01p_image_pipe_needs_width(const nrf24l01p_register_image* image, uint8_t pipe)
+{
+    return (image->en_rxaddr & (1 << pipe)) && !(image->dynpd & (1 << pipe));
+}
+
+typedef struct
+{
+    uint32_t spi_transactions;  // CS windows opened
+    uint32_t spi_bytes;         // Bytes clocked, command byte included
+    uint32_t rx_packets;        // Payloads read out of the RX FIFO
+} nrf24l01p_spi_stats;
+
+// One pool slot (NRF24L01P_RX_POOL_SIZE of them). A slot is the whole packet,
+// metadata and payload together (48 bytes), not a bare 32-byte payload block:
+// the receive engine lands STATUS and the payload in one DMA transfer, and the
+// pipe, length and stamps travel with the handle. The payload starts on a word
+// boundary and slots are a whole number of words, so every payload is aligned.
+typedef struct
+{
+    uint32_t timestamp;         // Tick count when the payload was read out
+    uint32_t arrival;           // NRF24L01P_TIMESTAMP() at the IRQ edge announcing it (read time when polled)
+    uint8_t pipe;
+    length len;
+    uint8_t rpd;                // RPD (>= -64 dBm) of the newest packet when this one was read
+    uint8_t status;             // STATUS shifted out with R_RX_PAYLOAD: the SPI frame lands
+    uint8_t payload[NRF24L01P_PAYLOAD_LENGTH + 1]; // on status + payload in one piece (+1: room for a '\0')
+} nrf24l01p_rx_packet;
+
+// Pool slot holding one nrf24l01p_rx_packet; the holder frees it
+typedef uint8_t nrf24l01p_packet_handle;
+#define NRF24L01P_PACKET_NONE       0xFF
+
+typedef struct
+{
+    uint8_t capacity;
+    uint8_t in_use;
+    uint8_t high_water;         // Most slots ever held at once
+    uint32_t alloc_failures;    // Reads deferred because every slot was held
+} nrf24l01p_pool_stats;
+
+typedef struct
+{
+    TaskHandle_t task;          // Consumer of the ring
+    uint32_t ready_bits;        // Notification bits set on watermark or timeout
+    uint32_t error_bits;        // Notification bits set when a transfer fails
+    uint8_t watermark;          // Ring occupancy that wakes the task at once (1..NRF24L01P_RX_RING_SIZE)
+    uint32_t timeout_ms;        // Age of the oldest packet that wakes the task below the watermark
+} nrf24l01p_rx_engine_config;
+
+typedef struct
+{
+    uint32_t chains;            // Drain chains started (EXTI, resume or rerun)
+    uint32_t packets;           // Payloads pushed into the ring
+    uint32_t watermark_wakeups;
+    uint32_t timeout_wakeups;
+    uint32_t ring_full;         // Chains parked until the task took a packet
+    uint32_t pool_empty;        // Chains parked until a consumer freed a slot
+    uint32_t errors;            // Failed transfers and corrupt payload widths
+} nrf24l01p_rx_engine_stats;
+
 
 /* Main Functions */
 void nrf24l01p_rx_init(channel MHz, air_data_rate bps);
@@ -68,6 +190,17 @@ void nrf24l01p_tx_transmit(uint8_t* tx_payload);
 void nrf24l01p_tx_irq();
 
 
+// Write a register image with one transaction per register (no read-modify-write),
+// clear IRQ flags and flush both FIFOs. CE is left low; raise it with nrf24l01p_ce_high()
+// once the addresses are set and the 1.5 ms power-up delay has passed.
+// With verify, the registers are read back and false is returned on any mismatch.
+bool nrf24l01p_apply_image(const nrf24l01p_register_image* image, bool verify);
+
+// CE control: high = listening (PRX) / transmitting (PTX)
+void nrf24l01p_ce_high();
+void nrf24l01p_ce_low();
+
+
 /* Sub Functions */
 void nrf24l01p_reset();
 
@@ -80,15 +213,36 @@ void nrf24l01p_power_down();
 void nrf24l01p_set_tx_address(uint8_t* address);
 void nrf24l01p_set_rx_address_p0(uint8_t* address);
 
+// Program address, auto-ack and payload mode of pipe 0-5 and enable it in EN_RXADDR.
+// Pipes 2-5 share the upper address bytes of pipe 1.
+void nrf24l01p_configure_pipe(uint8_t pipe, const nrf24l01p_pipe_config* config);
+void nrf24l01p_disable_pipe(uint8_t pipe);
+
 uint8_t nrf24l01p_get_status();
 uint8_t nrf24l01p_get_fifo_status();
+bool nrf24l01p_get_rpd();           // Received power >= -64 dBm, latched by the last packet
 
 // Static payload lengths
 void nrf24l01p_rx_set_payload_widths(widths bytes);
 
+// Dynamic payload lengths (EN_DPL + DYNPD). Bit n of pipe_mask enables pipe n, 0 disables.
+// Auto-ack must stay enabled on those pipes.
+void nrf24l01p_enable_dynamic_payloads(uint8_t pipe_mask);
+length nrf24l01p_read_rx_payload_width();
+
 uint8_t nrf24l01p_read_rx_fifo(uint8_t* rx_payload);
+// Read the top payload of a static-width pipe (len = its RX_PW_Pn)
+uint8_t nrf24l01p_read_rx_fifo_length(uint8_t* rx_payload, length len);
+// Read the top payload with its real width (R_RX_PL_WID). *len is 0 if the width
+// was invalid and the RX FIFO had to be flushed.
+uint8_t nrf24l01p_read_rx_fifo_dynamic(uint8_t* rx_payload, length* len);
 uint8_t nrf24l01p_write_tx_fifo(uint8_t* tx_payload);
 
+// ACK payloads (PRX). Needs EN_ACK_PAY and dynamic payloads on the pipe, on both ends.
+// The payload rides on the auto-ack of the next packet received on that pipe.
+void nrf24l01p_enable_ack_payloads(bool enable);
+uint8_t nrf24l01p_write_ack_payload(uint8_t pipe, const uint8_t* payload, length len);
+
 void nrf24l01p_flush_rx_fifo();
 void nrf24l01p_flush_tx_fifo();
 
@@ -107,6 +261,78 @@ void nrf24l01p_auto_retransmit_count(count cnt);
 void nrf24l01p_auto_retransmit_delay(delay us);
 
 
+/* Air-Time Profiles */
+// Switch the air format at runtime (CE is dropped and restored, no reset)
+void nrf24l01p_apply_profile(const nrf24l01p_profile* profile);
+const nrf24l01p_profile* nrf24l01p_get_profile();
+
+// On-air time of one packet carrying payload_bytes
+uint32_t nrf24l01p_air_time_us(const nrf24l01p_profile* profile, length payload_bytes);
+// Packet + auto-ack (with ack_bytes of ACK payload) including both 130 us turnarounds
+uint32_t nrf24l01p_exchange_time_us(const nrf24l01p_profile* profile, length payload_bytes, length ack_bytes);
+
+
+// Read back CONFIG, RF_SETUP, SETUP_RETR, EN_AA, EN_RXADDR, DYNPD and FEATURE,
+// rewrite any register that differs from the driver's shadow copy
+// and return how many diverged (0 = chip matches the shadow)
+uint8_t nrf24l01p_verify_registers();
+
+// SPI cost counters. Divide by rx_packets for the cost per received packet.
+void nrf24l01p_get_spi_stats(nrf24l01p_spi_stats* stats);
+void nrf24l01p_reset_spi_stats();
+
+
+/* Interrupt-Driven Receive Engine */
+// Drains the RX FIFO from interrupt context: EXTI -> clear RX_DR (returns STATUS)
+// -> R_RX_PL_WID -> R_RX_PAYLOAD, repeated until RX_P_NO reads empty, every step
+// a DMA transfer started from the previous one's completion. Payloads go into a
+// ring of NRF24L01P_RX_RING_SIZE packets; the task is notified when the ring
+// reaches the watermark or its oldest packet is timeout_ms old.
+// Payloads are DMA'd straight into pool slots; the ring carries handles.
+// When the ring or the pool is full the chain parks and the nRF24 FIFO holds further packets.
+bool nrf24l01p_rx_engine_start(const nrf24l01p_rx_engine_config* config);
+void nrf24l01p_rx_engine_stop();
+
+// Any other SPI access to the radio must be bracketed by pause/resume while the
+// engine runs. Resume restarts the chain to collect what arrived meanwhile.
+void nrf24l01p_rx_engine_pause();
+void nrf24l01p_rx_engine_resume();
+
+// Consumer side (one task). Returns false when the ring is empty; otherwise the
+// caller owns *handle and must pass it on or free it.
+bool nrf24l01p_rx_engine_pop(nrf24l01p_packet_handle* handle);
+uint8_t nrf24l01p_rx_engine_pending();
+void nrf24l01p_rx_engine_get_stats(nrf24l01p_rx_engine_stats* stats);
+
+// Call from HAL_GPIO_EXTI_Callback (IRQ pin, with NRF24L01P_TIMESTAMP() taken first thing)
+// and from the FreeRTOS tick hook
+void nrf24l01p_rx_engine_irq(uint32_t timestamp);
+void nrf24l01p_rx_engine_tick();
+
+
+/* Received-Packet Pool */
+// Any task may alloc, look up and free. Freeing restarts a receive chain parked on an empty pool.
+nrf24l01p_packet_handle nrf24l01p_rx_packet_alloc();
+nrf24l01p_rx_packet* nrf24l01p_rx_packet_get(nrf24l01p_packet_handle handle);
+void nrf24l01p_rx_packet_free(nrf24l01p_packet_handle handle);
+void nrf24l01p_rx_pool_get_stats(nrf24l01p_pool_stats* stats);
+
+
+/* Asynchronous (DMA) Transactions */
+// Start command + payload over DMA. tx_payload may be NULL (NOPs are clocked out).
+// Returns false if a transaction is already in flight or the HAL refused it.
+bool nrf24l01p_transfer_async(uint8_t command, const uint8_t* tx_payload, length len);
+
+// Sleep the calling task until the transaction completes (NRF24L01P_NOTIFY_SPI_DONE).
+// Notification bits set meanwhile by others are kept pending for the task.
+// Copies STATUS and the clocked-in payload out; either pointer may be NULL.
+bool nrf24l01p_transfer_wait(uint8_t* status, uint8_t* rx_payload, length len, uint32_t timeout_ms);
+
+// Call from HAL_SPI_TxRxCpltCallback / HAL_SPI_ErrorCallback (interrupt context)
+void nrf24l01p_spi_txrx_cplt_callback(SPI_HandleTypeDef* hspi);
+void nrf24l01p_spi_error_callback(SPI_HandleTypeDef* hspi);
+
+
 /* nRF24L01+ Commands */
 #define NRF24L01P_CMD_R_REGISTER                  0b00000000
 #define NRF24L01P_CMD_W_REGISTER                  0b00100000
@@ -148,6 +374,33 @@ void nrf24l01p_auto_retransmit_delay(delay us);
 #define NRF24L01P_REG_DYNPD             0x1C
 #define NRF24L01P_REG_FEATURE           0x1D
 
+/* CONFIG register fields */
+#define NRF24L01P_CONFIG_MASK_RX_DR         (1 << 6)
+#define NRF24L01P_CONFIG_MASK_TX_DS         (1 << 5)
+#define NRF24L01P_CONFIG_MASK_MAX_RT        (1 << 4)
+#define NRF24L01P_CONFIG_EN_CRC             (1 << 3)
+#define NRF24L01P_CONFIG_CRCO               (1 << 2)
+#define NRF24L01P_CONFIG_PWR_UP             (1 << 1)
+#define NRF24L01P_CONFIG_PRIM_RX            (1 << 0)
+
+/* STATUS register fields */
+#define NRF24L01P_STATUS_RX_DR              (1 << 6)
+#define NRF24L01P_STATUS_TX_DS              (1 << 5)
+#define NRF24L01P_STATUS_MAX_RT             (1 << 4)
+#define NRF24L01P_STATUS_RX_P_NO(status)    (((status) >> 1) & 0x07)
+#define NRF24L01P_RX_P_NO_EMPTY             0x07
+
+/* FIFO_STATUS register fields */
+#define NRF24L01P_FIFO_STATUS_TX_FULL       (1 << 5)
+#define NRF24L01P_FIFO_STATUS_TX_EMPTY      (1 << 4)
+#define NRF24L01P_FIFO_STATUS_RX_FULL       (1 << 1)
+#define NRF24L01P_FIFO_STATUS_RX_EMPTY      (1 << 0)
+
+/* FEATURE register fields */
+#define NRF24L01P_FEATURE_EN_DPL            (1 << 2)
+#define NRF24L01P_FEATURE_EN_ACK_PAY        (1 << 1)
+#define NRF24L01P_FEATURE_EN_DYN_ACK        (1 << 0)
+
 #ifdef __cplusplus
 }
 #endif
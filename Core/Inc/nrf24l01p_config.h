@@ -0,0 +1,160 @@
+/*
+ *  nrf24l01p_config.h
+ *
+ *  Compile-time builder for nrf24l01p_register_image.
+ *
+ *  static constexpr nrf24l01p_register_image RX_IMAGE = Nrf24ConfigBuilder()
+ *      .prx().power_up().rf_channel(106).data_rate(_1Mbps)
+ *      .pipe(0, true, true, 0)
+ *      .image();
+ *
+ *  nrf24l01p_apply_image(&RX_IMAGE, false);
+ */
+
+#ifndef __NRF24L01P_CONFIG_H__
+#define __NRF24L01P_CONFIG_H__
+
+#include "nrf24l01p.h"
+
+#ifdef __cplusplus
+
+class Nrf24ConfigBuilder
+{
+public:
+    /**
+     * @brief Starts from the values nrf24l01p_reset() writes, with every pipe closed.
+     */
+    constexpr Nrf24ConfigBuilder()
+        : img{NRF24L01P_CONFIG_EN_CRC, 0x00, 0x00, 0x03, 0x03, 0x02, 0x07, {0, 0, 0, 0, 0, 0}, 0x00, 0x00}
+    {
+    }
+
+    constexpr Nrf24ConfigBuilder prx() const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.config |= NRF24L01P_CONFIG_PRIM_RX;
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder ptx() const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.config &= ~NRF24L01P_CONFIG_PRIM_RX;
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder power_up() const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.config |= NRF24L01P_CONFIG_PWR_UP;
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder rf_channel(channel MHz) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.rf_ch = MHz & 0x7F;
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder data_rate(air_data_rate bps) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.rf_setup &= 0xD7;
+        if (bps == _2Mbps)   b.img.rf_setup |= 1 << 3;
+        if (bps == _250kbps) b.img.rf_setup |= 1 << 5;
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder tx_output_power(output_power dBm) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.rf_setup = (b.img.rf_setup & 0xF9) | (dBm << 1);
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder crc_length(length bytes) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.config |= NRF24L01P_CONFIG_EN_CRC;
+        if (bytes == 2) b.img.config |= NRF24L01P_CONFIG_CRCO;
+        else            b.img.config &= ~NRF24L01P_CONFIG_CRCO;
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder address_width(widths bytes) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.setup_aw = bytes - 2;
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder auto_retransmit(count cnt, delay us) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.setup_retr = (((us / 250) - 1) << 4) | (cnt & 0x0F);
+        return b;
+    }
+
+    /**
+     * @brief Opens a pipe. payload_width is ignored with dynamic payloads.
+     */
+    constexpr Nrf24ConfigBuilder pipe(uint8_t n, bool auto_ack, bool dynamic_payload, widths payload_width) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.en_rxaddr |= 1 << n;
+        if (auto_ack)        b.img.en_aa |= 1 << n;
+        if (dynamic_payload) b.img.dynpd |= 1 << n;
+        if (dynamic_payload) b.img.feature |= NRF24L01P_FEATURE_EN_DPL;
+        b.img.rx_pw[n] = dynamic_payload ? 0 : payload_width;
+        return b;
+    }
+
+    constexpr Nrf24ConfigBuilder ack_payloads(bool enable) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        if (enable) b.img.feature |= NRF24L01P_FEATURE_EN_ACK_PAY;
+        else        b.img.feature &= ~NRF24L01P_FEATURE_EN_ACK_PAY;
+        return b;
+    }
+
+    /**
+     * @brief Masks IRQ sources in CONFIG (NRF24L01P_CONFIG_MASK_* bits).
+     */
+    constexpr Nrf24ConfigBuilder mask_irq(uint8_t mask) const
+    {
+        Nrf24ConfigBuilder b = *this;
+        b.img.config = (b.img.config & 0x0F) | (mask & 0x70);
+        return b;
+    }
+
+    constexpr nrf24l01p_register_image image() const
+    {
+        return img;
+    }
+
+    /**
+     * @brief SPI transactions nrf24l01p_apply_image() spends on this image.
+     * @param verify Include the readback pass.
+     */
+    constexpr uint8_t transactions(bool verify) const
+    {
+        // 9 fixed registers + RX_PW of static pipes + STATUS clear + 2 flushes
+        uint8_t widths_written = 0;
+        for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+        {
+            if ((img.en_rxaddr & (1 << pipe)) && !(img.dynpd & (1 << pipe)))
+                widths_written++;
+        }
+
+        uint8_t writes = 9 + widths_written + 3;
+        return verify ? writes + 9 + widths_written : writes;
+    }
+
+private:
+    nrf24l01p_register_image img;
+};
+
+#endif // __cplusplus
+
+#endif /* __NRF24L01P_CONFIG_H__ */
@@ -0,0 +1,1262 @@
+/*
+ *  nrf24l01p_device.h
+ *
+ *  nRF24L01+ driver as a class template, bound at compile time to an SPI
+ *  handle and to its CS/CE pins. Every radio is its own instantiation, so
+ *  there is no runtime dispatch and CS/CE are single BSRR stores.
+ *
+ *  Nrf24Device<hspi2, GpioPin<GPIOB_BASE, GPIO_PIN_12>, GpioPin<GPIOB_BASE, GPIO_PIN_10>> radio2;
+ *
+ *  The C API in nrf24l01p.h forwards to the instance wired to SPI1.
+ */
+
+#ifndef __NRF24L01P_DEVICE_H__
+#define __NRF24L01P_DEVICE_H__
+
+#include "nrf24l01p.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+
+#ifdef __cplusplus
+#include "spsc_ring.h"
+#include "packet_pool.h"
+#include <stddef.h>
+#endif
+
+#ifdef __cplusplus
+
+/**
+ * @brief Output pin driven through its port's BSRR register.
+ * @tparam PortBase GPIOx_BASE address of the port.
+ * @tparam Pin GPIO_PIN_x mask.
+ */
+template <uintptr_t PortBase, uint16_t Pin>
+struct GpioPin
+{
+    static inline void set()
+    {
+        reinterpret_cast<GPIO_TypeDef*>(PortBase)->BSRR = Pin;
+    }
+
+    static inline void reset()
+    {
+        reinterpret_cast<GPIO_TypeDef*>(PortBase)->BSRR = (uint32_t)Pin << 16;
+    }
+};
+
+/**
+ * @brief nRF24L01+ on one SPI bus.
+ * @tparam Spi HAL handle of the bus (must have external linkage, e.g. hspi1).
+ * @tparam CsPin GpioPin driving CSN.
+ * @tparam CePin GpioPin driving CE.
+ */
+template <SPI_HandleTypeDef& Spi, typename CsPin, typename CePin>
+class Nrf24Device
+{
+public:
+    Nrf24Device()
+    {
+        memset(this->shadow, 0, sizeof(this->shadow));
+        memset(&this->spi_stats, 0, sizeof(this->spi_stats));
+        this->shadow_valid = false;
+        this->address_width = 5;
+        this->ce_active = false;
+        this->active_profile = &NRF24L01P_PROFILE_DEFAULT;
+        this->async_waiter = NULL;
+        this->async_busy = false;
+        this->async_error = false;
+        memset(&this->engine_config, 0, sizeof(this->engine_config));
+        memset(&this->engine_stats, 0, sizeof(this->engine_stats));
+        memset(this->engine_tx_frame, NRF24L01P_CMD_NOP, sizeof(this->engine_tx_frame));
+        this->engine_state = ENGINE_IDLE;
+        this->engine_enabled = false;
+        this->engine_paused = false;
+        this->engine_rerun = false;
+        this->engine_parked = false;
+        this->engine_timeout_ticks = 0;
+        this->engine_first_tick = 0;
+        this->engine_slot = NRF24L01P_PACKET_NONE;
+        this->engine_edge = 0;
+        this->engine_edge_pending = false;
+        this->engine_arrival = 0;
+        this->engine_rpd = 0;
+    }
+
+    /* Main Functions */
+    void rx_init(channel MHz, air_data_rate bps)
+    {
+        reset();
+
+        prx_mode();
+        power_up();
+
+        rx_set_payload_widths(NRF24L01P_PAYLOAD_LENGTH);
+
+        set_rf_channel(MHz);
+        set_rf_air_data_rate(bps);
+        set_rf_tx_output_power(_0dBm);
+
+        set_crc_length(1);
+        set_address_widths(5);
+
+        auto_retransmit_count(3);
+        auto_retransmit_delay(250);
+
+        ce_high();
+    }
+
+    void tx_init(channel MHz, air_data_rate bps)
+    {
+        reset();
+
+        ptx_mode();
+        power_up();
+
+        set_rf_channel(MHz);
+        set_rf_air_data_rate(bps);
+        set_rf_tx_output_power(_0dBm);
+
+        set_crc_length(1);
+        set_address_widths(5);
+
+        auto_retransmit_count(3);
+        auto_retransmit_delay(250);
+
+        ce_high();
+    }
+
+    void rx_receive(uint8_t* rx_payload)
+    {
+        read_rx_fifo(rx_payload);
+        clear_rx_dr();
+    }
+
+    void tx_transmit(uint8_t* tx_payload)
+    {
+        write_tx_fifo(tx_payload);
+    }
+
+    void tx_irq()
+    {
+        if(get_status() & NRF24L01P_STATUS_TX_DS)
+            clear_tx_ds();
+        else
+            clear_max_rt();
+    }
+
+    /* Register Image */
+    bool apply_image(const nrf24l01p_register_image* image, bool verify)
+    {
+        // CONFIG first so the oscillator starts while the rest is written;
+        // FEATURE before DYNPD, which is ignored while EN_DPL is clear
+        const uint8_t regs[] = {
+            NRF24L01P_REG_CONFIG,
+            NRF24L01P_REG_EN_AA,
+            NRF24L01P_REG_EN_RXADDR,
+            NRF24L01P_REG_SETUP_AW,
+            NRF24L01P_REG_SETUP_RETR,
+            NRF24L01P_REG_RF_CH,
+            NRF24L01P_REG_RF_SETUP,
+            NRF24L01P_REG_FEATURE,
+            NRF24L01P_REG_DYNPD
+        };
+        const uint8_t values[] = {
+            image->config,
+            image->en_aa,
+            image->en_rxaddr,
+            image->setup_aw,
+            image->setup_retr,
+            image->rf_ch,
+            image->rf_setup,
+            image->feature,
+            image->dynpd
+        };
+        bool match = true;
+
+        cs_high();
+        ce_low();
+
+        for(uint8_t i = 0; i < sizeof(regs); i++)
+            write_register(regs[i], values[i]);
+
+        // Widths only matter on enabled static-payload pipes
+        for(uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+        {
+            if(nrf24l01p_image_pipe_needs_width(image, pipe))
+                write_register(NRF24L01P_REG_RX_PW_P0 + pipe, image->rx_pw[pipe]);
+        }
+
+        write_register(NRF24L01P_REG_STATUS, NRF24L01P_STATUS_RX_DR | NRF24L01P_STATUS_TX_DS | NRF24L01P_STATUS_MAX_RT);
+        flush_rx_fifo();
+        flush_tx_fifo();
+
+        this->address_width = image->setup_aw + 2;
+        this->shadow_valid = true;
+
+        if(!verify)
+            return true;
+
+        for(uint8_t i = 0; i < sizeof(regs); i++)
+        {
+            if(read_register(regs[i]) != values[i])
+                match = false;
+        }
+        for(uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+        {
+            if(nrf24l01p_image_pipe_needs_width(image, pipe) &&
+               read_register(NRF24L01P_REG_RX_PW_P0 + pipe) != image->rx_pw[pipe])
+                match = false;
+        }
+
+        return match;
+    }
+
+    void ce_high()
+    {
+        this->ce_active = true;
+        CePin::set();
+    }
+
+    void ce_low()
+    {
+        this->ce_active = false;
+        CePin::reset();
+    }
+
+    /* Sub Functions */
+    void reset()
+    {
+        // Reset pins
+        cs_high();
+        ce_low();
+
+        // Reset registers
+        write_register(NRF24L01P_REG_CONFIG, 0x08);
+        write_register(NRF24L01P_REG_EN_AA, 0x3F);
+        write_register(NRF24L01P_REG_EN_RXADDR, 0x03);
+        write_register(NRF24L01P_REG_SETUP_AW, 0x03);
+        write_register(NRF24L01P_REG_SETUP_RETR, 0x03);
+        write_register(NRF24L01P_REG_RF_CH, 0x02);
+        write_register(NRF24L01P_REG_RF_SETUP, 0x07);
+        write_register(NRF24L01P_REG_STATUS, 0x7E);
+        write_register(NRF24L01P_REG_RX_PW_P0, 0x00);
+        write_register(NRF24L01P_REG_RX_PW_P1, 0x00);
+        write_register(NRF24L01P_REG_RX_PW_P2, 0x00);
+        write_register(NRF24L01P_REG_RX_PW_P3, 0x00);
+        write_register(NRF24L01P_REG_RX_PW_P4, 0x00);
+        write_register(NRF24L01P_REG_RX_PW_P5, 0x00);
+        write_register(NRF24L01P_REG_FIFO_STATUS, 0x11);
+        write_register(NRF24L01P_REG_DYNPD, 0x00);
+        write_register(NRF24L01P_REG_FEATURE, 0x00);
+
+        // Every shadowed register has been written above
+        this->shadow_valid = true;
+        this->address_width = 5;
+
+        // Reset FIFO
+        flush_rx_fifo();
+        flush_tx_fifo();
+    }
+
+    void prx_mode()
+    {
+        uint8_t new_config = read_cached_register(NRF24L01P_REG_CONFIG);
+        new_config |= NRF24L01P_CONFIG_PRIM_RX;
+
+        write_register(NRF24L01P_REG_CONFIG, new_config);
+    }
+
+    void ptx_mode()
+    {
+        uint8_t new_config = read_cached_register(NRF24L01P_REG_CONFIG);
+        new_config &= ~NRF24L01P_CONFIG_PRIM_RX;
+
+        write_register(NRF24L01P_REG_CONFIG, new_config);
+    }
+
+    void power_up()
+    {
+        uint8_t new_config = read_cached_register(NRF24L01P_REG_CONFIG);
+        new_config |= NRF24L01P_CONFIG_PWR_UP;
+
+        write_register(NRF24L01P_REG_CONFIG, new_config);
+    }
+
+    void power_down()
+    {
+        uint8_t new_config = read_cached_register(NRF24L01P_REG_CONFIG);
+        new_config &= ~NRF24L01P_CONFIG_PWR_UP;
+
+        write_register(NRF24L01P_REG_CONFIG, new_config);
+    }
+
+    void set_tx_address(const uint8_t* address)
+    {
+        write_register_multi(NRF24L01P_REG_TX_ADDR, address, this->address_width);
+    }
+
+    void set_rx_address_p0(const uint8_t* address)
+    {
+        write_register_multi(NRF24L01P_REG_RX_ADDR_P0, address, this->address_width);
+    }
+
+    void configure_pipe(uint8_t pipe, const nrf24l01p_pipe_config* config)
+    {
+        if(pipe >= NRF24L01P_PIPE_COUNT)
+            return;
+
+        // Pipes 2-5 only own the LSB; the upper bytes are shared with pipe 1
+        if(pipe < 2)
+            write_register_multi(NRF24L01P_REG_RX_ADDR_P0 + pipe, config->address, this->address_width);
+        else
+            write_register(NRF24L01P_REG_RX_ADDR_P0 + pipe, config->address[0]);
+
+        // RX_PW_Pn is ignored on dynamic-payload pipes
+        if(!config->dynamic_payload)
+            write_register(NRF24L01P_REG_RX_PW_P0 + pipe, config->payload_width);
+
+        update_register_bit(NRF24L01P_REG_EN_AA, pipe, config->auto_ack);
+
+        uint8_t dynpd = read_cached_register(NRF24L01P_REG_DYNPD);
+        dynpd = config->dynamic_payload ? (dynpd | (1 << pipe)) : (dynpd & ~(1 << pipe));
+        enable_dynamic_payloads(dynpd);
+
+        update_register_bit(NRF24L01P_REG_EN_RXADDR, pipe, true);
+    }
+
+    void disable_pipe(uint8_t pipe)
+    {
+        if(pipe >= NRF24L01P_PIPE_COUNT)
+            return;
+
+        update_register_bit(NRF24L01P_REG_EN_RXADDR, pipe, false);
+    }
+
+    uint8_t get_status()
+    {
+        return spi_transfer(NRF24L01P_CMD_NOP, NULL, NULL, 0);
+    }
+
+    uint8_t get_fifo_status()
+    {
+        return read_register(NRF24L01P_REG_FIFO_STATUS);
+    }
+
+    bool get_rpd()
+    {
+        return (read_register(NRF24L01P_REG_RPD) & 0x01) != 0;
+    }
+
+    void rx_set_payload_widths(widths bytes)
+    {
+        write_register(NRF24L01P_REG_RX_PW_P0, bytes);
+    }
+
+    void enable_dynamic_payloads(uint8_t pipe_mask)
+    {
+        uint8_t new_feature = read_cached_register(NRF24L01P_REG_FEATURE);
+
+        if(pipe_mask)
+            new_feature |= NRF24L01P_FEATURE_EN_DPL;
+        else
+            new_feature &= ~NRF24L01P_FEATURE_EN_DPL;
+
+        // EN_DPL must be set before DYNPD takes effect
+        if(new_feature != read_cached_register(NRF24L01P_REG_FEATURE))
+            write_register(NRF24L01P_REG_FEATURE, new_feature);
+        if((pipe_mask & 0x3F) != read_cached_register(NRF24L01P_REG_DYNPD))
+            write_register(NRF24L01P_REG_DYNPD, pipe_mask & 0x3F);
+    }
+
+    length read_rx_payload_width()
+    {
+        length width;
+
+        spi_transfer(NRF24L01P_CMD_R_RX_PL_WID, NULL, &width, 1);
+
+        return width;
+    }
+
+    uint8_t read_rx_fifo(uint8_t* rx_payload)
+    {
+        return read_rx_payload(rx_payload, NRF24L01P_PAYLOAD_LENGTH);
+    }
+
+    uint8_t read_rx_fifo_length(uint8_t* rx_payload, length len)
+    {
+        if(len > NRF24L01P_PAYLOAD_LENGTH)
+            len = NRF24L01P_PAYLOAD_LENGTH;
+
+        return read_rx_payload(rx_payload, len);
+    }
+
+    uint8_t read_rx_fifo_dynamic(uint8_t* rx_payload, length* len)
+    {
+        length width = read_rx_payload_width();
+
+        if(width == 0 || width > NRF24L01P_PAYLOAD_LENGTH)
+        {
+            // Corrupt width: the datasheet requires the RX FIFO to be flushed
+            flush_rx_fifo();
+            *len = 0;
+            return get_status();
+        }
+
+        *len = width;
+        return read_rx_payload(rx_payload, width);
+    }
+
+    uint8_t write_tx_fifo(const uint8_t* tx_payload)
+    {
+        return spi_transfer(NRF24L01P_CMD_W_TX_PAYLOAD, tx_payload, NULL, NRF24L01P_PAYLOAD_LENGTH);
+    }
+
+    void enable_ack_payloads(bool enable)
+    {
+        uint8_t new_feature = read_cached_register(NRF24L01P_REG_FEATURE);
+
+        if(enable)
+            new_feature |= NRF24L01P_FEATURE_EN_ACK_PAY;
+        else
+            new_feature &= ~NRF24L01P_FEATURE_EN_ACK_PAY;
+
+        write_register(NRF24L01P_REG_FEATURE, new_feature);
+    }
+
+    uint8_t write_ack_payload(uint8_t pipe, const uint8_t* payload, length len)
+    {
+        return spi_transfer(NRF24L01P_CMD_W_ACK_PAYLOAD | (pipe & 0x07), payload, NULL, len);
+    }
+
+    void flush_rx_fifo()
+    {
+        spi_transfer(NRF24L01P_CMD_FLUSH_RX, NULL, NULL, 0);
+    }
+
+    void flush_tx_fifo()
+    {
+        spi_transfer(NRF24L01P_CMD_FLUSH_TX, NULL, NULL, 0);
+    }
+
+    // Write-1-to-clear: other flags are left untouched
+    void clear_rx_dr()
+    {
+        write_register(NRF24L01P_REG_STATUS, NRF24L01P_STATUS_RX_DR);
+    }
+
+    void clear_tx_ds()
+    {
+        write_register(NRF24L01P_REG_STATUS, NRF24L01P_STATUS_TX_DS);
+    }
+
+    void clear_max_rt()
+    {
+        write_register(NRF24L01P_REG_STATUS, NRF24L01P_STATUS_MAX_RT);
+    }
+
+    void set_rf_channel(channel MHz)
+    {
+        write_register(NRF24L01P_REG_RF_CH, MHz);
+    }
+
+    void set_rf_tx_output_power(output_power dBm)
+    {
+        uint8_t new_rf_setup = read_cached_register(NRF24L01P_REG_RF_SETUP) & 0xF9;
+        new_rf_setup |= (dBm << 1);
+
+        write_register(NRF24L01P_REG_RF_SETUP, new_rf_setup);
+    }
+
+    void set_rf_air_data_rate(air_data_rate bps)
+    {
+        // Set value to 0
+        uint8_t new_rf_setup = read_cached_register(NRF24L01P_REG_RF_SETUP) & 0xD7;
+
+        switch(bps)
+        {
+            case _1Mbps:
+                break;
+            case _2Mbps:
+                new_rf_setup |= 1 << 3;
+                break;
+            case _250kbps:
+                new_rf_setup |= 1 << 5;
+                break;
+        }
+        write_register(NRF24L01P_REG_RF_SETUP, new_rf_setup);
+    }
+
+    void set_crc_length(length bytes)
+    {
+        uint8_t new_config = read_cached_register(NRF24L01P_REG_CONFIG);
+
+        switch(bytes)
+        {
+            // No CRC: the chip forces EN_CRC back on while any pipe has EN_AA set
+            case 0:
+                new_config &= ~NRF24L01P_CONFIG_EN_CRC;
+                break;
+            // CRCO bit in CONFIG register set 0
+            case 1:
+                new_config |= NRF24L01P_CONFIG_EN_CRC;
+                new_config &= ~NRF24L01P_CONFIG_CRCO;
+                break;
+            // CRCO bit in CONFIG register set 1
+            case 2:
+                new_config |= NRF24L01P_CONFIG_EN_CRC;
+                new_config |= NRF24L01P_CONFIG_CRCO;
+                break;
+        }
+
+        write_register(NRF24L01P_REG_CONFIG, new_config);
+    }
+
+    void set_address_widths(widths bytes)
+    {
+        this->address_width = bytes;
+        write_register(NRF24L01P_REG_SETUP_AW, bytes - 2);
+    }
+
+    void auto_retransmit_count(count cnt)
+    {
+        uint8_t new_setup_retr = read_cached_register(NRF24L01P_REG_SETUP_RETR);
+
+        // Reset ARC register 0
+        new_setup_retr &= 0xF0;
+        new_setup_retr |= cnt;
+        write_register(NRF24L01P_REG_SETUP_RETR, new_setup_retr);
+    }
+
+    void auto_retransmit_delay(delay us)
+    {
+        uint8_t new_setup_retr = read_cached_register(NRF24L01P_REG_SETUP_RETR);
+
+        // Reset ARD register 0
+        new_setup_retr &= 0x0F;
+        new_setup_retr |= ((us / 250) - 1) << 4;
+        write_register(NRF24L01P_REG_SETUP_RETR, new_setup_retr);
+    }
+
+    /* Air-Time Profiles */
+    void apply_profile(const nrf24l01p_profile* profile)
+    {
+        bool was_active = this->ce_active;
+
+        // Leave RX/TX while the air format changes; no reset needed
+        ce_low();
+
+        set_rf_air_data_rate(profile->bps);
+        set_rf_tx_output_power(profile->dBm);
+        set_crc_length(profile->crc_bytes);
+        set_address_widths(profile->address_bytes);
+
+        this->active_profile = profile;
+
+        if(was_active)
+            ce_high();
+    }
+
+    const nrf24l01p_profile* get_profile() const
+    {
+        return this->active_profile;
+    }
+
+    /* Shadow Registers */
+    uint8_t verify_registers()
+    {
+        static const uint8_t regs[] = {
+            NRF24L01P_REG_CONFIG,
+            NRF24L01P_REG_EN_AA,
+            NRF24L01P_REG_EN_RXADDR,
+            NRF24L01P_REG_SETUP_RETR,
+            NRF24L01P_REG_RF_SETUP,
+            NRF24L01P_REG_DYNPD,
+            NRF24L01P_REG_FEATURE
+        };
+        uint8_t diverged = 0;
+
+        if(!this->shadow_valid)
+            return 0;
+
+        for(uint8_t i = 0; i < sizeof(regs); i++)
+        {
+            uint8_t reg = regs[i];
+
+            if(read_register(reg) != this->shadow[reg])
+            {
+                // Chip lost our value (e.g. brownout): push the shadow copy back
+                write_register(reg, this->shadow[reg]);
+                diverged++;
+            }
+        }
+
+        return diverged;
+    }
+
+    /* SPI Statistics */
+    void get_spi_stats(nrf24l01p_spi_stats* stats) const
+    {
+        *stats = this->spi_stats;
+    }
+
+    void reset_spi_stats()
+    {
+        memset(&this->spi_stats, 0, sizeof(this->spi_stats));
+    }
+
+    /* Asynchronous (DMA) Transactions */
+    bool transfer_async(uint8_t command, const uint8_t* tx_payload, length len)
+    {
+        if(this->async_busy || len > NRF24L01P_PAYLOAD_LENGTH)
+            return false;
+
+        this->async_tx_frame[0] = command;
+        if(tx_payload != NULL)
+            memcpy(&this->async_tx_frame[1], tx_payload, len);
+        else
+            memset(&this->async_tx_frame[1], NRF24L01P_CMD_NOP, len);
+
+        // Drop a stale completion left over from a timed out transaction
+        (void)wait_spi_done(0);
+
+        this->async_waiter = xTaskGetCurrentTaskHandle();
+        this->async_error = false;
+        this->async_busy = true;
+
+        cs_low();
+        if(HAL_SPI_TransmitReceive_DMA(&Spi, this->async_tx_frame, this->async_rx_frame, len + 1) != HAL_OK)
+        {
+            cs_high();
+            this->async_busy = false;
+            return false;
+        }
+
+        this->spi_stats.spi_transactions++;
+        this->spi_stats.spi_bytes += len + 1;
+
+        return true;
+    }
+
+    bool transfer_wait(uint8_t* status, uint8_t* rx_payload, length len, uint32_t timeout_ms)
+    {
+        if(this->async_busy && !wait_spi_done(pdMS_TO_TICKS(timeout_ms)))
+        {
+            // Timed out: abort DMA and release the bus
+            HAL_SPI_Abort(&Spi);
+            cs_high();
+            this->async_busy = false;
+            return false;
+        }
+
+        if(this->async_error)
+            return false;
+
+        if(status != NULL)
+            *status = this->async_rx_frame[0];
+        if(rx_payload != NULL)
+            memcpy(rx_payload, &this->async_rx_frame[1], len);
+
+        return true;
+    }
+
+    // Interrupt context: HAL_SPI_TxRxCpltCallback / HAL_SPI_ErrorCallback
+    void on_spi_txrx_cplt(SPI_HandleTypeDef* hspi)
+    {
+        if(hspi != &Spi)
+            return;
+
+        if(this->engine_state != ENGINE_IDLE)
+        {
+            cs_high();
+            engine_step();
+            return;
+        }
+
+        if(!this->async_busy)
+            return;
+
+        async_complete_from_isr();
+    }
+
+    void on_spi_error(SPI_HandleTypeDef* hspi)
+    {
+        if(hspi != &Spi)
+            return;
+
+        if(this->engine_state != ENGINE_IDLE)
+        {
+            cs_high();
+            engine_fail();
+            return;
+        }
+
+        if(!this->async_busy)
+            return;
+
+        this->async_error = true;
+        async_complete_from_isr();
+    }
+
+    /* Interrupt-Driven Receive Engine */
+    bool rx_engine_start(const nrf24l01p_rx_engine_config* config)
+    {
+        if(this->engine_enabled || config->task == NULL ||
+           config->watermark == 0 || config->watermark > NRF24L01P_RX_RING_SIZE)
+            return false;
+
+        this->engine_config = *config;
+        this->engine_timeout_ticks = pdMS_TO_TICKS(config->timeout_ms);
+        memset(&this->engine_stats, 0, sizeof(this->engine_stats));
+        while(this->ring.front() != NULL)
+        {
+            this->pool.free(*this->ring.front());
+            this->ring.release();
+        }
+        this->engine_rerun = false;
+        this->engine_parked = false;
+        this->engine_paused = false;
+
+        // The IRQ edge of packets already in the FIFO has passed: start one chain now
+        taskENTER_CRITICAL();
+        this->engine_enabled = true;
+        engine_kick();
+        taskEXIT_CRITICAL();
+
+        return true;
+    }
+
+    void rx_engine_stop()
+    {
+        rx_engine_pause();
+        this->engine_enabled = false;
+        this->engine_paused = false;
+    }
+
+    void rx_engine_pause()
+    {
+        taskENTER_CRITICAL();
+        this->engine_paused = true;
+        taskEXIT_CRITICAL();
+
+        // A chain in flight ends within a few transfers
+        while(this->engine_state != ENGINE_IDLE)
+            taskYIELD();
+    }
+
+    void rx_engine_resume()
+    {
+        taskENTER_CRITICAL();
+        this->engine_paused = false;
+        if(this->engine_enabled)
+            engine_kick();
+        taskEXIT_CRITICAL();
+    }
+
+    bool rx_engine_pop(nrf24l01p_packet_handle* handle)
+    {
+        if(!this->ring.pop(*handle))
+            return false;
+
+        // Ring space again: let a parked chain continue
+        engine_unpark();
+        return true;
+    }
+
+    uint8_t rx_engine_pending() const
+    {
+        return (uint8_t)this->ring.size();
+    }
+
+    void rx_engine_get_stats(nrf24l01p_rx_engine_stats* stats) const
+    {
+        *stats = this->engine_stats;
+    }
+
+    /* Received-Packet Pool */
+    nrf24l01p_packet_handle rx_packet_alloc()
+    {
+        return this->pool.alloc();
+    }
+
+    nrf24l01p_rx_packet* rx_packet_get(nrf24l01p_packet_handle handle)
+    {
+        return this->pool.get(handle);
+    }
+
+    void rx_packet_free(nrf24l01p_packet_handle handle)
+    {
+        if(handle == NRF24L01P_PACKET_NONE)
+            return;
+
+        this->pool.free(handle);
+        engine_unpark();
+    }
+
+    void rx_pool_get_stats(nrf24l01p_pool_stats* stats) const
+    {
+        typename RxPool::Stats pool_stats = this->pool.get_stats();
+
+        stats->capacity = pool_stats.capacity;
+        stats->in_use = pool_stats.in_use;
+        stats->high_water = pool_stats.high_water;
+        stats->alloc_failures = pool_stats.alloc_failures;
+    }
+
+    // Interrupt context: EXTI on the IRQ pin, timestamp taken on entry
+    void rx_engine_irq(uint32_t timestamp)
+    {
+        this->engine_edge = timestamp;
+        this->engine_edge_pending = true;
+
+        if(this->engine_enabled && !this->engine_paused)
+            engine_kick();
+    }
+
+    // Interrupt context: FreeRTOS tick hook
+    void rx_engine_tick()
+    {
+        if(!this->engine_enabled || rx_engine_pending() == 0)
+            return;
+
+        if(xTaskGetTickCountFromISR() - this->engine_first_tick >= this->engine_timeout_ticks)
+        {
+            this->engine_stats.timeout_wakeups++;
+            engine_notify(this->engine_config.ready_bits);
+        }
+    }
+
+private:
+    static inline void cs_high()
+    {
+        CsPin::set();
+    }
+
+    static inline void cs_low()
+    {
+        CsPin::reset();
+    }
+
+    static bool is_shadowed(uint8_t reg)
+    {
+        switch(reg)
+        {
+            case NRF24L01P_REG_CONFIG:
+            case NRF24L01P_REG_EN_AA:
+            case NRF24L01P_REG_EN_RXADDR:
+            case NRF24L01P_REG_SETUP_RETR:
+            case NRF24L01P_REG_RF_SETUP:
+            case NRF24L01P_REG_DYNPD:
+            case NRF24L01P_REG_FEATURE:
+            // Static widths, needed by the receive engine
+            case NRF24L01P_REG_RX_PW_P0:
+            case NRF24L01P_REG_RX_PW_P1:
+            case NRF24L01P_REG_RX_PW_P2:
+            case NRF24L01P_REG_RX_PW_P3:
+            case NRF24L01P_REG_RX_PW_P4:
+            case NRF24L01P_REG_RX_PW_P5:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Clock command and data as one frame inside one CS window.
+    // tx may be NULL (NOPs are clocked out), rx may be NULL (data is discarded).
+    // Returns the STATUS byte shifted out while the command was sent.
+    uint8_t spi_transfer(uint8_t command, const uint8_t* tx, uint8_t* rx, length len)
+    {
+        uint8_t tx_frame[NRF24L01P_PAYLOAD_LENGTH + 1];
+        uint8_t rx_frame[NRF24L01P_PAYLOAD_LENGTH + 1];
+
+        if(len > NRF24L01P_PAYLOAD_LENGTH)
+            len = NRF24L01P_PAYLOAD_LENGTH;
+
+        tx_frame[0] = command;
+        if(tx != NULL)
+            memcpy(&tx_frame[1], tx, len);
+        else
+            memset(&tx_frame[1], NRF24L01P_CMD_NOP, len);
+
+        cs_low();
+        HAL_SPI_TransmitReceive(&Spi, tx_frame, rx_frame, len + 1, 2000);
+        cs_high();
+
+        this->spi_stats.spi_transactions++;
+        this->spi_stats.spi_bytes += len + 1;
+
+        if(rx != NULL)
+            memcpy(rx, &rx_frame[1], len);
+
+        return rx_frame[0];
+    }
+
+    uint8_t read_register(uint8_t reg)
+    {
+        uint8_t read_val;
+
+        spi_transfer(NRF24L01P_CMD_R_REGISTER | reg, NULL, &read_val, 1);
+
+        return read_val;
+    }
+
+    uint8_t write_register(uint8_t reg, uint8_t value)
+    {
+        if(is_shadowed(reg))
+            this->shadow[reg] = value;
+
+        return spi_transfer(NRF24L01P_CMD_W_REGISTER | reg, &value, NULL, 1);
+    }
+
+    // Configuration registers come from the shadow copy, so a read-modify-write costs one write
+    uint8_t read_cached_register(uint8_t reg)
+    {
+        if(this->shadow_valid && is_shadowed(reg))
+            return this->shadow[reg];
+
+        return read_register(reg);
+    }
+
+    void update_register_bit(uint8_t reg, uint8_t bit, bool set)
+    {
+        uint8_t value = read_cached_register(reg);
+        uint8_t new_value = set ? (value | (1 << bit)) : (value & ~(1 << bit));
+
+        if(new_value != value)
+            write_register(reg, new_value);
+    }
+
+    void write_register_multi(uint8_t reg, const uint8_t* value, uint8_t len)
+    {
+        spi_transfer(NRF24L01P_CMD_W_REGISTER | reg, value, NULL, len);
+    }
+
+    // Pop one payload of len bytes; sleeps on DMA when called from a running task
+    uint8_t read_rx_payload(uint8_t* rx_payload, length len)
+    {
+        uint8_t command = NRF24L01P_CMD_R_RX_PAYLOAD;
+        uint8_t status;
+
+        this->spi_stats.rx_packets++;
+
+        // Sleep on DMA while the payload is clocked in, if we are running in a task
+        if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING &&
+           transfer_async(command, NULL, len))
+        {
+            if(!transfer_wait(&status, rx_payload, len, NRF24L01P_ASYNC_TIMEOUT_MS))
+                status = 0xFF;
+
+            return status;
+        }
+
+        return spi_transfer(command, NULL, rx_payload, len);
+    }
+
+    // Sleep until NRF24L01P_NOTIFY_SPI_DONE is set, leaving the caller's other bits alone
+    static bool wait_spi_done(TickType_t ticks)
+    {
+        TickType_t start = xTaskGetTickCount();
+        TickType_t left = ticks;
+        bool foreign = false;
+        bool done = false;
+
+        for(;;)
+        {
+            uint32_t value = 0;
+
+            if(xTaskNotifyWait(0, NRF24L01P_NOTIFY_SPI_DONE, &value, left) != pdTRUE)
+                break;
+
+            foreign |= (value & ~NRF24L01P_NOTIFY_SPI_DONE) != 0;
+            if(value & NRF24L01P_NOTIFY_SPI_DONE)
+            {
+                done = true;
+                break;
+            }
+
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if(elapsed >= ticks)
+                break;
+            left = ticks - elapsed;
+        }
+
+        // Returning from the wait cleared the pending state; re-arm it for bits we did not own
+        if(foreign)
+            xTaskNotify(xTaskGetCurrentTaskHandle(), 0, eSetBits);
+
+        return done;
+    }
+
+    void async_complete_from_isr()
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        cs_high();
+        this->async_busy = false;
+
+        if(this->async_waiter != NULL)
+        {
+            xTaskNotifyFromISR(this->async_waiter, NRF24L01P_NOTIFY_SPI_DONE, eSetBits, &xHigherPriorityTaskWoken);
+        }
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+
+    static_assert(offsetof(nrf24l01p_rx_packet, payload) == offsetof(nrf24l01p_rx_packet, status) + 1,
+                  "STATUS must directly precede the payload in a packet slot");
+    static_assert(offsetof(nrf24l01p_rx_packet, payload) % 4 == 0 && sizeof(nrf24l01p_rx_packet) % 4 == 0,
+                  "Packet slots must keep every payload word-aligned");
+
+    enum EngineState
+    {
+        ENGINE_IDLE,
+        ENGINE_CLEAR,               // W_REGISTER STATUS = RX_DR; shifts out STATUS
+        ENGINE_RPD,                 // R_REGISTER RPD, once per chain
+        ENGINE_WIDTH,               // R_RX_PL_WID; shifts out STATUS and the top payload's width
+        ENGINE_PAYLOAD,             // R_RX_PAYLOAD
+        ENGINE_FLUSH                // FLUSH_RX after a corrupt width
+    };
+
+    // Start (or schedule) a drain chain. Interrupt context or interrupts masked.
+    void engine_kick()
+    {
+        if(this->engine_state != ENGINE_IDLE)
+        {
+            // Packet landed after the chain cleared RX_DR: go round once more
+            this->engine_rerun = true;
+            return;
+        }
+        if(this->engine_parked)
+            return;
+
+        // Packets of this chain arrived by the edge that started it; without one
+        // (resume, poll, unpark) the read time is the best bound
+        this->engine_arrival = this->engine_edge_pending ? this->engine_edge : NRF24L01P_TIMESTAMP();
+        this->engine_edge_pending = false;
+
+        this->engine_stats.chains++;
+        this->engine_tx_frame[1] = NRF24L01P_STATUS_RX_DR;
+        engine_transfer(ENGINE_CLEAR, NRF24L01P_CMD_W_REGISTER | NRF24L01P_REG_STATUS, 1, this->engine_rx_frame);
+    }
+
+    // Task context: ring or pool space came back
+    void engine_unpark()
+    {
+        if(!this->engine_parked)
+            return;
+
+        taskENTER_CRITICAL();
+        this->engine_parked = false;
+        if(this->engine_enabled && !this->engine_paused)
+            engine_kick();
+        taskEXIT_CRITICAL();
+    }
+
+    // rx receives STATUS followed by len bytes
+    void engine_transfer(EngineState state, uint8_t command, length len, uint8_t* rx)
+    {
+        this->engine_state = state;
+        this->engine_tx_frame[0] = command;
+
+        cs_low();
+        if(HAL_SPI_TransmitReceive_DMA(&Spi, this->engine_tx_frame, rx, len + 1) != HAL_OK)
+        {
+            cs_high();
+            engine_fail();
+            return;
+        }
+
+        this->spi_stats.spi_transactions++;
+        this->spi_stats.spi_bytes += len + 1;
+    }
+
+    // DMA completion of the current step (CS already released)
+    void engine_step()
+    {
+        // After a payload read, STATUS sits in the slot; the next probe refreshes it
+        uint8_t status = this->engine_rx_frame[0];
+        uint8_t pipe = NRF24L01P_STATUS_RX_P_NO(status);
+
+        switch(this->engine_state)
+        {
+            case ENGINE_CLEAR:
+                if(pipe >= NRF24L01P_PIPE_COUNT)
+                    break;
+
+                // RPD is latched by the newest packet: one sample covers the chain's batch
+                this->engine_tx_frame[1] = NRF24L01P_CMD_NOP;
+                engine_transfer(ENGINE_RPD, NRF24L01P_CMD_R_REGISTER | NRF24L01P_REG_RPD, 1, this->engine_rx_frame);
+                return;
+
+            case ENGINE_PAYLOAD:
+                // Probe for the next payload: STATUS and its width come in one frame
+                engine_push();
+                // fall through
+
+            case ENGINE_RPD:
+                if(this->engine_state == ENGINE_RPD)
+                    this->engine_rpd = this->engine_rx_frame[1] & 0x01;
+
+                if(this->ring.full())
+                {
+                    this->engine_parked = true;
+                    this->engine_stats.ring_full++;
+                    break;
+                }
+
+                this->engine_tx_frame[1] = NRF24L01P_CMD_NOP;
+                engine_transfer(ENGINE_WIDTH, NRF24L01P_CMD_R_RX_PL_WID, 1, this->engine_rx_frame);
+                return;
+
+            case ENGINE_WIDTH:
+            {
+                if(pipe >= NRF24L01P_PIPE_COUNT)
+                    break;
+
+                length width = (this->shadow[NRF24L01P_REG_DYNPD] & (1 << pipe))
+                             ? this->engine_rx_frame[1]
+                             : this->shadow[NRF24L01P_REG_RX_PW_P0 + pipe];
+
+                if(width == 0 || width > NRF24L01P_PAYLOAD_LENGTH)
+                {
+                    this->engine_stats.errors++;
+                    engine_transfer(ENGINE_FLUSH, NRF24L01P_CMD_FLUSH_RX, 0, this->engine_rx_frame);
+                    return;
+                }
+
+                // The payload is clocked straight into its slot, no copy
+                this->engine_slot = this->pool.alloc_from_isr();
+                if(this->engine_slot == NRF24L01P_PACKET_NONE)
+                {
+                    this->engine_parked = true;
+                    this->engine_stats.pool_empty++;
+                    break;
+                }
+
+                nrf24l01p_rx_packet* packet = this->pool.get(this->engine_slot);
+                packet->pipe = pipe;
+                packet->len = width;
+                engine_transfer(ENGINE_PAYLOAD, NRF24L01P_CMD_R_RX_PAYLOAD, width, &packet->status);
+                return;
+            }
+
+            case ENGINE_FLUSH:
+            case ENGINE_IDLE:
+                break;
+        }
+
+        engine_finish();
+    }
+
+    void engine_push()
+    {
+        TickType_t now = xTaskGetTickCountFromISR();
+        nrf24l01p_rx_packet* packet = this->pool.get(this->engine_slot);
+
+        packet->timestamp = now;
+        packet->arrival = this->engine_arrival;
+        packet->rpd = this->engine_rpd;
+
+        // Ring space was checked before the payload read was started
+        if(this->ring.empty())
+            this->engine_first_tick = now;
+        this->ring.push(this->engine_slot);
+        this->engine_slot = NRF24L01P_PACKET_NONE;
+
+        this->engine_stats.packets++;
+        this->spi_stats.rx_packets++;
+
+        if(rx_engine_pending() >= this->engine_config.watermark)
+        {
+            this->engine_stats.watermark_wakeups++;
+            engine_notify(this->engine_config.ready_bits);
+        }
+    }
+
+    void engine_finish()
+    {
+        this->engine_state = ENGINE_IDLE;
+
+        if(this->engine_rerun)
+        {
+            this->engine_rerun = false;
+            if(!this->engine_paused)
+                engine_kick();
+        }
+    }
+
+    void engine_fail()
+    {
+        if(this->engine_slot != NRF24L01P_PACKET_NONE)
+        {
+            this->pool.free_from_isr(this->engine_slot);
+            this->engine_slot = NRF24L01P_PACKET_NONE;
+        }
+
+        this->engine_state = ENGINE_IDLE;
+        this->engine_rerun = false;
+        this->engine_stats.errors++;
+        engine_notify(this->engine_config.error_bits);
+    }
+
+    void engine_notify(uint32_t bits)
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+        if(bits == 0 || this->engine_config.task == NULL)
+            return;
+
+        xTaskNotifyFromISR(this->engine_config.task, bits, eSetBits, &xHigherPriorityTaskWoken);
+        portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
+
+    /* Shadow copies of the configuration registers, indexed by register address */
+    uint8_t shadow[NRF24L01P_REG_FEATURE + 1];
+    bool shadow_valid;              // Set once every shadowed register has been written
+    widths address_width;           // Bytes per RX/TX address, as programmed into SETUP_AW
+    bool ce_active;                 // CE level last driven (RX/TX enabled)
+    const nrf24l01p_profile* active_profile;
+
+    nrf24l01p_spi_stats spi_stats;
+
+    /* Asynchronous (DMA) transaction state */
+    uint8_t async_tx_frame[NRF24L01P_PAYLOAD_LENGTH + 1];
+    uint8_t async_rx_frame[NRF24L01P_PAYLOAD_LENGTH + 1];
+    volatile TaskHandle_t async_waiter;
+    volatile bool async_busy;
+    volatile bool async_error;
+
+    /* Receive engine state; the ring is filled by interrupts and drained by one task */
+    nrf24l01p_rx_engine_config engine_config;
+    nrf24l01p_rx_engine_stats engine_stats;
+    uint8_t engine_tx_frame[NRF24L01P_PAYLOAD_LENGTH + 1];
+    uint8_t engine_rx_frame[NRF24L01P_PAYLOAD_LENGTH + 1];
+    volatile EngineState engine_state;
+    volatile bool engine_enabled;
+    volatile bool engine_paused;    // The task owns the bus
+    volatile bool engine_rerun;     // IRQ edge seen while a chain was running
+    volatile bool engine_parked;    // Chain stopped on a full ring
+    nrf24l01p_packet_handle engine_slot;    // Slot of the payload read in flight
+    volatile uint32_t engine_edge;          // Timestamp of the latest IRQ edge
+    volatile bool engine_edge_pending;      // ...not yet claimed by a chain
+    uint32_t engine_arrival;                // Arrival stamp of the current chain
+    uint8_t engine_rpd;                     // RPD sampled by the current chain
+    TickType_t engine_timeout_ticks;
+    volatile TickType_t engine_first_tick;  // Arrival of the oldest packet in the ring
+    SpscRing<nrf24l01p_packet_handle, NRF24L01P_RX_RING_SIZE> ring;
+
+    typedef PacketPool<nrf24l01p_rx_packet, NRF24L01P_RX_POOL_SIZE> RxPool;
+    RxPool pool;
+};
+
+/**
+ * @brief The radio on SPI1 that backs the nrf24l01p_* C API.
+ */
+typedef Nrf24Device<NRF24L01P_SPI_HANDLE,
+                    GpioPin<NRF24L01P_SPI_CS_PIN_BASE, NRF24L01P_SPI_CS_PIN_NUMBER>,
+                    GpioPin<NRF24L01P_CE_PIN_BASE, NRF24L01P_CE_PIN_NUMBER> > Nrf24Default;
+
+extern Nrf24Default g_nrf24;
+
+#endif // __cplusplus
+
+#endif /* __NRF24L01P_DEVICE_H__ */
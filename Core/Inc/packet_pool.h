@@ -0,0 +1,116 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+
+/**
+ * @brief Fixed-block pool of N elements handed out by 8-bit handle.
+ * @note alloc/free are short critical sections, so any task and (with the
+ *       _from_isr variants) any interrupt below configMAX_SYSCALL_INTERRUPT_PRIORITY
+ *       may use the pool. Whoever holds a handle owns the block until it frees it.
+ * @tparam T Block type.
+ * @tparam N Number of blocks (at most 255; 0xFF is the "no block" handle).
+ */
+template <typename T, uint8_t N>
+class PacketPool
+{
+    static_assert(N > 0 && N < 0xFF, "PacketPool holds 1..254 blocks");
+
+public:
+    typedef uint8_t Handle;
+    static const Handle NONE = 0xFF;
+
+    struct Stats
+    {
+        uint8_t capacity;
+        uint8_t in_use;
+        uint8_t high_water;         // Most blocks ever in use at once
+        uint32_t alloc_failures;    // alloc() calls that found the pool empty
+    };
+
+    PacketPool()
+    {
+        for (uint8_t i = 0; i < N; i++) {
+            this->free_stack[i] = N - 1 - i;
+        }
+        this->free_count = N;
+        this->high_water = 0;
+        this->alloc_failures = 0;
+    }
+
+    Handle alloc(void)
+    {
+        taskENTER_CRITICAL();
+        Handle handle = this->take();
+        taskEXIT_CRITICAL();
+        return handle;
+    }
+
+    Handle alloc_from_isr(void)
+    {
+        UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+        Handle handle = this->take();
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+        return handle;
+    }
+
+    void free(Handle handle)
+    {
+        taskENTER_CRITICAL();
+        this->give(handle);
+        taskEXIT_CRITICAL();
+    }
+
+    void free_from_isr(Handle handle)
+    {
+        UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+        this->give(handle);
+        taskEXIT_CRITICAL_FROM_ISR(saved);
+    }
+
+    T* get(Handle handle)
+    {
+        return (handle < N) ? &this->blocks[handle] : nullptr;
+    }
+
+    bool empty(void) const
+    {
+        return this->free_count == 0;
+    }
+
+    Stats get_stats(void) const
+    {
+        Stats stats = {N, (uint8_t)(N - this->free_count), this->high_water, this->alloc_failures};
+        return stats;
+    }
+
+private:
+    Handle take(void)
+    {
+        if (this->free_count == 0)
+        {
+            this->alloc_failures++;
+            return NONE;
+        }
+
+        Handle handle = this->free_stack[--this->free_count];
+        uint8_t in_use = N - this->free_count;
+        if (in_use > this->high_water) {
+            this->high_water = in_use;
+        }
+        return handle;
+    }
+
+    void give(Handle handle)
+    {
+        configASSERT(handle < N && this->free_count < N);
+        this->free_stack[this->free_count++] = handle;
+    }
+
+    T blocks[N];
+    Handle free_stack[N];
+    volatile uint8_t free_count;
+    uint8_t high_water;
+    uint32_t alloc_failures;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief Packet arrival stamps and their statistics, in DWT cycles.
+ * @note Without the receive engine the EXTI callback stamps the edge and the
+ *       task-side drain takes it; with the engine, packets arrive stamped
+ *       (nrf24l01p_rx_packet::arrival) and only record() is used.
+ *       stamp_edge() from the ISR; the rest from RadioTask.
+ */
+class PacketTiming
+{
+public:
+    /**
+     * @note Gap = arrival minus the previous packet's arrival (0 within one IRQ batch).
+     *       Latency = arrival to the pipe handler being called.
+     */
+    struct Stats
+    {
+        uint32_t packets;
+        uint32_t last_arrival;
+        uint32_t last_gap_cycles;
+        uint32_t min_gap_cycles;
+        uint32_t max_gap_cycles;
+        uint32_t last_latency_cycles;
+        uint32_t max_latency_cycles;
+    };
+
+    PacketTiming();
+
+    /**
+     * @brief An IRQ edge at now (interrupt context).
+     */
+    void stamp_edge(uint32_t now);
+
+    /**
+     * @brief Arrival stamp for the packets of one drain: the latest edge not yet
+     *        taken, else now (polled packets get the read time).
+     */
+    uint32_t take_arrival(uint32_t now);
+
+    /**
+     * @brief One packet stamped arrival reaches its handler at now.
+     */
+    void record(uint32_t arrival, uint32_t now);
+
+    const Stats& get_stats(void) const;
+
+private:
+    volatile uint32_t edge_cycles;  // DWT->CYCCNT at the latest IRQ edge
+    volatile bool edge_pending;     // ...not yet given to a drained packet
+    Stats stats;
+};
+
+#endif // __cplusplus
@@ -1,8 +1,29 @@
 #pragma once
 
 #include "FreeRTOS.h"
-#include "semphr.h"
+#include "task.h"
 #include "main.h"
+#include "nrf24l01p.h"
+
+/**
+ * @brief RadioTask event bits, delivered through its task notification value.
+ */
+#define RADIO_EVENT_RX_READY    (1UL << 0)  // nRF24 IRQ line fell
+#define RADIO_EVENT_ERROR       (1UL << 1)  // SPI transfer to the nRF24 failed
+#define RADIO_EVENT_TIMEOUT     (1UL << 2)  // Nothing happened for RADIO_IDLE_TIMEOUT_MS
+#define RADIO_EVENT_ACK_QUEUED  (1UL << 3)  // queue_ack_payload() added a reply
+#define RADIO_EVENT_MODE        (1UL << 4)  // set_scan_mode() / set_hop_mode() / set_fec_mode() changed the requested mode
+#define RADIO_EVENT_HOP         (1UL << 5)  // TIM2 compare: the hop boundary armed by service_hop()
+#define RADIO_EVENT_ALL         (RADIO_EVENT_RX_READY | RADIO_EVENT_ERROR | \
+                                 RADIO_EVENT_TIMEOUT | RADIO_EVENT_ACK_QUEUED | \
+                                 RADIO_EVENT_MODE | RADIO_EVENT_HOP)
+
+// RadioTask re-checks the IRQ line after this long without events (lost edge)
+#define RADIO_IDLE_TIMEOUT_MS   500
+
+// Channel announcement in an ACK payload on the rendezvous channel: {tag, channel}.
+// A transmitter moves to that channel; after losing the link it goes back to rendezvous.
+#define RADIO_ANNOUNCE_TAG      0xC4
 
 // --- C-Обгортки ---
 #ifdef __cplusplus
@@ -11,6 +32,10 @@ extern "C" {
 
 /**
  * @brief RTOS task entry function (called by freertos.c).
+ * @note The stack (512 words) is set in lb3_Receiver.ioc. Deepest path: task() ->
+ *       drain -> dispatch -> SecureLink::open -> chachapoly_open, ~0.9 KB with the
+ *       FPU exception frame; the snprintf status lines need about as much again.
+ *       get_stack_headroom() reports the measured margin.
  */
 void radio_task_entry(void *argument);
 
@@ -20,9 +45,45 @@ void radio_task_entry(void *argument);
 void radio_init(void);
 
 /**
- * @brief Global semaphore, signaled by the nRF24L01 IRQ pin.
+ * @brief Call from HAL_GPIO_EXTI_Callback for the nRF24 IRQ pin (interrupt context).
+ */
+void radio_irq_callback(void);
+
+/**
+ * @brief Call from HAL_SPI_ErrorCallback (interrupt context).
+ */
+void radio_spi_error_callback(SPI_HandleTypeDef* hspi);
+
+/**
+ * @brief Call from the FreeRTOS tick hook (interrupt context).
+ */
+void radio_tick_callback(void);
+
+/**
+ * @brief Switches between receiving and the spectrum-analyzer sweep.
+ */
+void radio_set_scan_mode(bool enable);
+
+/**
+ * @brief Switches frequency hopping on or off; beacons arrive on beacon_pipe.
+ */
+void radio_set_hop_mode(bool enable, uint8_t beacon_pipe);
+
+/**
+ * @brief Switches the forward-error-correction air format on or off.
+ */
+void radio_set_fec_mode(bool enable);
+
+/**
+ * @brief Requires payloads sealed with key (32 bytes, copied) on a pipe: the way
+ *        in for keys provisioned at run time. Any task.
  */
-extern SemaphoreHandle_t g_radio_irq_sem;
+void radio_set_pipe_key(uint8_t pipe, const uint8_t* key);
+
+/**
+ * @brief Accepts clear-text payloads on a pipe again and wipes its key. Any task.
+ */
+void radio_clear_pipe_key(uint8_t pipe);
 
 #ifdef __cplusplus
 }
@@ -31,6 +92,26 @@ extern SemaphoreHandle_t g_radio_irq_sem;
 // --- C++ Світ ---
 #ifdef __cplusplus
 
+#include "link_quality.h"
+#include "rx_mode.h"
+#include "packet_timing.h"
+#include "channel_scanner.h"
+#include "freq_hopper.h"
+#include "channel_selector.h"
+#include "reassembler.h"
+#include "bulk_receiver.h"
+#include "secure_link.h"
+#include "fec_mode.h"
+#include "ack_payloads.h"
+
+/**
+ * @brief Handler for packets received on one pipe.
+ * @note Runs in RadioTask context. The packet lives in a driver pool slot:
+ *       return true to keep it (pass the handle on, free it with
+ *       nrf24l01p_rx_packet_free() when done), false to let RadioTask free it.
+ */
+typedef bool (*RadioPipeHandler)(nrf24l01p_packet_handle handle, nrf24l01p_rx_packet* packet, void* context);
+
 /**
  * @brief Main class for managing the nRF24L01 Radio (Receiver).
  */
@@ -47,6 +128,196 @@ public:
      */
     void task(void);
 
+    /**
+     * @brief Number of histogram bins: 0..RX FIFO depth payloads, plus one overflow bin.
+     */
+    static const uint8_t BATCH_HISTOGRAM_BINS = NRF24L01P_RX_FIFO_DEPTH + 2;
+
+    /**
+     * @brief Histogram of payloads drained per IRQ wakeup.
+     * @note Bin N counts wakeups that drained N payloads; the last bin also counts larger batches.
+     */
+    const uint32_t* get_batch_histogram(void) const;
+
+    /**
+     * @brief Wakeup statistics; latencies are DWT cycles from the IRQ edge to RadioTask running.
+     */
+    struct WakeStats
+    {
+        uint32_t samples;
+        uint32_t last_cycles;
+        uint32_t min_cycles;
+        uint32_t max_cycles;
+        uint32_t spi_errors;        // RADIO_EVENT_ERROR wakeups
+        uint32_t missed_irqs;       // Timeouts that found the IRQ line still asserted
+    };
+
+    const WakeStats& get_wake_stats(void) const;
+
+    /**
+     * @brief Fewest free words RadioTask's stack has had (uxTaskGetStackHighWaterMark).
+     * @note Scans the unused stack, so call it from a status screen, not per packet.
+     *       0 until the task has started.
+     */
+    uint32_t get_stack_headroom(void) const;
+
+    typedef RxModeController::Mode RxMode;
+    typedef RxModeController::Stats RxModeStats;
+
+    RxMode get_rx_mode(void) const;
+    const RxModeStats& get_rx_mode_stats(void) const;
+
+    typedef PacketTiming::Stats ArrivalStats;
+
+    /**
+     * @brief Packet timing from nrf24l01p_rx_packet::arrival, in DWT cycles.
+     */
+    const ArrivalStats& get_arrival_stats(void) const;
+
+    /**
+     * @brief Per-sender link quality (RPD, loss, duplicates, reordering).
+     */
+    const LinkQuality& get_link_quality(void) const;
+
+    /**
+     * @brief Marks a pipe's payload[0] as a per-packet sequence number for loss
+     *        tracking and duplicate suppression (repeats are not dispatched).
+     */
+    void set_pipe_sequenced(uint8_t pipe, bool sequenced);
+
+    /**
+     * @brief Marks a pipe as carrying framed messages (frame.h) instead of raw payloads.
+     * @note Framed payloads go to the reassembler and complete messages to the
+     *       message handler; the pipe handler is no longer called. The frame's
+     *       first byte is its sequence number, so the pipe is sequenced as well.
+     */
+    void set_pipe_framed(uint8_t pipe, bool framed);
+
+    /**
+     * @brief Registers the handler for reassembled messages (runs in RadioTask).
+     */
+    void set_message_handler(Reassembler::MessageHandler handler, void* context);
+
+    const Reassembler& get_reassembler(void) const;
+
+    /**
+     * @brief Registers where bulk transfers on framed pipes are written (runs in RadioTask).
+     * @note While a transfer is active, its pipe's auto-acks carry the receiver
+     *       status (bulk_receiver.h) whenever no queued ACK payload is waiting.
+     */
+    void set_bulk_sink(BulkReceiver::Sink sink, void* context);
+
+    const BulkReceiver& get_bulk_receiver(void) const;
+
+    /**
+     * @brief Requires sealed payloads (secure_link.h) on a pipe from now on.
+     * @note Unsealed, forged and replayed packets are dropped first, before link
+     *       scoring, hop beacons or any handler see them; the rest go on as plain
+     *       payloads. The counter's low byte is the sequence number, so the pipe
+     *       is sequenced as well. The pipe's auto-acks carry the counter sync
+     *       request (secure_link.h) until its sender answers it.
+     *       Any task; RadioTask takes the key on its next pass.
+     * @param key CHACHAPOLY_KEY_LENGTH bytes (copied), shared with that pipe's sender only.
+     */
+    void set_pipe_key(uint8_t pipe, const uint8_t* key);
+
+    /**
+     * @brief Accepts clear-text payloads on a pipe again (any task, next pass).
+     */
+    void clear_pipe_key(uint8_t pipe);
+
+    const SecureLink& get_secure_link(void) const;
+
+    /**
+     * @brief Requests the FEC air format (fec.h) on every pipe (true) or the normal one.
+     * @note Any task; RadioTask switches on its next pass. Hardware CRC, auto-ack and
+     *       dynamic payloads are off while it is on, so ACK payloads (and bulk
+     *       status) are not sent; the transmitter must switch as well.
+     */
+    void set_fec_mode(bool enable);
+
+    bool is_fec(void) const;
+
+    const FecMode::Stats& get_fec_stats(void) const;
+
+    /**
+     * @brief Requests the spectrum-analyzer mode (true) or normal reception (false).
+     * @note Any task; RadioTask switches on its next pass. While scanning, the display
+     *       shows the spectrum; reception goes on between chunks of SCAN_CHUNK_CHANNELS
+     *       channels (pipes disabled only during a chunk).
+     */
+    void set_scan_mode(bool enable);
+
+    bool is_scanning(void) const;
+
+    const ChannelScanner& get_scanner(void) const;
+
+    /**
+     * @brief Requests frequency hopping (true) or the fixed channel (false).
+     * @param beacon_pipe Open pipe that carries the transmitter's beacons
+     *        (HOP_BEACON_LENGTH bytes, FRAME_TYPE_BEACON); its address seeds
+     *        the hop sequence.
+     * @note Any task; RadioTask switches on its next pass. Other payloads on
+     *       beacon_pipe still go to its handler.
+     */
+    void set_hop_mode(bool enable, uint8_t beacon_pipe);
+
+    const FreqHopper& get_hopper(void) const;
+
+    const ChannelSelector& get_channel_selector(void) const;
+
+    /**
+     * @brief Asks RadioTask to measure the candidate channels and move to the quietest.
+     */
+    void request_channel_selection(void);
+
+    /**
+     * @brief Sets event bits on RadioTask (interrupt context).
+     */
+    void notify_from_isr(uint32_t events);
+
+    /**
+     * @brief Timestamps the IRQ edge and wakes RadioTask (interrupt context).
+     */
+    void irq_from_isr(void);
+
+    /**
+     * @brief Configures a receive pipe and registers the handler for its payloads.
+     * @note Call before the scheduler starts or from RadioTask.
+     * @param pipe Pipe number 0-5 (pipes 2-5 share the upper address bytes of pipe 1).
+     * @param config Address, auto-ack and payload mode (the address is copied).
+     * @param handler Called for every payload whose STATUS.RX_P_NO matches the pipe.
+     * @param context Passed back to the handler.
+     * @return false if pipe is out of range.
+     */
+    bool open_pipe(uint8_t pipe, const nrf24l01p_pipe_config* config,
+                   RadioPipeHandler handler, void* context);
+
+    /**
+     * @brief Disables a receive pipe and drops its handler.
+     */
+    void close_pipe(uint8_t pipe);
+
+    /**
+     * @brief Queues a reply that rides back to the transmitter on a pipe's next auto-ack.
+     * @note Safe to call from any task. Queue depth, loading and flushing: ack_payloads.h.
+     * @param pipe Pipe number 0-5, open with auto_ack and dynamic_payload.
+     * @param data Payload bytes (copied).
+     * @param len 1..NRF24L01P_PAYLOAD_LENGTH bytes.
+     * @return false if the pipe's queue is full, the pipe cannot carry ACK payloads
+     *         or the arguments are invalid.
+     */
+    bool queue_ack_payload(uint8_t pipe, const uint8_t* data, length len);
+
+    const AckPayloads::Stats& get_ack_stats(void) const;
+
+    /**
+     * @brief Selects the air-time profile (data rate, CRC, address width).
+     * @note Applied immediately if the radio is already running (call from RadioTask),
+     *       otherwise on init.
+     */
+    void set_profile(const nrf24l01p_profile* profile);
+
 private:
     /**
      * @brief Initializes the nRF24L01 controller.
@@ -54,6 +325,169 @@ private:
      */
     bool init(void);
 
+    /**
+     * @brief Reads every pending payload out of the RX FIFO into pool slots.
+     * @return Number of payloads drained.
+     */
+    uint8_t drain_rx_fifo(void);
+
+    /**
+     * @brief Takes the payloads the receive engine collected in interrupt context.
+     * @return Number of payloads drained.
+     */
+    uint8_t drain_rx_ring(void);
+
+    /**
+     * @brief Hands one packet to its pipe's handler; frees it unless the handler kept it.
+     */
+    void dispatch(nrf24l01p_packet_handle handle);
+
+    /**
+     * @brief Counts one wakeup in the batch histogram.
+     */
+    void record_batch(uint8_t batch);
+
+    /**
+     * @brief Feeds a batch into the rate estimate and switches between IRQ and poll mode.
+     */
+    void update_rx_mode(uint8_t batch);
+
+    /**
+     * @brief Masks the nRF24 EXTI line for RX_MODE_POLL, unmasks it for RX_MODE_IRQ.
+     */
+    void apply_rx_mode(void);
+
+    /**
+     * @brief Hands keys from set_pipe_key() / clear_pipe_key() to SecureLink.
+     */
+    void apply_pipe_keys(void);
+
+    /**
+     * @brief Ages the link scores and refreshes the display's signal indicator.
+     */
+    void update_link_indicator(void);
+
+    /**
+     * @brief Takes the receiver off the air for RPD measurements (IRQ line masked,
+     *        engine paused, pipes disabled, CE low) and puts it back on rf_channel.
+     */
+    void suspend_rx(bool suspend);
+
+    /**
+     * @brief Enters or leaves the spectrum sweep (histogram, display).
+     */
+    void set_scanning(bool enable);
+
+    /**
+     * @brief Measures the candidates, moves to the rendezvous channel and queues the announcement.
+     */
+    void select_channel(void);
+
+    /**
+     * @brief Carries out ChannelSelector::update(): a selection or the move off
+     *        the rendezvous channel.
+     */
+    void service_channel(void);
+
+    /**
+     * @brief One chunk of the sweep with reception suspended; the display update
+     *        when the chunk finishes a sweep.
+     */
+    void scan_pass(void);
+
+    /**
+     * @brief Starts the hop schedule from the beacon pipe's address, or returns to rf_channel.
+     */
+    void set_hopping(bool enable);
+
+    /**
+     * @brief Retunes when a hop is due and arms the TIM2 alarm (RADIO_EVENT_HOP)
+     *        for the next boundary.
+     * @note Called every pass: a beacon taken since the last call may have moved
+     *       the boundary.
+     */
+    void service_hop(void);
+
+    /**
+     * @brief Moves the receiver to another channel (CE low, RF_CH, CE high).
+     */
+    void tune(uint8_t channel);
+
+    /**
+     * @brief Enters or leaves the FEC air format (CRC, auto-ack, payload widths).
+     */
+    void set_fec(bool enable);
+
+    /**
+     * @brief A pipe's full 5-byte address (pipes 2-5 own only the LSB).
+     */
+    void pipe_address(uint8_t pipe, uint8_t* address) const;
+
+    /**
+     * @brief Enters RX_MODE_POLL or RX_MODE_IRQ (masks/unmasks the nRF24 EXTI line).
+     */
+    void set_rx_mode(RxMode mode);
+
+    /**
+     * @brief Writes a pipe's stored configuration into the nRF24.
+     */
+    void apply_pipe(uint8_t pipe);
+
+    /**
+     * @brief Folds the pending IRQ timestamp into the wakeup statistics.
+     */
+    void record_wake_latency(void);
+
+    /**
+     * @brief AckPayloads::Generator: the counter sync request, else the bulk status
+     *        on the bulk transfer's pipe.
+     */
+    static length generate_ack(uint8_t pipe, uint8_t* out, void* context);
+
+    /**
+     * @brief Reloads the bulk status straight after a bulk packet, once no other
+     *        received packet waits in the ring (see bulk_receiver.h).
+     */
+    void refresh_bulk_status(void);
+
+    struct PipeSlot
+    {
+        nrf24l01p_pipe_config config;
+        uint8_t address[5];
+        RadioPipeHandler handler;
+        void* context;
+        bool open;
+    };
+
+    // --- Class State ---
+    uint32_t batch_histogram[BATCH_HISTOGRAM_BINS];
+    PipeSlot pipes[NRF24L01P_PIPE_COUNT];
+    AckPayloads acks;
+    bool initialized;               // nRF24 configured; pipe changes go to the chip directly
+    const nrf24l01p_profile* profile;
+    volatile TaskHandle_t task_handle;  // RadioTask, once it runs
+    volatile uint32_t irq_cycles;   // DWT->CYCCNT at the first unserviced IRQ edge
+    volatile bool irq_stamped;
+    WakeStats wake_stats;
+    PacketTiming timing;
+    LinkQuality link;
+    Reassembler reassembler;
+    BulkReceiver bulk;
+    SecureLink secure;
+    uint8_t key_requested[NRF24L01P_PIPE_COUNT][CHACHAPOLY_KEY_LENGTH]; // Waiting for apply_pipe_keys()
+    volatile uint8_t key_requests;  // Bit n: pipe n has a key change waiting
+    volatile uint8_t key_clears;    // Bit n: ...and it is clear_pipe_key()
+    FecMode fec;
+    uint8_t framed_pipes;           // Bit n: pipe n carries framed messages
+    uint8_t signal_bars;            // Last level sent to the display
+    ChannelScanner scanner;
+    volatile bool scan_requested;
+    bool scanning;
+    uint8_t rf_channel;             // Receive channel (the current hop while hopping)
+    FreqHopper hopper;
+    ChannelSelector selector;
+    RxModeController rx_mode;
+
     // tx_queue and send_data() видалені, оскільки це приймач
 };
 
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "frame.h"
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief Messages reassembled at once (each slot holds FRAME_MAX_MESSAGE bytes).
+ */
+#define REASSEMBLY_SLOTS        4
+
+/**
+ * @brief A message missing fragments for this long is dropped.
+ */
+#define REASSEMBLY_TIMEOUT_MS   500
+
+/**
+ * @brief Rebuilds framed messages from fragments in any order, out of a fixed arena.
+ * @note Duplicates are dropped, including late copies of a message just delivered.
+ *       A single-fragment message is handed over straight from the packet.
+ *       When every slot is busy the oldest partial message is evicted.
+ *       One task only; no allocation, no locking.
+ */
+class Reassembler
+{
+public:
+    /**
+     * @brief Called once per complete message. data is valid during the call only.
+     */
+    typedef void (*MessageHandler)(uint8_t sender, uint8_t type, const uint8_t* data, uint16_t len, void* context);
+
+    struct Stats
+    {
+        uint32_t messages;
+        uint32_t fragments;
+        uint32_t bytes;             // Message bytes delivered
+        uint32_t duplicates;
+        uint32_t malformed;         // Bad header, short middle fragment, conflicting last index
+        uint32_t timeouts;
+        uint32_t evictions;
+    };
+
+    Reassembler();
+
+    void set_handler(MessageHandler handler, void* context);
+
+    /**
+     * @brief Takes one framed payload.
+     * @param sender Sender id (the pipe); message ids are per sender.
+     * @param now_ms Current time in milliseconds.
+     */
+    void feed(uint8_t sender, const uint8_t* payload, length len, uint32_t now_ms);
+
+    /**
+     * @brief Drops partial messages older than REASSEMBLY_TIMEOUT_MS.
+     */
+    void expire(uint32_t now_ms);
+
+    /**
+     * @brief Partial messages in the arena.
+     */
+    uint8_t pending(void) const;
+
+    const Stats& get_stats(void) const;
+
+private:
+    struct Slot
+    {
+        bool used;
+        uint8_t sender;
+        uint8_t msg_id;
+        uint8_t type;
+        uint8_t last_index;         // REASSEMBLY_UNKNOWN until the last fragment arrives
+        length last_len;
+        uint64_t have;              // Bit n: fragment n stored
+        uint32_t started_ms;
+        uint8_t data[FRAME_MAX_MESSAGE];
+    };
+
+    struct Recent
+    {
+        bool valid;
+        uint8_t msg_id;
+    };
+
+    Slot* find(uint8_t sender, uint8_t msg_id);
+    Slot* claim(uint8_t sender, uint8_t msg_id, uint8_t type, uint32_t now_ms);
+    void deliver(uint8_t sender, uint8_t type, uint8_t msg_id, const uint8_t* data, uint16_t len);
+
+    Slot slots[REASSEMBLY_SLOTS];
+    Recent recent[NRF24L01P_PIPE_COUNT];    // Last message delivered per sender
+    MessageHandler handler;
+    void* context;
+    Stats stats;
+};
+
+#endif // __cplusplus
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief Packet rate that switches IRQ -> poll.
+ */
+#define RX_POLL_ENTER_PPS       1000
+
+/**
+ * @brief Packet rate that switches poll -> IRQ (hysteresis).
+ */
+#define RX_POLL_EXIT_PPS        300
+
+/**
+ * @brief Rate measurement window.
+ */
+#define RX_POLL_RATE_WINDOW_MS  20
+
+/**
+ * @brief Time between polls in RX_MODE_POLL.
+ */
+#define RX_POLL_PERIOD_MS       1
+
+/**
+ * @brief Empty polls in a row that end polling before the window runs out.
+ */
+#define RX_POLL_IDLE_POLLS      10
+
+/**
+ * @brief NAPI-style choice between sleeping on the nRF24 IRQ and budgeted polling,
+ *        from the packet rate.
+ * @note Policy only: the caller masks or unmasks the IRQ line when the mode changes.
+ *       Times are ticks passed in by the caller. Call from RadioTask only.
+ */
+class RxModeController
+{
+public:
+    /**
+     * @brief How RadioTask learns about received packets.
+     */
+    enum Mode
+    {
+        RX_MODE_IRQ,                // Sleep until the nRF24 IRQ (one wakeup per batch)
+        RX_MODE_POLL                // IRQ masked, budgeted poll every RX_POLL_PERIOD_MS
+    };
+
+    /**
+     * @brief Mode counters. Times are in ticks, updated on every rate window.
+     * @note Polls per packet = polls / poll_packets.
+     */
+    struct Stats
+    {
+        uint32_t to_poll;           // IRQ -> poll switches
+        uint32_t to_irq;            // Poll -> IRQ switches
+        uint32_t polls;
+        uint32_t empty_polls;
+        uint32_t poll_packets;      // Packets taken while polling
+        uint32_t irq_ticks;
+        uint32_t poll_ticks;
+    };
+
+    RxModeController();
+
+    /**
+     * @brief Starts accounting in RX_MODE_IRQ.
+     */
+    void start(TickType_t now);
+
+    /**
+     * @brief Feeds one task pass that took batch packets (a poll in RX_MODE_POLL).
+     * @return true if the mode changed.
+     */
+    bool update(uint8_t batch, TickType_t now);
+
+    /**
+     * @brief Forces a mode (e.g. RX_MODE_IRQ before taking the receiver off the air).
+     */
+    void set_mode(Mode mode, TickType_t now);
+
+    Mode get_mode(void) const;
+    const Stats& get_stats(void) const;
+
+private:
+    void bank_time(TickType_t now);
+
+    Mode mode;
+    Stats stats;
+    TickType_t since;               // Start of the current accounting period
+    TickType_t window_start;
+    uint32_t window_packets;
+    uint8_t idle_polls;             // Consecutive empty polls
+};
+
+#endif // __cplusplus
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+#include "nrf24l01p.h"
+#include "chacha20poly1305.h"
+
+/*
+ * Sealed payload (pipes with a key, see SecureLink::set_key):
+ *
+ *   byte 0..3        counter   per-sender packet counter (LE), never reused under one key
+ *   4..len-9         ciphertext
+ *   len-8..len-1     tag       first SECURE_TAG_LENGTH bytes of the Poly1305 tag
+ *
+ * Nonce: the sender's 5-byte pipe address, 3 zero bytes, the counter (LE).
+ * The counter bytes are the associated data. Byte 0 still counts up by one per
+ * packet: once the tag checks out, RadioTask gives it to LinkQuality as the
+ * sequence number.
+ *
+ * Counter sync: after boot or set_key() the receiver has no counter to compare
+ * with, so a recorded packet would be taken once more. Until a pipe is synced its
+ * auto-acks carry {SECURE_SYNC_TAG, challenge (4 bytes LE)}; the sender answers
+ * with a sealed packet whose plaintext is those same SECURE_SYNC_LENGTH bytes.
+ * Its counter starts the replay window. Everything else on the pipe is dropped
+ * until then (no auto-acks in FEC mode, so a pipe cannot sync there).
+ */
+#define SECURE_COUNTER_LENGTH   4
+#define SECURE_TAG_LENGTH       8
+#define SECURE_OVERHEAD         (SECURE_COUNTER_LENGTH + SECURE_TAG_LENGTH)
+#define SECURE_MAX_PLAINTEXT    (NRF24L01P_PAYLOAD_LENGTH - SECURE_OVERHEAD)    // 20 bytes
+#define SECURE_SYNC_TAG         0x5C
+#define SECURE_SYNC_LENGTH      5
+
+// --- C++ World ---
+#ifdef __cplusplus
+
+/**
+ * @brief Counters remembered per sender for replay rejection (the bitmap width).
+ */
+#define SECURE_REPLAY_WINDOW    64
+
+/**
+ * @brief Verifies, decrypts and replay-checks payloads of keyed pipes.
+ * @note One key per sender (pipe). The replay window only moves on packets
+ *       whose tag checked out, so forgeries cannot push real packets out of it.
+ *       An 8-byte tag leaves a forgery a 2^-64 chance per attempt.
+ *       RadioTask only.
+ */
+class SecureLink
+{
+public:
+    struct Stats
+    {
+        uint32_t accepted;
+        uint32_t forged;            // Tag mismatch (wrong key, corrupted or injected)
+        uint32_t replayed;          // Counter already seen or older than the window
+        uint32_t malformed;         // Shorter than SECURE_OVERHEAD
+        uint32_t unsynced;          // Genuine, but the pipe waits for its sync answer
+        uint32_t syncs;             // Sync answers that started the replay window
+        uint32_t bytes;             // Plaintext bytes accepted
+        uint32_t last_cycles;       // DWT cycles of the last open()
+        uint32_t max_cycles;
+        uint64_t total_cycles;      // Over every open(), forgeries included
+        uint64_t total_bytes;       // Payload bytes those cycles were spent on
+    };
+
+    SecureLink();
+
+    /**
+     * @brief Keys a pipe; its payloads must be sealed from now on. The replay window restarts.
+     * @param key CHACHAPOLY_KEY_LENGTH bytes (copied).
+     * @param address The sender's full 5-byte pipe address (nonce prefix).
+     */
+    void set_key(uint8_t pipe, const uint8_t* key, const uint8_t* address);
+
+    /**
+     * @brief Returns a pipe to clear-text payloads and wipes its key.
+     */
+    void clear_key(uint8_t pipe);
+
+    bool is_secure(uint8_t pipe) const;
+
+    /**
+     * @brief Opens a sealed packet in place: on success payload holds the plaintext
+     *        and len its length.
+     * @note On an unsynced pipe the first packet draws the challenge and a correct
+     *       sync answer syncs it; both are consumed (false).
+     * @return false if the packet must be dropped (forged, replayed, too short,
+     *         unsynced or a sync answer).
+     */
+    bool open(nrf24l01p_rx_packet* packet);
+
+    /**
+     * @brief The sync payload for a pipe's next auto-ack, while it waits for one.
+     * @param reply SECURE_SYNC_LENGTH bytes.
+     * @return false if the pipe is synced, not keyed, or has not heard its sender yet.
+     */
+    bool get_sync_request(uint8_t pipe, uint8_t* reply) const;
+
+    const Stats& get_stats(uint8_t pipe) const;
+
+    /**
+     * @brief Average open() cost over all pipes, in DWT cycles per payload byte.
+     */
+    uint32_t get_cycles_per_byte(void) const;
+
+    /**
+     * @brief Seals and opens a len-byte payload rounds times on the DWT counter.
+     * @return Cycles of one open() (what RadioTask spends per packet).
+     */
+    static uint32_t benchmark(length len, uint32_t rounds);
+
+private:
+    struct PipeKey
+    {
+        uint8_t key[CHACHAPOLY_KEY_LENGTH];
+        uint8_t address[5];
+        bool keyed;
+        bool counter_valid;         // Synced: top and seen hold the replay window
+        bool challenge_valid;
+        uint32_t challenge;
+        uint32_t top;               // Highest counter accepted
+        uint64_t seen;              // Bit n: counter top - n accepted
+        Stats stats;
+    };
+
+    /**
+     * @brief True if the counter is new; marks it seen when commit is set.
+     * @note Synced pipes only.
+     */
+    static bool check_replay(PipeKey* pipe, uint32_t counter, bool commit);
+
+    /**
+     * @brief Picks a pipe's challenge from the arrival time of a packet.
+     * @note The F411 has no RNG: the cycle count at an IRQ edge of the sender's
+     *       (independent) clock is the entropy, run through ChaCha20 under the
+     *       pipe key so the challenge cannot be predicted without it.
+     */
+    static void make_challenge(PipeKey* pipe, uint32_t arrival);
+
+    static void make_nonce(const uint8_t* address, uint32_t counter, uint8_t* nonce);
+
+    PipeKey pipes[NRF24L01P_PIPE_COUNT];
+};
+
+#endif // __cplusplus
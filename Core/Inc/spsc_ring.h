@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Fixed-capacity single-producer / single-consumer ring, lock-free.
+ * @note One context pushes (a task or an ISR), one task pops. Indices run
+ *       freely and wrap at 2^32; the slot is index & (N - 1).
+ *       The producer publishes head with release order after the slot is
+ *       written, the consumer publishes tail after the slot is read, so a
+ *       slot is never seen half-written by either side.
+ * @tparam T Element type (copied by value).
+ * @tparam N Capacity, a power of two.
+ */
+template <typename T, uint32_t N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), overflows(0) {}
+
+    // --- Producer ---
+
+    /**
+     * @brief Copies an element in.
+     * @return false (and counts an overflow) if the ring is full.
+     */
+    bool push(const T& item)
+    {
+        T* slot = this->prepare();
+
+        if (slot == nullptr)
+        {
+            this->overflows.store(this->overflows.load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+            return false;
+        }
+
+        *slot = item;
+        this->commit();
+        return true;
+    }
+
+    /**
+     * @brief Slot to fill in place, or nullptr if the ring is full.
+     * @note Nothing is visible to the consumer until commit().
+     */
+    T* prepare(void)
+    {
+        uint32_t h = this->head.load(std::memory_order_relaxed);
+
+        if (h - this->tail.load(std::memory_order_acquire) == N) {
+            return nullptr;
+        }
+        return &this->slots[h & (N - 1)];
+    }
+
+    /**
+     * @brief Publishes the slot returned by prepare().
+     */
+    void commit(void)
+    {
+        this->head.store(this->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // --- Consumer ---
+
+    /**
+     * @brief Copies the oldest element out.
+     * @return false if the ring is empty.
+     */
+    bool pop(T& item)
+    {
+        const T* slot = this->front();
+
+        if (slot == nullptr) {
+            return false;
+        }
+
+        item = *slot;
+        this->release();
+        return true;
+    }
+
+    /**
+     * @brief Oldest element, read in place, or nullptr if the ring is empty.
+     * @note The slot stays owned by the consumer until release().
+     */
+    const T* front(void) const
+    {
+        uint32_t t = this->tail.load(std::memory_order_relaxed);
+
+        if (t == this->head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &this->slots[t & (N - 1)];
+    }
+
+    /**
+     * @brief Hands the slot returned by front() back to the producer.
+     */
+    void release(void)
+    {
+        this->tail.store(this->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // --- Either side (a snapshot; the other side may move meanwhile) ---
+
+    uint32_t size(void) const
+    {
+        return this->head.load(std::memory_order_acquire) - this->tail.load(std::memory_order_acquire);
+    }
+
+    bool empty(void) const { return this->size() == 0; }
+    bool full(void) const { return this->size() == N; }
+    static uint32_t capacity(void) { return N; }
+
+    /**
+     * @brief Pushes rejected because the ring was full.
+     */
+    uint32_t overflow_count(void) const
+    {
+        return this->overflows.load(std::memory_order_relaxed);
+    }
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head;     // Next slot to fill (producer)
+    std::atomic<uint32_t> tail;     // Next slot to read (consumer)
+    std::atomic<uint32_t> overflows;
+};
@@ -55,6 +55,7 @@ void DebugMon_Handler(void);
 void EXTI1_IRQHandler(void);
 void DMA1_Stream1_IRQHandler(void);
 void TIM1_TRG_COM_TIM11_IRQHandler(void);
+void TIM2_IRQHandler(void);
 void I2C1_EV_IRQHandler(void);
 void I2C1_ER_IRQHandler(void);
 void DMA2_Stream0_IRQHandler(void);
@@ -6,6 +6,7 @@
 #include "main.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include <stdbool.h>
 
 // C-wrapper block to ensure C++ compatibility.
 #ifdef __cplusplus
@@ -18,6 +19,13 @@ extern "C" {
 void UI_Blink_Once(void);
 void UI_Blink_Triple(void);
 
+/**
+ * @brief Non-blocking blink for busy tasks: Pulse turns the LED on,
+ *        Service (called from the same task's loop) turns it off after 50ms.
+ */
+void UI_Blink_Pulse(void);
+bool UI_Blink_Service(void);
+
 #ifdef __cplusplus
 }
 #endif
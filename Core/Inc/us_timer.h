@@ -0,0 +1,53 @@
+// us_timer.h
+
+#ifndef INC_US_TIMER_H_
+#define INC_US_TIMER_H_
+
+#include "main.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+
+// Notify bit of us_timer_sleep() (bit 31 is NRF24L01P_NOTIFY_SPI_DONE)
+#define US_TIMER_NOTIFY_SLEEP   (1UL << 30)
+
+// C-wrapper block to ensure C++ compatibility.
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Microseconds on TIM2 (32-bit, 1 MHz, free-running from MX_TIM2_Init()).
+ * @note Wraps every ~71 minutes; compare times with unsigned differences.
+ */
+uint32_t us_timer_now(void);
+
+/**
+ * @brief One-shot alarm on TIM2 CC1: sets bits in task's notification value at `at`.
+ * @note Replaces a pending alarm. A time that has already passed notifies at once.
+ *       Task context only.
+ */
+void us_timer_alarm(TaskHandle_t task, uint32_t bits, uint32_t at);
+
+/**
+ * @brief Disarms the alarm (bits already set stay set).
+ */
+void us_timer_cancel_alarm(void);
+
+/**
+ * @brief Blocks the calling task for `us` microseconds on TIM2 CC2; other tasks run meanwhile.
+ * @note Leaves the caller's other notification bits alone. Spins on the counter
+ *       before the scheduler starts.
+ */
+void us_timer_sleep(uint32_t us);
+
+/**
+ * @brief Compare interrupt hook: called from HAL_TIM_OC_DelayElapsedCallback().
+ */
+void us_timer_oc_callback(TIM_HandleTypeDef *htim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_US_TIMER_H_ */
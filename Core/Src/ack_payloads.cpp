@@ -0,0 +1,236 @@
+#include "ack_payloads.h"
+#include <string.h>
+
+AckPayloads::AckPayloads()
+{
+    memset(this->queues, 0, sizeof(this->queues));
+    this->enabled = 0;
+    this->suspended = false;
+    this->generator = NULL;
+    this->context = NULL;
+    memset(&this->stats, 0, sizeof(this->stats));
+}
+
+void AckPayloads::set_generator(Generator generator, void* context)
+{
+    this->generator = generator;
+    this->context = context;
+}
+
+void AckPayloads::set_pipe_enabled(uint8_t pipe, bool enabled)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    if (enabled) {
+        this->enabled |= (uint8_t)(1U << pipe);
+    } else {
+        this->enabled &= (uint8_t)~(1U << pipe);
+    }
+    taskEXIT_CRITICAL();
+}
+
+void AckPayloads::set_suspended(bool suspended)
+{
+    this->suspended = suspended;
+}
+
+bool AckPayloads::queue(uint8_t pipe, const uint8_t* data, length len)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT || len == 0 || len > NRF24L01P_PAYLOAD_LENGTH) {
+        return false;
+    }
+
+    Queue* queue = &this->queues[pipe];
+    bool queued = false;
+
+    // ACK payloads need an auto-ack to ride on and a dynamic length (DYNPD, EN_DPL)
+    taskENTER_CRITICAL();
+    if ((this->enabled & (1U << pipe)) && queue->count < ACK_QUEUE_DEPTH)
+    {
+        Entry* entry = &queue->entries[(queue->head + queue->count) % ACK_QUEUE_DEPTH];
+        memcpy(entry->data, data, len);
+        entry->len = len;
+        queue->count++;
+        queued = true;
+    }
+    taskEXIT_CRITICAL();
+
+    return queued;
+}
+
+void AckPayloads::on_packet(uint8_t pipe, uint32_t arrival)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT || this->suspended) {
+        return;
+    }
+
+    // The chip acknowledged the packet whether or not it is genuine
+    Queue* queue = &this->queues[pipe];
+    if (queue->loaded && (int32_t)(arrival - queue->loaded_cycles) >= 0)
+    {
+        if (queue->loaded_entry)
+        {
+            taskENTER_CRITICAL();
+            queue->head = (queue->head + 1) % ACK_QUEUE_DEPTH;
+            queue->count--;
+            taskEXIT_CRITICAL();
+            this->stats.replies++;
+        }
+        queue->loaded = false;
+        queue->loaded_entry = false;
+    }
+    queue->parked = false;          // Its sender is back: a flushed reply reloads
+}
+
+void AckPayloads::refill(void)
+{
+    bool paused = false;
+
+    if (this->suspended) {
+        return;
+    }
+
+    for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+    {
+        Queue* queue = &this->queues[pipe];
+
+        if (queue->loaded || queue->parked || !this->waiting(pipe)) {
+            continue;
+        }
+
+        // Take the bus from the receive engine only when there is something to load
+        if (!paused)
+        {
+            nrf24l01p_rx_engine_pause();
+            paused = true;
+        }
+
+        if (nrf24l01p_get_fifo_status() & NRF24L01P_FIFO_STATUS_TX_FULL)
+        {
+            this->stats.fifo_full++;
+            break;
+        }
+
+        // Queued replies go first; generated payloads are built fresh for every auto-ack
+        if (queue->count > 0)
+        {
+            Entry* entry = &queue->entries[queue->head];
+            this->write(pipe, entry->data, entry->len);
+            queue->loaded_entry = true;
+            continue;
+        }
+
+        uint8_t payload[NRF24L01P_PAYLOAD_LENGTH];
+        length len = this->generator(pipe, payload, this->context);
+        this->write(pipe, payload, len);
+    }
+
+    if (paused) {
+        nrf24l01p_rx_engine_resume();
+    }
+}
+
+void AckPayloads::expire(uint32_t now)
+{
+    uint32_t max_age = ACK_MAX_AGE_MS * (SystemCoreClock / 1000U);
+    bool stale = false;
+    bool waiting = false;
+
+    if (this->suspended) {
+        return;
+    }
+
+    for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+    {
+        const Queue* queue = &this->queues[pipe];
+
+        if (queue->loaded && now - queue->loaded_cycles > max_age) {
+            stale = true;
+        } else if (!queue->loaded && !queue->parked && this->waiting(pipe)) {
+            waiting = true;
+        }
+    }
+
+    // An old payload costs nothing until another pipe needs its FIFO slot
+    if (!stale || !waiting) {
+        return;
+    }
+
+    nrf24l01p_rx_engine_pause();
+    bool full = (nrf24l01p_get_fifo_status() & NRF24L01P_FIFO_STATUS_TX_FULL) != 0;
+    if (full) {
+        nrf24l01p_flush_tx_fifo();      // FLUSH_TX empties the FIFO for every pipe
+    }
+    nrf24l01p_rx_engine_resume();
+
+    if (!full) {
+        return;
+    }
+
+    // Queued entries were never popped: they are requeued as they are. Fresh pipes
+    // reload on the next refill(); stale ones wait for their sender
+    for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+    {
+        Queue* queue = &this->queues[pipe];
+
+        if (queue->loaded && now - queue->loaded_cycles > max_age) {
+            queue->parked = true;
+        }
+        queue->loaded = false;
+        queue->loaded_entry = false;
+    }
+    this->stats.flushes++;
+}
+
+bool AckPayloads::load(uint8_t pipe, const uint8_t* data, length len)
+{
+    Queue* queue = &this->queues[pipe];
+
+    nrf24l01p_rx_engine_pause();
+    bool full = (nrf24l01p_get_fifo_status() & NRF24L01P_FIFO_STATUS_TX_FULL) != 0;
+    if (!full)
+    {
+        // A reply loaded ahead of it still goes out first and leaves its queue then
+        bool entry = queue->loaded && queue->loaded_entry;
+        this->write(pipe, data, len);
+        queue->loaded_entry = entry;
+    }
+    nrf24l01p_rx_engine_resume();
+
+    return !full;
+}
+
+bool AckPayloads::is_loaded(uint8_t pipe) const
+{
+    return pipe < NRF24L01P_PIPE_COUNT && this->queues[pipe].loaded;
+}
+
+const AckPayloads::Stats& AckPayloads::get_stats(void) const
+{
+    return this->stats;
+}
+
+bool AckPayloads::waiting(uint8_t pipe)
+{
+    uint8_t payload[NRF24L01P_PAYLOAD_LENGTH];
+
+    if (!(this->enabled & (1U << pipe))) {
+        return false;
+    }
+    return this->queues[pipe].count > 0 ||
+           (this->generator != NULL && this->generator(pipe, payload, this->context) > 0);
+}
+
+void AckPayloads::write(uint8_t pipe, const uint8_t* data, length len)
+{
+    Queue* queue = &this->queues[pipe];
+
+    nrf24l01p_write_ack_payload(pipe, data, len);
+    queue->loaded = true;
+    queue->loaded_entry = false;
+    queue->loaded_cycles = DWT->CYCCNT;
+    this->stats.loads++;
+}
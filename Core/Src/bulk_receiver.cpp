@@ -0,0 +1,249 @@
+#include "bulk_receiver.h"
+#include <string.h>
+
+BulkReceiver::BulkReceiver()
+{
+    this->sink = NULL;
+    this->context = NULL;
+    this->state = BULK_IDLE;
+    this->started = false;
+    this->sender = 0;
+    this->xfer_id = 0;
+    this->size = 0;
+    this->blocks = 0;
+    this->base = 0;
+    this->have = 0;
+    this->last_ms = 0;
+    memset(&this->stats, 0, sizeof(this->stats));
+}
+
+void BulkReceiver::set_sink(Sink sink, void* context)
+{
+    this->sink = sink;
+    this->context = context;
+}
+
+void BulkReceiver::feed(uint8_t sender, const uint8_t* payload, length len, uint32_t now_ms)
+{
+    if (len < 2)
+    {
+        this->stats.malformed++;
+        return;
+    }
+
+    if (payload[1] == FRAME_TYPE_BULK_START)
+    {
+        if (len < BULK_START_LENGTH)
+        {
+            this->stats.malformed++;
+            return;
+        }
+
+        uint32_t size = payload[4] | ((uint32_t)payload[5] << 8) |
+                        ((uint32_t)payload[6] << 16) | ((uint32_t)payload[7] << 24);
+        if (size > BULK_MAX_SIZE)
+        {
+            this->stats.malformed++;
+            return;
+        }
+
+        // Repeated START: the sender has not seen our status yet
+        if (this->started && this->sender == sender && this->xfer_id == payload[2])
+        {
+            this->stats.duplicates++;
+            this->last_ms = now_ms;
+            return;
+        }
+
+        this->start(sender, payload[2], size);
+        this->last_ms = now_ms;
+        return;
+    }
+
+    if (len < BULK_HEADER_LENGTH)
+    {
+        this->stats.malformed++;
+        return;
+    }
+
+    if (!this->started || this->sender != sender || this->xfer_id != payload[2])
+    {
+        this->stats.stale++;
+        return;
+    }
+    this->last_ms = now_ms;
+
+    if (this->state != BULK_RECEIVING)
+    {
+        this->stats.duplicates++;
+        return;
+    }
+
+    uint16_t block = payload[3] | ((uint16_t)payload[4] << 8);
+    if (block >= this->blocks || len - BULK_HEADER_LENGTH != this->block_length(block))
+    {
+        this->stats.malformed++;
+        return;
+    }
+
+    this->take_block(block, &payload[BULK_HEADER_LENGTH], len - BULK_HEADER_LENGTH);
+}
+
+void BulkReceiver::take_block(uint16_t block, const uint8_t* data, length len)
+{
+    if (block < this->base)
+    {
+        this->stats.duplicates++;
+        return;
+    }
+
+    uint16_t offset = block - this->base;
+    if (offset >= BULK_WINDOW)
+    {
+        this->stats.out_of_window++;
+        return;
+    }
+
+    uint32_t bit = 1UL << offset;
+    if (this->have & bit)
+    {
+        this->stats.duplicates++;
+        return;
+    }
+
+    // The next block in order goes straight to the sink; later ones wait in the window
+    if (offset > 0)
+    {
+        memcpy(this->window[block % BULK_WINDOW], data, len);
+        this->have |= bit;
+        return;
+    }
+
+    if (!this->deliver(block, data)) {
+        return;
+    }
+
+    // Slide over the blocks the gap was holding back
+    this->have >>= 1;
+    while (this->have & 1)
+    {
+        if (!this->deliver(this->base, this->window[this->base % BULK_WINDOW])) {
+            return;
+        }
+        this->have >>= 1;
+    }
+
+    if (this->base == this->blocks) {
+        this->finish(BULK_DONE);
+    }
+}
+
+bool BulkReceiver::deliver(uint16_t block, const uint8_t* data)
+{
+    uint16_t len = this->block_length(block);
+
+    if (this->sink != NULL && !this->sink((uint32_t)block * BULK_BLOCK_LENGTH, data, len, this->context))
+    {
+        this->finish(BULK_ABORTED);
+        return false;
+    }
+
+    this->base = block + 1;
+    this->stats.blocks++;
+    this->stats.bytes += len;
+    return true;
+}
+
+void BulkReceiver::expire(uint32_t now_ms)
+{
+    if (this->state == BULK_RECEIVING && now_ms - this->last_ms >= BULK_TIMEOUT_MS)
+    {
+        this->stats.timeouts++;
+        this->finish(BULK_ABORTED);
+    }
+}
+
+void BulkReceiver::start(uint8_t sender, uint8_t xfer_id, uint32_t size)
+{
+    if (this->state == BULK_RECEIVING) {
+        this->finish(BULK_ABORTED);
+    }
+
+    this->started = true;
+    this->sender = sender;
+    this->xfer_id = xfer_id;
+    this->size = size;
+    this->blocks = (uint16_t)((size + BULK_BLOCK_LENGTH - 1) / BULK_BLOCK_LENGTH);
+    this->base = 0;
+    this->have = 0;
+    this->state = BULK_RECEIVING;
+    this->stats.transfers++;
+
+    if (this->blocks == 0) {
+        this->finish(BULK_DONE);
+    }
+}
+
+void BulkReceiver::finish(State state)
+{
+    this->state = state;
+    this->have = 0;
+
+    if (state == BULK_DONE) {
+        this->stats.completed++;
+    } else {
+        this->stats.aborted++;
+    }
+}
+
+uint16_t BulkReceiver::block_length(uint16_t block) const
+{
+    if (block + 1 < this->blocks) {
+        return BULK_BLOCK_LENGTH;
+    }
+    return (uint16_t)(this->size - (uint32_t)block * BULK_BLOCK_LENGTH);
+}
+
+length BulkReceiver::get_status(uint8_t* out) const
+{
+    out[0] = BULK_STATUS_TAG;
+    out[1] = this->xfer_id;
+    out[2] = (uint8_t)this->state;
+    out[3] = (uint8_t)this->base;
+    out[4] = (uint8_t)(this->base >> 8);
+    out[5] = (uint8_t)this->have;
+    out[6] = (uint8_t)(this->have >> 8);
+    out[7] = (uint8_t)(this->have >> 16);
+    out[8] = (uint8_t)(this->have >> 24);
+    return BULK_STATUS_LENGTH;
+}
+
+bool BulkReceiver::is_active(void) const
+{
+    return this->started;
+}
+
+uint8_t BulkReceiver::get_sender(void) const
+{
+    return this->sender;
+}
+
+BulkReceiver::State BulkReceiver::get_state(void) const
+{
+    return this->state;
+}
+
+uint32_t BulkReceiver::get_size(void) const
+{
+    return this->size;
+}
+
+uint32_t BulkReceiver::get_received(void) const
+{
+    return (this->base < this->blocks) ? (uint32_t)this->base * BULK_BLOCK_LENGTH : this->size;
+}
+
+const BulkReceiver::Stats& BulkReceiver::get_stats(void) const
+{
+    return this->stats;
+}
@@ -0,0 +1,319 @@
+#include "chacha20poly1305.h"
+#include <string.h>
+
+#define CHACHA_BLOCK_LENGTH     64
+#define POLY_BLOCK_LENGTH       16
+#define POLY_MASK26             0x3FFFFFFUL
+
+static inline uint32_t load32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void store32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t rotl32(uint32_t v, uint8_t n)
+{
+    return (v << n) | (v >> (32 - n));
+}
+
+#define CHACHA_QR(a, b, c, d)                       \
+    a += b; d = rotl32(d ^ a, 16);                  \
+    c += d; b = rotl32(b ^ c, 12);                  \
+    a += b; d = rotl32(d ^ a, 8);                   \
+    c += d; b = rotl32(b ^ c, 7)
+
+/* ChaCha20 */
+
+struct chacha_ctx
+{
+    uint32_t input[16];
+};
+
+static void chacha_init(chacha_ctx* ctx, const uint8_t* key, const uint8_t* nonce, uint32_t counter)
+{
+    // "expand 32-byte k"
+    ctx->input[0] = 0x61707865;
+    ctx->input[1] = 0x3320646E;
+    ctx->input[2] = 0x79622D32;
+    ctx->input[3] = 0x6B206574;
+    for (uint8_t i = 0; i < 8; i++) {
+        ctx->input[4 + i] = load32(&key[4 * i]);
+    }
+    ctx->input[12] = counter;
+    ctx->input[13] = load32(&nonce[0]);
+    ctx->input[14] = load32(&nonce[4]);
+    ctx->input[15] = load32(&nonce[8]);
+}
+
+/**
+ * @brief One 64-byte keystream block at the context's counter (then advances it).
+ */
+static void chacha_block(chacha_ctx* ctx, uint8_t out[CHACHA_BLOCK_LENGTH])
+{
+    const uint32_t* in = ctx->input;
+    uint32_t x0 = in[0],   x1 = in[1],   x2 = in[2],   x3 = in[3];
+    uint32_t x4 = in[4],   x5 = in[5],   x6 = in[6],   x7 = in[7];
+    uint32_t x8 = in[8],   x9 = in[9],   x10 = in[10], x11 = in[11];
+    uint32_t x12 = in[12], x13 = in[13], x14 = in[14], x15 = in[15];
+
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        // Column round, then diagonal round
+        CHACHA_QR(x0, x4, x8,  x12);
+        CHACHA_QR(x1, x5, x9,  x13);
+        CHACHA_QR(x2, x6, x10, x14);
+        CHACHA_QR(x3, x7, x11, x15);
+        CHACHA_QR(x0, x5, x10, x15);
+        CHACHA_QR(x1, x6, x11, x12);
+        CHACHA_QR(x2, x7, x8,  x13);
+        CHACHA_QR(x3, x4, x9,  x14);
+    }
+
+    store32(&out[0],  x0 + in[0]);
+    store32(&out[4],  x1 + in[1]);
+    store32(&out[8],  x2 + in[2]);
+    store32(&out[12], x3 + in[3]);
+    store32(&out[16], x4 + in[4]);
+    store32(&out[20], x5 + in[5]);
+    store32(&out[24], x6 + in[6]);
+    store32(&out[28], x7 + in[7]);
+    store32(&out[32], x8 + in[8]);
+    store32(&out[36], x9 + in[9]);
+    store32(&out[40], x10 + in[10]);
+    store32(&out[44], x11 + in[11]);
+    store32(&out[48], x12 + in[12]);
+    store32(&out[52], x13 + in[13]);
+    store32(&out[56], x14 + in[14]);
+    store32(&out[60], x15 + in[15]);
+
+    ctx->input[12]++;
+}
+
+static void chacha_xor(chacha_ctx* ctx, uint8_t* data, size_t len)
+{
+    uint8_t stream[CHACHA_BLOCK_LENGTH];
+
+    while (len > 0)
+    {
+        size_t n = (len < CHACHA_BLOCK_LENGTH) ? len : CHACHA_BLOCK_LENGTH;
+
+        chacha_block(ctx, stream);
+        for (size_t i = 0; i < n; i++) {
+            data[i] ^= stream[i];
+        }
+        data += n;
+        len -= n;
+    }
+    memset(stream, 0, sizeof(stream));
+}
+
+/* Poly1305 (26-bit limbs) */
+
+struct poly_ctx
+{
+    uint32_t r[5];
+    uint32_t h[5];
+    uint32_t pad[4];
+};
+
+static void poly_init(poly_ctx* ctx, const uint8_t key[32])
+{
+    // r is clamped as the RFC requires
+    ctx->r[0] = (load32(&key[0])) & 0x3FFFFFF;
+    ctx->r[1] = (load32(&key[3]) >> 2) & 0x3FFFF03;
+    ctx->r[2] = (load32(&key[6]) >> 4) & 0x3FFC0FF;
+    ctx->r[3] = (load32(&key[9]) >> 6) & 0x3F03FFF;
+    ctx->r[4] = (load32(&key[12]) >> 8) & 0x00FFFFF;
+
+    memset(ctx->h, 0, sizeof(ctx->h));
+    for (uint8_t i = 0; i < 4; i++) {
+        ctx->pad[i] = load32(&key[16 + 4 * i]);
+    }
+}
+
+/**
+ * @brief Absorbs 16-byte blocks (all full: the AEAD input is padded to 16 bytes).
+ */
+static void poly_blocks(poly_ctx* ctx, const uint8_t* m, size_t blocks)
+{
+    const uint32_t r0 = ctx->r[0], r1 = ctx->r[1], r2 = ctx->r[2], r3 = ctx->r[3], r4 = ctx->r[4];
+    const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+    uint32_t h0 = ctx->h[0], h1 = ctx->h[1], h2 = ctx->h[2], h3 = ctx->h[3], h4 = ctx->h[4];
+
+    while (blocks-- > 0)
+    {
+        h0 += (load32(&m[0])) & POLY_MASK26;
+        h1 += (load32(&m[3]) >> 2) & POLY_MASK26;
+        h2 += (load32(&m[6]) >> 4) & POLY_MASK26;
+        h3 += (load32(&m[9]) >> 6) & POLY_MASK26;
+        h4 += (load32(&m[12]) >> 8) | (1UL << 24);
+
+        uint64_t d0 = (uint64_t)h0 * r0 + (uint64_t)h1 * s4 + (uint64_t)h2 * s3 + (uint64_t)h3 * s2 + (uint64_t)h4 * s1;
+        uint64_t d1 = (uint64_t)h0 * r1 + (uint64_t)h1 * r0 + (uint64_t)h2 * s4 + (uint64_t)h3 * s3 + (uint64_t)h4 * s2;
+        uint64_t d2 = (uint64_t)h0 * r2 + (uint64_t)h1 * r1 + (uint64_t)h2 * r0 + (uint64_t)h3 * s4 + (uint64_t)h4 * s3;
+        uint64_t d3 = (uint64_t)h0 * r3 + (uint64_t)h1 * r2 + (uint64_t)h2 * r1 + (uint64_t)h3 * r0 + (uint64_t)h4 * s4;
+        uint64_t d4 = (uint64_t)h0 * r4 + (uint64_t)h1 * r3 + (uint64_t)h2 * r2 + (uint64_t)h3 * r1 + (uint64_t)h4 * r0;
+
+        // Partial reduction mod 2^130 - 5
+        uint32_t c;
+        c = (uint32_t)(d0 >> 26); h0 = (uint32_t)d0 & POLY_MASK26;
+        d1 += c; c = (uint32_t)(d1 >> 26); h1 = (uint32_t)d1 & POLY_MASK26;
+        d2 += c; c = (uint32_t)(d2 >> 26); h2 = (uint32_t)d2 & POLY_MASK26;
+        d3 += c; c = (uint32_t)(d3 >> 26); h3 = (uint32_t)d3 & POLY_MASK26;
+        d4 += c; c = (uint32_t)(d4 >> 26); h4 = (uint32_t)d4 & POLY_MASK26;
+        h0 += c * 5; c = h0 >> 26; h0 &= POLY_MASK26;
+        h1 += c;
+
+        m += POLY_BLOCK_LENGTH;
+    }
+
+    ctx->h[0] = h0;
+    ctx->h[1] = h1;
+    ctx->h[2] = h2;
+    ctx->h[3] = h3;
+    ctx->h[4] = h4;
+}
+
+/**
+ * @brief Absorbs data followed by zero padding up to a 16-byte boundary.
+ */
+static void poly_padded(poly_ctx* ctx, const uint8_t* data, size_t len)
+{
+    size_t full = len / POLY_BLOCK_LENGTH;
+    size_t rest = len % POLY_BLOCK_LENGTH;
+
+    poly_blocks(ctx, data, full);
+    if (rest > 0)
+    {
+        uint8_t block[POLY_BLOCK_LENGTH] = {0};
+        memcpy(block, &data[full * POLY_BLOCK_LENGTH], rest);
+        poly_blocks(ctx, block, 1);
+    }
+}
+
+static void poly_finish(poly_ctx* ctx, uint8_t tag[CHACHAPOLY_TAG_LENGTH])
+{
+    uint32_t h0 = ctx->h[0], h1 = ctx->h[1], h2 = ctx->h[2], h3 = ctx->h[3], h4 = ctx->h[4];
+    uint32_t c;
+
+    // Full carry
+    c = h1 >> 26; h1 &= POLY_MASK26;
+    h2 += c; c = h2 >> 26; h2 &= POLY_MASK26;
+    h3 += c; c = h3 >> 26; h3 &= POLY_MASK26;
+    h4 += c; c = h4 >> 26; h4 &= POLY_MASK26;
+    h0 += c * 5; c = h0 >> 26; h0 &= POLY_MASK26;
+    h1 += c;
+
+    // g = h + 5 - 2^130; take g if it did not go negative (no branches)
+    uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= POLY_MASK26;
+    uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= POLY_MASK26;
+    uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= POLY_MASK26;
+    uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= POLY_MASK26;
+    uint32_t g4 = h4 + c - (1UL << 26);
+
+    uint32_t mask = (g4 >> 31) - 1;
+    h0 = (h0 & ~mask) | (g0 & mask);
+    h1 = (h1 & ~mask) | (g1 & mask);
+    h2 = (h2 & ~mask) | (g2 & mask);
+    h3 = (h3 & ~mask) | (g3 & mask);
+    h4 = (h4 & ~mask) | (g4 & mask);
+
+    // h mod 2^128, plus the pad
+    uint32_t w0 = h0 | (h1 << 26);
+    uint32_t w1 = (h1 >> 6) | (h2 << 20);
+    uint32_t w2 = (h2 >> 12) | (h3 << 14);
+    uint32_t w3 = (h3 >> 18) | (h4 << 8);
+
+    uint64_t f;
+    f = (uint64_t)w0 + ctx->pad[0];             store32(&tag[0], (uint32_t)f);
+    f = (uint64_t)w1 + ctx->pad[1] + (f >> 32); store32(&tag[4], (uint32_t)f);
+    f = (uint64_t)w2 + ctx->pad[2] + (f >> 32); store32(&tag[8], (uint32_t)f);
+    f = (uint64_t)w3 + ctx->pad[3] + (f >> 32); store32(&tag[12], (uint32_t)f);
+}
+
+/* AEAD */
+
+/**
+ * @brief Tag over aad and ciphertext; the one-time Poly1305 key is keystream block 0.
+ */
+static void chachapoly_tag(chacha_ctx* chacha, const uint8_t* aad, size_t aad_len,
+                           const uint8_t* data, size_t len, uint8_t tag[CHACHAPOLY_TAG_LENGTH])
+{
+    uint8_t block[CHACHA_BLOCK_LENGTH];
+    poly_ctx poly;
+
+    chacha_block(chacha, block);
+    poly_init(&poly, block);
+
+    poly_padded(&poly, aad, aad_len);
+    poly_padded(&poly, data, len);
+
+    uint8_t lengths[POLY_BLOCK_LENGTH];
+    store32(&lengths[0], (uint32_t)aad_len);
+    store32(&lengths[4], 0);
+    store32(&lengths[8], (uint32_t)len);
+    store32(&lengths[12], 0);
+    poly_blocks(&poly, lengths, 1);
+
+    poly_finish(&poly, tag);
+
+    memset(block, 0, sizeof(block));
+    memset(&poly, 0, sizeof(poly));
+}
+
+extern "C" {
+
+void chachapoly_seal(const uint8_t key[CHACHAPOLY_KEY_LENGTH], const uint8_t nonce[CHACHAPOLY_NONCE_LENGTH],
+                     const uint8_t* aad, size_t aad_len, uint8_t* data, size_t len,
+                     uint8_t tag[CHACHAPOLY_TAG_LENGTH])
+{
+    chacha_ctx chacha;
+
+    // Block 0 keys Poly1305; the data is encrypted from block 1
+    chacha_init(&chacha, key, nonce, 1);
+    chacha_xor(&chacha, data, len);
+
+    chacha_init(&chacha, key, nonce, 0);
+    chachapoly_tag(&chacha, aad, aad_len, data, len, tag);
+
+    memset(&chacha, 0, sizeof(chacha));
+}
+
+bool chachapoly_open(const uint8_t key[CHACHAPOLY_KEY_LENGTH], const uint8_t nonce[CHACHAPOLY_NONCE_LENGTH],
+                     const uint8_t* aad, size_t aad_len, uint8_t* data, size_t len,
+                     const uint8_t* tag, size_t tag_len)
+{
+    chacha_ctx chacha;
+    uint8_t expected[CHACHAPOLY_TAG_LENGTH];
+
+    if (tag_len == 0 || tag_len > CHACHAPOLY_TAG_LENGTH) {
+        return false;
+    }
+
+    // Block 0 and block 1 follow each other: one context for the tag and the data
+    chacha_init(&chacha, key, nonce, 0);
+    chachapoly_tag(&chacha, aad, aad_len, data, len, expected);
+
+    // Constant-time compare: a forgery learns nothing from the timing
+    uint8_t diff = 0;
+    for (size_t i = 0; i < tag_len; i++) {
+        diff |= expected[i] ^ tag[i];
+    }
+
+    if (diff == 0) {
+        chacha_xor(&chacha, data, len);
+    }
+
+    memset(&chacha, 0, sizeof(chacha));
+    memset(expected, 0, sizeof(expected));
+    return diff == 0;
+}
+
+} // extern "C"
@@ -0,0 +1,134 @@
+#include "channel_scanner.h"
+#include "us_timer.h"
+#include <string.h>
+
+ChannelScanner::ChannelScanner()
+{
+    this->reset();
+}
+
+void ChannelScanner::reset(void)
+{
+    memset(this->level_acc, 0, sizeof(this->level_acc));
+    memset(this->levels, 0, sizeof(this->levels));
+    memset(this->peaks, 0, sizeof(this->peaks));
+    this->sweeps = 0;
+    this->sweep_cycles = 0;
+    this->next_channel = 0;
+    this->sweep_start = 0;
+}
+
+bool ChannelScanner::sweep_step(uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (this->next_channel == 0) {
+            this->sweep_start = DWT->CYCCNT;
+        }
+        this->sample(this->next_channel);
+
+        if (++this->next_channel == NRF24L01P_CHANNEL_COUNT)
+        {
+            this->next_channel = 0;
+            this->sweep_cycles = DWT->CYCCNT - this->sweep_start;
+            this->sweeps++;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t ChannelScanner::measure(const uint8_t* channels, uint8_t count, uint32_t budget_us)
+{
+    uint32_t start = DWT->CYCCNT;
+    uint32_t budget = budget_us * (SystemCoreClock / 1000000U);
+
+    // A scan-mode sweep in progress starts over afterwards
+    this->reset();
+    do
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (channels[i] < NRF24L01P_CHANNEL_COUNT) {
+                this->sample(channels[i]);
+            }
+        }
+        this->sweeps++;
+    } while (DWT->CYCCNT - start < budget);
+
+    this->sweep_cycles = DWT->CYCCNT - start;
+    return this->get_quietest_in(channels, count);
+}
+
+void ChannelScanner::sample(uint8_t ch)
+{
+    nrf24l01p_set_rf_channel(ch);
+
+    // RPD is valid only after settling + AGC in RX; CE low resets it
+    nrf24l01p_ce_high();
+    us_timer_sleep(SCAN_DWELL_US);
+    bool busy = nrf24l01p_get_rpd();
+    nrf24l01p_ce_low();
+
+    uint16_t* acc = &this->level_acc[ch];
+    *acc = *acc - (*acc >> SCAN_EWMA_SHIFT) + (busy ? 255 : 0);
+    this->levels[ch] = (uint8_t)(*acc >> SCAN_EWMA_SHIFT);
+
+    // Peak-hold: jumps up with the level, falls slowly
+    uint8_t peak = (this->peaks[ch] > SCAN_PEAK_DECAY) ? this->peaks[ch] - SCAN_PEAK_DECAY : 0;
+    this->peaks[ch] = (this->levels[ch] > peak) ? this->levels[ch] : peak;
+}
+
+const uint8_t* ChannelScanner::get_levels(void) const
+{
+    return this->levels;
+}
+
+const uint8_t* ChannelScanner::get_peaks(void) const
+{
+    return this->peaks;
+}
+
+uint8_t ChannelScanner::get_quietest(uint8_t first, uint8_t last) const
+{
+    if (last >= NRF24L01P_CHANNEL_COUNT) {
+        last = NRF24L01P_CHANNEL_COUNT - 1;
+    }
+
+    uint8_t best = first;
+    for (uint8_t ch = first; ch <= last; ch++)
+    {
+        if (this->quieter(ch, best)) {
+            best = ch;
+        }
+    }
+    return best;
+}
+
+uint8_t ChannelScanner::get_quietest_in(const uint8_t* channels, uint8_t count) const
+{
+    uint8_t best = channels[0];
+    for (uint8_t i = 1; i < count; i++)
+    {
+        if (channels[i] < NRF24L01P_CHANNEL_COUNT && this->quieter(channels[i], best)) {
+            best = channels[i];
+        }
+    }
+    return best;
+}
+
+bool ChannelScanner::quieter(uint8_t a, uint8_t b) const
+{
+    return this->peaks[a] < this->peaks[b] ||
+           (this->peaks[a] == this->peaks[b] && this->levels[a] < this->levels[b]);
+}
+
+uint32_t ChannelScanner::get_sweeps(void) const
+{
+    return this->sweeps;
+}
+
+uint32_t ChannelScanner::get_sweep_cycles(void) const
+{
+    return this->sweep_cycles;
+}
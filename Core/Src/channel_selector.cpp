@@ -0,0 +1,89 @@
+#include "channel_selector.h"
+#include <string.h>
+
+ChannelSelector::ChannelSelector()
+{
+    this->requested = false;
+    this->state = CHANNEL_FIXED;
+    this->announce_packets = 0;
+    this->since = 0;
+    memset(&this->stats, 0, sizeof(this->stats));
+}
+
+void ChannelSelector::request(void)
+{
+    this->requested = true;
+}
+
+void ChannelSelector::on_selected(uint8_t channel, uint32_t scan_us, uint8_t announce_packets, TickType_t now)
+{
+    this->requested = false;
+    this->stats.selections++;
+    this->stats.last_scan_us = scan_us;
+    if (scan_us > this->stats.max_scan_us) {
+        this->stats.max_scan_us = scan_us;
+    }
+    this->stats.channel = channel;
+
+    this->announce_packets = announce_packets;
+    this->state = CHANNEL_RENDEZVOUS;
+    this->since = now;
+}
+
+void ChannelSelector::on_rendezvous_packet(void)
+{
+    if (this->announce_packets > 0) {
+        this->announce_packets--;
+    }
+}
+
+ChannelSelector::Action ChannelSelector::update(TickType_t now, bool degraded)
+{
+    if (this->requested) {
+        return CHANNEL_SELECT;
+    }
+
+    if (this->state == CHANNEL_RENDEZVOUS)
+    {
+        bool announced = (this->announce_packets == 0);
+
+        if (!announced && now - this->since < pdMS_TO_TICKS(CHANNEL_RENDEZVOUS_MS)) {
+            return CHANNEL_STAY;
+        }
+
+        // No transmitter took it in time: go anyway. One that missed it keeps the
+        // rendezvous channel and is met there on the next selection
+        if (announced) {
+            this->stats.announced++;
+        } else {
+            this->stats.rendezvous_timeouts++;
+        }
+        this->announce_packets = 0;
+        this->state = CHANNEL_SELECTED;
+        this->since = now;
+        return CHANNEL_MOVE;
+    }
+
+    if (this->state == CHANNEL_SELECTED &&
+        now - this->since >= pdMS_TO_TICKS(CHANNEL_RESELECT_MIN_MS) && degraded)
+    {
+        this->stats.reselections++;
+        return CHANNEL_SELECT;
+    }
+    return CHANNEL_STAY;
+}
+
+ChannelSelector::State ChannelSelector::get_state(void) const
+{
+    return this->state;
+}
+
+uint8_t ChannelSelector::get_channel(uint8_t fixed_channel) const
+{
+    return (this->state == CHANNEL_SELECTED) ? this->stats.channel : fixed_channel;
+}
+
+const ChannelSelector::Stats& ChannelSelector::get_stats(void) const
+{
+    return this->stats;
+}
@@ -52,6 +52,16 @@ MyDisplay::MyDisplay(I2C_HandleTypeDef *hi2c)
     this->hi2c = hi2c;
     this->main_text[0] = '\0';      // '\0' means no key is active
     this->needs_update = true;  // Force a screen update on the first run
+    this->signal_level = 0;
+    this->mode = MODE_TEXT;
+    memset(this->spectrum_levels, 0, sizeof(this->spectrum_levels));
+    memset(this->spectrum_peaks, 0, sizeof(this->spectrum_peaks));
+    this->shown_packet = NRF24L01P_PACKET_NONE;
+    this->shown_text = this->main_text;
+    this->text_pending = false;
+    this->text_mark = 0;
+    this->posted_packets = 0;
+    this->taken_packets = 0;
     // Initialize the status text buffer
     strncpy(this->status_text, "Press a key", sizeof(this->status_text) - 1);
 }
@@ -72,8 +82,80 @@ void MyDisplay::set_main_text(const char* text)
     strncpy(this->main_text, text, sizeof(this->main_text) - 1);
     this->main_text[sizeof(this->main_text) - 1] = '\0'; // Гарантуємо нуль-термінатор
 
+    this->text_mark = this->posted_packets; // Пакети, поставлені раніше, старші за текст
+    this->text_pending = true; // DisplayTask перемикається з пакета на main_text
     this->needs_update = true; // Потрібно оновити екран
 }
+void MyDisplay::set_main_text(const char* text, size_t len)
+{
+    if (len > sizeof(this->main_text) - 1) {
+        len = sizeof(this->main_text) - 1;
+    }
+    memcpy(this->main_text, text, len);
+    this->main_text[len] = '\0';
+
+    this->text_mark = this->posted_packets; // Пакети, поставлені раніше, старші за текст
+    this->text_pending = true; // DisplayTask перемикається з пакета на main_text
+    this->needs_update = true; // Потрібно оновити екран
+}
+
+bool MyDisplay::post_packet(nrf24l01p_packet_handle handle)
+{
+    if (!this->rx_queue.push(handle)) {
+        return false;
+    }
+    this->posted_packets++;
+    return true;
+}
+
+uint32_t MyDisplay::get_rx_overflows(void) const
+{
+    return this->rx_queue.overflow_count();
+}
+
+void MyDisplay::consume_packets(void)
+{
+    nrf24l01p_packet_handle handle;
+
+    // Пакети, що стояли в черзі до set_main_text(), старші за текст: спершу забираємо їх,
+    // тоді показуємо текст; новіші пакети знову його перекривають
+    while (true)
+    {
+        if (this->text_pending && this->taken_packets == this->text_mark)
+        {
+            this->text_pending = false;
+            this->release_shown_packet();
+            this->needs_update = true;
+        }
+
+        // Старіші пакети все одно перекриваються новішими: їхні слоти одразу звільняємо
+        if (!this->rx_queue.pop(handle)) {
+            break;
+        }
+        this->taken_packets++;
+
+        nrf24l01p_rx_packet* packet = nrf24l01p_rx_packet_get(handle);
+
+        this->release_shown_packet();
+        this->shown_packet = handle;
+
+        // Слот тепер наш: термінатор пишемо прямо в нього (payload має +1 байт) і малюємо без копії
+        packet->payload[packet->len] = '\0';
+        this->shown_text = (const char*)packet->payload;
+        this->needs_update = true;
+    }
+}
+
+void MyDisplay::release_shown_packet(void)
+{
+    if (this->shown_packet != NRF24L01P_PACKET_NONE)
+    {
+        nrf24l01p_rx_packet_free(this->shown_packet);
+        this->shown_packet = NRF24L01P_PACKET_NONE;
+    }
+    this->shown_text = this->main_text;
+}
+
 /**
  * @brief Public API to set the top-left status bar text.
  */
@@ -86,6 +168,85 @@ void MyDisplay::set_status_text(const char* text)
     this->needs_update = true; // Trigger a screen redraw
 }
 
+void MyDisplay::set_signal_level(uint8_t bars)
+{
+    if (bars > SIGNAL_BARS) {
+        bars = SIGNAL_BARS;
+    }
+    this->signal_level = bars;
+
+    this->needs_update = true; // Trigger a screen redraw
+}
+
+void MyDisplay::set_mode(Mode mode)
+{
+    this->mode = mode;
+
+    this->needs_update = true; // Trigger a screen redraw
+}
+
+void MyDisplay::set_spectrum(const uint8_t* levels, const uint8_t* peaks)
+{
+    memcpy(this->spectrum_levels, levels, sizeof(this->spectrum_levels));
+    memcpy(this->spectrum_peaks, peaks, sizeof(this->spectrum_peaks));
+
+    this->needs_update = true; // Trigger a screen redraw
+}
+
+void MyDisplay::draw_spectrum(void)
+{
+    // Головна зона: y = 16..63, один стовпчик на канал (126 із 128 px)
+    const uint8_t top = 16;
+    const uint8_t bottom = SSD1306_HEIGHT - 1;
+    const uint8_t range = bottom - top;
+    const uint8_t x0 = (SSD1306_WIDTH - NRF24L01P_CHANNEL_COUNT) / 2;
+
+    for (uint8_t ch = 0; ch < NRF24L01P_CHANNEL_COUNT; ch++)
+    {
+        uint8_t x = x0 + ch;
+        uint8_t height = (uint8_t)((this->spectrum_levels[ch] * range) / 255);
+        uint8_t peak = (uint8_t)((this->spectrum_peaks[ch] * range) / 255);
+
+        for (uint8_t dy = 0; dy < height; dy++)
+        {
+            ssd1306_DrawPixel(x, bottom - dy, White);
+        }
+
+        // Peak-hold: one dot above the bar
+        if (peak > height) {
+            ssd1306_DrawPixel(x, bottom - peak, White);
+        }
+    }
+
+    // Baseline
+    for (uint8_t x = 0; x < SSD1306_WIDTH; x++)
+    {
+        ssd1306_DrawPixel(x, bottom, White);
+    }
+}
+
+void MyDisplay::draw_signal_bars(void)
+{
+    // 4 стовпчики 3x2..3x8 px у правому верхньому куті; неактивні - лише основа
+    const uint8_t bar_width = 3;
+    const uint8_t x0 = SSD1306_WIDTH - SIGNAL_BARS * (bar_width + 1);
+    const uint8_t bottom = 7;
+
+    for (uint8_t bar = 0; bar < SIGNAL_BARS; bar++)
+    {
+        uint8_t height = (bar < this->signal_level) ? 2 * (bar + 1) : 1;
+        uint8_t x = x0 + bar * (bar_width + 1);
+
+        for (uint8_t dx = 0; dx < bar_width; dx++)
+        {
+            for (uint8_t dy = 0; dy < height; dy++)
+            {
+                ssd1306_DrawPixel(x + dx, bottom - dy, White);
+            }
+        }
+    }
+}
+
 /**
  * @brief Private method to render the buffer and send it to the display via DMA.
  */
@@ -104,18 +265,21 @@ void MyDisplay::update_screen(void)
 
     ssd1306_WriteString(this->status_text, &Font_6x8, White);
 
-    // (We will reserve the top-right corner for radio icons later)
-    // ssd1306_SetCursor(112, 0);
-    // ssd1306_WriteString("[SND]", &Font_6x8, White);
+    // Top-right corner: signal indicator from the link-quality estimate
+    this->draw_signal_bars();
 
 
     // --- Zone 2: Main Area (Bottom 48 pixels) ---
 
-    if (this->main_text[0] != '\0') {
+    if (this->mode == MODE_SPECTRUM) {
+
+        this->draw_spectrum();
+
+    } else if (this->shown_text[0] != '\0') {
 
         ssd1306_SetCursor(2, 31);
 
-        ssd1306_WriteString_Large(this->main_text, &Font_11x18, White);
+        ssd1306_WriteString_Large(this->shown_text, &Font_11x18, White);
     }
 
     // 4. Start the non-blocking DMA transfer
@@ -144,6 +308,9 @@ void MyDisplay::task(void)
     // Main task loop
     while (1)
     {
+        // Packets queued by RadioTask since the last pass
+        this->consume_packets();
+
         // We no longer read the keypad here.
         // We only check if the keypad task has "told" us to redraw.
         if (this->needs_update)
@@ -0,0 +1,189 @@
+#include "fec.h"
+#include <string.h>
+
+#define FEC_CODEWORDS           (2 * FEC_BLOCK_LENGTH)
+#define FEC_GROUPS              (FEC_CODEWORDS / 8)
+
+// Decode table entry: data nibble in bits 0-3
+#define FEC_FLAG_CORRECTED      0x10
+#define FEC_FLAG_UNCORRECTABLE  0x20
+
+static_assert(FEC_CODEWORDS == 8 * FEC_GROUPS && FEC_GROUPS * 8 == FEC_CODED_LENGTH,
+              "Interleaver expects 32 codewords of 8 bits");
+
+/**
+ * @brief Hamming(8,4) SECDED tables, built at compile time.
+ * @note Codeword bit n-1 is Hamming position n (1..7): p1 p2 d0 p4 d1 d2 d3;
+ *       bit 7 is the overall parity.
+ */
+struct HammingTables
+{
+    uint8_t encode[16];
+    uint8_t decode[256];
+
+    static constexpr uint8_t bit(uint8_t v, uint8_t n)
+    {
+        return (v >> n) & 1;
+    }
+
+    static constexpr uint8_t parity(uint8_t v)
+    {
+        v ^= v >> 4;
+        v ^= v >> 2;
+        v ^= v >> 1;
+        return v & 1;
+    }
+
+    static constexpr uint8_t codeword(uint8_t nibble)
+    {
+        uint8_t d0 = bit(nibble, 0), d1 = bit(nibble, 1), d2 = bit(nibble, 2), d3 = bit(nibble, 3);
+        uint8_t cw = (uint8_t)((d0 ^ d1 ^ d3) | ((d0 ^ d2 ^ d3) << 1) | (d0 << 2) |
+                               ((d1 ^ d2 ^ d3) << 3) | (d1 << 4) | (d2 << 5) | (d3 << 6));
+        return (uint8_t)(cw | (parity(cw) << 7));
+    }
+
+    static constexpr uint8_t data(uint8_t cw)
+    {
+        return (uint8_t)(bit(cw, 2) | (bit(cw, 4) << 1) | (bit(cw, 5) << 2) | (bit(cw, 6) << 3));
+    }
+
+    constexpr HammingTables() : encode(), decode()
+    {
+        for (uint8_t n = 0; n < 16; n++) {
+            encode[n] = codeword(n);
+        }
+
+        for (uint16_t cw = 0; cw < 256; cw++)
+        {
+            // Syndrome = XOR of the positions of the set bits (0 for a valid codeword)
+            uint8_t syndrome = 0;
+            for (uint8_t pos = 1; pos <= 7; pos++)
+            {
+                if (bit((uint8_t)cw, pos - 1)) {
+                    syndrome ^= pos;
+                }
+            }
+
+            if (parity((uint8_t)cw) == 0) {
+                decode[cw] = (syndrome == 0) ? data((uint8_t)cw) : FEC_FLAG_UNCORRECTABLE;
+            } else if (syndrome == 0) {
+                decode[cw] = data((uint8_t)cw) | FEC_FLAG_CORRECTED;   // The parity bit itself
+            } else {
+                decode[cw] = data((uint8_t)(cw ^ (1 << (syndrome - 1)))) | FEC_FLAG_CORRECTED;
+            }
+        }
+    }
+};
+
+static constexpr HammingTables HAMMING = HammingTables();
+
+static_assert(HAMMING.decode[HAMMING.encode[0xA]] == 0xA, "Hamming tables do not round-trip");
+static_assert(HAMMING.decode[HAMMING.encode[0x5] ^ 0x40] == (0x5 | FEC_FLAG_CORRECTED), "Single-bit error not corrected");
+
+/**
+ * @brief 8x8 bit-matrix transpose (Hacker's Delight 7-3): row i of a (stride m)
+ *        becomes column i of b (stride n). Its own inverse, so it both interleaves
+ *        and deinterleaves.
+ */
+static void transpose8(const uint8_t* a, uint8_t m, uint8_t* b, uint8_t n)
+{
+    uint32_t x = ((uint32_t)a[0] << 24) | ((uint32_t)a[m] << 16) | ((uint32_t)a[2 * m] << 8) | a[3 * m];
+    uint32_t y = ((uint32_t)a[4 * m] << 24) | ((uint32_t)a[5 * m] << 16) | ((uint32_t)a[6 * m] << 8) | a[7 * m];
+    uint32_t t;
+
+    t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+
+    t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+    y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+    x = t;
+
+    b[0] = (uint8_t)(x >> 24);     b[n] = (uint8_t)(x >> 16);
+    b[2 * n] = (uint8_t)(x >> 8);  b[3 * n] = (uint8_t)x;
+    b[4 * n] = (uint8_t)(y >> 24); b[5 * n] = (uint8_t)(y >> 16);
+    b[6 * n] = (uint8_t)(y >> 8);  b[7 * n] = (uint8_t)y;
+}
+
+extern "C" {
+
+uint16_t fec_crc16(const uint8_t* data, length len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (length i = 0; i < len; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+void fec_encode(const uint8_t* data, length len, uint8_t coded[FEC_CODED_LENGTH])
+{
+    uint8_t block[FEC_BLOCK_LENGTH] = {0};
+    uint8_t cw[FEC_CODEWORDS];
+
+    if (len > FEC_DATA_LENGTH) {
+        len = FEC_DATA_LENGTH;
+    }
+    block[0] = len;
+    memcpy(&block[1], data, len);
+
+    uint16_t crc = fec_crc16(block, FEC_BLOCK_LENGTH - 2);
+    block[FEC_BLOCK_LENGTH - 2] = (uint8_t)(crc >> 8);
+    block[FEC_BLOCK_LENGTH - 1] = (uint8_t)crc;
+
+    for (uint8_t i = 0; i < FEC_BLOCK_LENGTH; i++)
+    {
+        cw[2 * i] = HAMMING.encode[block[i] & 0x0F];
+        cw[2 * i + 1] = HAMMING.encode[block[i] >> 4];
+    }
+
+    for (uint8_t g = 0; g < FEC_GROUPS; g++) {
+        transpose8(&cw[8 * g], 1, &coded[g], FEC_GROUPS);
+    }
+}
+
+fec_result fec_decode(uint8_t buf[FEC_CODED_LENGTH], length* len, uint8_t* corrected)
+{
+    uint8_t cw[FEC_CODEWORDS];
+    uint8_t block[FEC_BLOCK_LENGTH];
+    uint8_t flags = 0;
+    uint8_t fixed = 0;
+
+    for (uint8_t g = 0; g < FEC_GROUPS; g++) {
+        transpose8(&buf[g], FEC_GROUPS, &cw[8 * g], 1);
+    }
+
+    for (uint8_t i = 0; i < FEC_BLOCK_LENGTH; i++)
+    {
+        uint8_t lo = HAMMING.decode[cw[2 * i]];
+        uint8_t hi = HAMMING.decode[cw[2 * i + 1]];
+
+        flags |= lo | hi;
+        fixed += ((lo & FEC_FLAG_CORRECTED) ? 1 : 0) + ((hi & FEC_FLAG_CORRECTED) ? 1 : 0);
+        block[i] = (uint8_t)((lo & 0x0F) | ((hi & 0x0F) << 4));
+    }
+
+    if (corrected != NULL) {
+        *corrected = fixed;
+    }
+    if (flags & FEC_FLAG_UNCORRECTABLE) {
+        return FEC_UNCORRECTABLE;
+    }
+
+    uint16_t crc = ((uint16_t)block[FEC_BLOCK_LENGTH - 2] << 8) | block[FEC_BLOCK_LENGTH - 1];
+    if (block[0] > FEC_DATA_LENGTH || fec_crc16(block, FEC_BLOCK_LENGTH - 2) != crc) {
+        return FEC_CRC_ERROR;
+    }
+
+    *len = block[0];
+    memcpy(buf, &block[1], block[0]);
+    return FEC_OK;
+}
+
+} // extern "C"
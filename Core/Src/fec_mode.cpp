@@ -0,0 +1,81 @@
+#include "fec_mode.h"
+#include <string.h>
+
+FecMode::FecMode()
+{
+    this->requested = false;
+    this->enabled = false;
+    memset(&this->stats, 0, sizeof(this->stats));
+}
+
+void FecMode::request(bool enable)
+{
+    this->requested = enable;
+}
+
+bool FecMode::needs_switch(void) const
+{
+    return this->requested != this->enabled;
+}
+
+void FecMode::set_enabled(bool enable)
+{
+    this->enabled = enable;
+}
+
+bool FecMode::is_enabled(void) const
+{
+    return this->enabled;
+}
+
+void FecMode::configure_pipe(nrf24l01p_pipe_config* config) const
+{
+    if (this->enabled)
+    {
+        // Без CRC немає автопідтвердження; довжина коду фіксована
+        config->auto_ack = false;
+        config->dynamic_payload = false;
+        config->payload_width = FEC_CODED_LENGTH;
+    }
+}
+
+uint8_t FecMode::crc_bytes(uint8_t profile_crc_bytes) const
+{
+    return this->enabled ? 0 : profile_crc_bytes;
+}
+
+bool FecMode::decode(nrf24l01p_rx_packet* packet)
+{
+    if (!this->enabled) {
+        return true;
+    }
+
+    uint8_t corrected = 0;
+    fec_result result = (packet->len == FEC_CODED_LENGTH)
+                      ? fec_decode(packet->payload, &packet->len, &corrected)
+                      : FEC_CRC_ERROR;
+
+    switch (result)
+    {
+        case FEC_OK:
+            this->stats.decoded++;
+            if (corrected > 0)
+            {
+                this->stats.corrected_packets++;
+                this->stats.corrected_bits += corrected;
+            }
+            return true;
+        case FEC_UNCORRECTABLE:
+            this->stats.uncorrectable++;
+            return false;
+        case FEC_CRC_ERROR:
+        default:
+            this->stats.crc_errors++;
+            return false;
+    }
+}
+
+const FecMode::Stats& FecMode::get_stats(void) const
+{
+    return this->stats;
+}
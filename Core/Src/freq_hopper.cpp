@@ -0,0 +1,261 @@
+#include "freq_hopper.h"
+#include "frame.h"
+#include <string.h>
+
+#define HOP_CHANNEL_SPAN        (HOP_LAST_CHANNEL - HOP_FIRST_CHANNEL + 1)
+#define HOP_NO_CHANNEL          0xFF
+
+static_assert(HOP_SEQUENCE_LENGTH <= HOP_CHANNEL_SPAN, "Hop sequence longer than the channel range");
+static_assert(HOP_SYNC_LOSS_HOPS < HOP_PREDICTION_HOPS, "Sync loss must come before the prediction expires");
+
+static uint32_t hop_xorshift32(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+FreqHopper::FreqHopper()
+{
+    memset(this->sequence, HOP_FIRST_CHANNEL, sizeof(this->sequence));
+    memset(&this->stats, 0, sizeof(this->stats));
+    this->requested = false;
+    this->requested_pipe = 0;
+    this->active = false;
+    this->beacon_pipe = 0;
+    this->ticks_per_us = 1;
+    this->dwell_ticks = HOP_DWELL_US;
+    this->state = HOP_ACQUIRE;
+    this->predicting = false;
+    this->index = 0;
+    this->hop_start = 0;
+    this->hops_since_beacon = 0;
+    this->parked = 0;
+    this->phase_start = 0;
+    this->phase_length = 0;
+    this->tuned = HOP_NO_CHANNEL;
+}
+
+void FreqHopper::request(bool enable, uint8_t beacon_pipe)
+{
+    this->requested_pipe = beacon_pipe;
+    this->requested = enable;
+}
+
+bool FreqHopper::needs_switch(void) const
+{
+    return this->requested != this->active;
+}
+
+bool FreqHopper::is_requested(void) const
+{
+    return this->requested;
+}
+
+uint8_t FreqHopper::get_requested_pipe(void) const
+{
+    return this->requested_pipe;
+}
+
+void FreqHopper::start(uint8_t beacon_pipe, const uint8_t* address, uint8_t width, uint32_t ticks_per_us, uint32_t now)
+{
+    // FNV-1a over the address: the transmitter derives the same sequence
+    uint32_t seed = 2166136261UL;
+    for (uint8_t i = 0; i < width; i++)
+    {
+        seed ^= address[i];
+        seed *= 16777619UL;
+    }
+    if (seed == 0) {
+        seed = 1;
+    }
+
+    uint8_t channels[HOP_CHANNEL_SPAN];
+    for (uint8_t i = 0; i < HOP_CHANNEL_SPAN; i++) {
+        channels[i] = HOP_FIRST_CHANNEL + i;
+    }
+
+    // Fisher-Yates from the front; only the first HOP_SEQUENCE_LENGTH places are needed
+    for (uint8_t i = 0; i < HOP_SEQUENCE_LENGTH; i++)
+    {
+        uint8_t j = i + (uint8_t)(hop_xorshift32(&seed) % (HOP_CHANNEL_SPAN - i));
+        uint8_t swap = channels[i];
+        channels[i] = channels[j];
+        channels[j] = swap;
+        this->sequence[i] = channels[i];
+    }
+
+    memset(&this->stats, 0, sizeof(this->stats));
+    this->ticks_per_us = ticks_per_us;
+    this->dwell_ticks = HOP_DWELL_US * ticks_per_us;
+    this->tuned = HOP_NO_CHANNEL;
+    this->predicting = false;
+    this->enter_acquire(0, now);
+    this->beacon_pipe = beacon_pipe;
+    this->active = true;
+}
+
+void FreqHopper::stop(void)
+{
+    this->active = false;
+}
+
+bool FreqHopper::is_active(void) const
+{
+    return this->active;
+}
+
+bool FreqHopper::is_beacon(uint8_t pipe, const uint8_t* payload, uint8_t len) const
+{
+    return this->active && pipe == this->beacon_pipe && len == HOP_BEACON_LENGTH &&
+           payload[1] == FRAME_TYPE_BEACON;
+}
+
+void FreqHopper::take_beacon(const uint8_t* payload, uint32_t air_us, uint32_t arrival)
+{
+    uint32_t elapsed_us = payload[3] | ((uint32_t)payload[4] << 8);
+    this->on_beacon(payload[2], elapsed_us + air_us, arrival);
+}
+
+void FreqHopper::on_beacon(uint8_t index, uint32_t elapsed_us, uint32_t arrival)
+{
+    if (index >= HOP_SEQUENCE_LENGTH) {
+        return;
+    }
+
+    uint32_t start = arrival - elapsed_us * this->ticks_per_us;
+    this->stats.beacons++;
+
+    if (this->predicting && index == this->index)
+    {
+        // Drift of our clock against the transmitter's since the last beacon
+        this->stats.last_error_us = (int32_t)(start - this->hop_start) / (int32_t)this->ticks_per_us;
+    }
+
+    if (this->state != HOP_SYNCED)
+    {
+        this->stats.acquisitions++;
+        if (this->state == HOP_REACQUIRE) {
+            this->stats.reacquisitions++;
+        }
+    }
+
+    this->state = HOP_SYNCED;
+    this->predicting = true;
+    this->index = index;
+    this->hop_start = start;
+    this->hops_since_beacon = 0;
+}
+
+bool FreqHopper::update(uint32_t now)
+{
+    // Far behind (clock jumped, task starved): restart the windows from now
+    if ((int32_t)(now - this->hop_start) < 0 || now - this->hop_start > 0x40000000UL) {
+        this->hop_start = now;
+    }
+    if ((int32_t)(now - this->phase_start) < 0 || now - this->phase_start > 0x40000000UL) {
+        this->phase_start = now;
+    }
+
+    // The transmitter's schedule as of the last beacon, coasting on our clock
+    while (this->predicting && now - this->hop_start >= this->dwell_ticks)
+    {
+        this->index = (this->index + 1) % HOP_SEQUENCE_LENGTH;
+        this->hop_start += this->dwell_ticks;
+        this->hops_since_beacon++;
+
+        if (this->state == HOP_SYNCED)
+        {
+            this->stats.hops++;
+            if (this->hops_since_beacon >= HOP_SYNC_LOSS_HOPS)
+            {
+                // Park where the transmitter should be now; it comes back within one cycle
+                this->stats.sync_losses++;
+                this->enter_acquire(this->index, this->hop_start);
+            }
+        }
+        if (this->hops_since_beacon >= HOP_PREDICTION_HOPS)
+        {
+            // Drift may have eaten the beacon's margin: only parking is left
+            this->predicting = false;
+            if (this->state == HOP_REACQUIRE) {
+                this->enter_acquire(this->index, this->hop_start);
+            }
+        }
+    }
+
+    while (this->state != HOP_SYNCED && now - this->phase_start >= this->phase_length)
+    {
+        uint32_t next_start = this->phase_start + this->phase_length;
+
+        if (this->state == HOP_ACQUIRE && this->predicting)
+        {
+            // A faded transmitter is still on the predicted schedule: follow it for a cycle
+            this->state = HOP_REACQUIRE;
+            this->phase_start = next_start;
+            this->phase_length = HOP_SEQUENCE_LENGTH * this->dwell_ticks;
+            continue;
+        }
+
+        // Nothing heard on this channel for a whole cycle: it may be jammed, try the next
+        this->enter_acquire((this->parked + 1) % HOP_SEQUENCE_LENGTH, next_start);
+    }
+
+    uint8_t channel = this->get_channel();
+    if (channel == this->tuned) {
+        return false;
+    }
+    this->tuned = channel;
+    return true;
+}
+
+uint32_t FreqHopper::ticks_to_next(uint32_t now) const
+{
+    uint32_t next = UINT32_MAX;
+
+    if (this->state != HOP_ACQUIRE)
+    {
+        uint32_t elapsed = now - this->hop_start;
+        next = (elapsed >= this->dwell_ticks) ? 0 : this->dwell_ticks - elapsed;
+    }
+    if (this->state != HOP_SYNCED)
+    {
+        uint32_t elapsed = now - this->phase_start;
+        uint32_t left = (elapsed >= this->phase_length) ? 0 : this->phase_length - elapsed;
+        next = (left < next) ? left : next;
+    }
+    return next;
+}
+
+uint8_t FreqHopper::get_channel(void) const
+{
+    return this->sequence[(this->state == HOP_ACQUIRE) ? this->parked : this->index];
+}
+
+uint8_t FreqHopper::channel_at(uint8_t index) const
+{
+    return this->sequence[index % HOP_SEQUENCE_LENGTH];
+}
+
+FreqHopper::State FreqHopper::get_state(void) const
+{
+    return this->state;
+}
+
+const FreqHopper::Stats& FreqHopper::get_stats(void) const
+{
+    return this->stats;
+}
+
+void FreqHopper::enter_acquire(uint8_t index, uint32_t now)
+{
+    this->state = HOP_ACQUIRE;
+    this->parked = index;
+    this->phase_start = now;
+
+    // One full cycle plus a hop: the transmitter visits this channel at least once, whole
+    this->phase_length = (HOP_SEQUENCE_LENGTH + 1) * this->dwell_ticks;
+}
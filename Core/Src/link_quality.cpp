@@ -0,0 +1,234 @@
+#include "link_quality.h"
+#include <string.h>
+
+// Losses fed into the delivery EWMA per gap; after this many the score is ~0 anyway
+#define LINK_MAX_LOSS_SAMPLES   32
+
+static_assert(LINK_SEQ_WINDOW <= 64, "The bitmap is one uint64_t");
+
+LinkQuality::LinkQuality()
+{
+    memset(this->pipes, 0, sizeof(this->pipes));
+    for (uint8_t i = 0; i < NRF24L01P_PIPE_COUNT; i++)
+    {
+        this->pipes[i].stale = true;
+    }
+}
+
+void LinkQuality::set_sequenced(uint8_t pipe, bool sequenced)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+    this->pipes[pipe].sequenced = sequenced;
+    this->pipes[pipe].seq_valid = false;
+    this->pipes[pipe].old_duplicates = 0;
+}
+
+LinkQuality::Verdict LinkQuality::record(const nrf24l01p_rx_packet* packet)
+{
+    return this->record(packet, packet->len > 0, packet->payload[0]);
+}
+
+LinkQuality::Verdict LinkQuality::record(const nrf24l01p_rx_packet* packet, uint8_t seq)
+{
+    return this->record(packet, true, seq);
+}
+
+LinkQuality::Verdict LinkQuality::record(const nrf24l01p_rx_packet* packet, bool has_seq, uint8_t seq)
+{
+    if (packet->pipe >= NRF24L01P_PIPE_COUNT) {
+        return LINK_NEW;
+    }
+
+    PipeState* state = &this->pipes[packet->pipe];
+    Stats* stats = &state->stats;
+    Verdict verdict = LINK_NEW;
+
+    TickType_t silence = packet->timestamp - stats->last_tick;
+
+    stats->received++;
+    stats->last_tick = packet->timestamp;
+    state->stale = false;
+
+    if (packet->rpd) {
+        stats->rpd_hits++;
+    }
+    ewma(&state->rpd_acc, packet->rpd ? 255 : 0);
+
+    if (state->sequenced && has_seq)
+    {
+        int8_t diff = (int8_t)(seq - state->last_seq);
+        uint8_t age = (uint8_t)(-diff);
+        bool restart = !state->seq_valid;
+
+        // Older than the bitmap, or older after a silence no retransmission or
+        // reordering lasts: the sender started its counter over
+        if (diff < 0 && (age >= LINK_SEQ_WINDOW || silence >= pdMS_TO_TICKS(LINK_RESTART_GAP_MS))) {
+            restart = true;
+        }
+
+        if (!restart && diff <= 0 && (state->seen & ((uint64_t)1 << age)))
+        {
+            // Counting up through old numbers is a restarted sender, not
+            // retransmissions: the last of the run starts the new count
+            if (diff == 0) {
+                state->old_duplicates = 0;
+            } else if (state->old_duplicates > 0 && seq == (uint8_t)(state->old_seq + 1)) {
+                state->old_duplicates++;
+            } else {
+                state->old_duplicates = 1;
+            }
+            state->old_seq = seq;
+
+            if (state->old_duplicates < LINK_RESYNC_DUPLICATES) {
+                verdict = LINK_DUPLICATE;
+            } else {
+                restart = true;
+            }
+        }
+
+        if (verdict == LINK_DUPLICATE)
+        {
+            stats->duplicates++;
+            ewma(&state->duplicate_acc, 255);
+        }
+        else if (restart)
+        {
+            // First packet, or the sender restarted its counter: this packet is new.
+            // Delivery starts at full scale, nothing was lost yet
+            if (state->seq_valid) {
+                stats->resyncs++;
+            } else {
+                state->delivery_acc = 255 << LINK_EWMA_SHIFT;
+            }
+            state->seq_valid = true;
+            state->last_seq = seq;
+            state->seen = 1;
+            state->old_duplicates = 0;
+            ewma(&state->delivery_acc, 255);
+            ewma(&state->duplicate_acc, 0);
+        }
+        else if (diff < 0)
+        {
+            // Its bit is clear: counted as lost when the gap was seen, it made it after all
+            stats->reordered++;
+            if (stats->lost > 0) {
+                stats->lost--;
+            }
+            state->seen |= (uint64_t)1 << age;
+            state->old_duplicates = 0;
+            ewma(&state->delivery_acc, 255);
+            ewma(&state->duplicate_acc, 0);
+            verdict = LINK_LATE;
+        }
+        else
+        {
+            uint8_t missing = (uint8_t)(diff - 1);
+
+            stats->lost += missing;
+            for (uint8_t i = 0; i < missing && i < LINK_MAX_LOSS_SAMPLES; i++) {
+                ewma(&state->delivery_acc, 0);
+            }
+            ewma(&state->delivery_acc, 255);
+            ewma(&state->duplicate_acc, 0);
+            state->seen = (diff < LINK_SEQ_WINDOW) ? (state->seen << diff) | 1 : 1;
+            state->last_seq = seq;
+            state->old_duplicates = 0;
+        }
+    }
+
+    this->update_score(state);
+    return verdict;
+}
+
+void LinkQuality::age(TickType_t now)
+{
+    for (uint8_t i = 0; i < NRF24L01P_PIPE_COUNT; i++)
+    {
+        PipeState* state = &this->pipes[i];
+
+        if (!state->stale && now - state->stats.last_tick >= pdMS_TO_TICKS(LINK_STALE_MS))
+        {
+            state->stale = true;
+            this->update_score(state);
+        }
+    }
+}
+
+const LinkQuality::Stats& LinkQuality::get_stats(uint8_t pipe) const
+{
+    return this->pipes[pipe < NRF24L01P_PIPE_COUNT ? pipe : 0].stats;
+}
+
+uint8_t LinkQuality::get_score(void) const
+{
+    uint8_t best = 0;
+
+    for (uint8_t i = 0; i < NRF24L01P_PIPE_COUNT; i++)
+    {
+        if (this->pipes[i].stats.score > best) {
+            best = this->pipes[i].stats.score;
+        }
+    }
+    return best;
+}
+
+uint8_t LinkQuality::get_bars(void) const
+{
+    bool live = false;
+
+    for (uint8_t i = 0; i < NRF24L01P_PIPE_COUNT; i++)
+    {
+        live |= !this->pipes[i].stale;
+    }
+
+    // A live link shows at least one bar, even below the RPD threshold
+    if (!live) {
+        return 0;
+    }
+    return 1 + (uint8_t)((this->get_score() * 3) / 255);
+}
+
+bool LinkQuality::is_degraded(uint8_t min_delivery) const
+{
+    for (uint8_t i = 0; i < NRF24L01P_PIPE_COUNT; i++)
+    {
+        const PipeState* state = &this->pipes[i];
+
+        if (state->stale) {
+            continue;
+        }
+
+        // RPD alone does not say packets are lost: only sequenced pipes count
+        if (state->sequenced && state->seq_valid && state->stats.delivery_score < min_delivery) {
+            return true;
+        }
+    }
+
+    // A silent transmitter is idle, not a poor channel
+    return false;
+}
+
+void LinkQuality::ewma(uint16_t* acc, uint8_t sample)
+{
+    *acc = *acc - (*acc >> LINK_EWMA_SHIFT) + sample;
+}
+
+void LinkQuality::update_score(PipeState* state)
+{
+    Stats* stats = &state->stats;
+
+    stats->rpd_score = (uint8_t)(state->rpd_acc >> LINK_EWMA_SHIFT);
+    stats->delivery_score = (uint8_t)(state->delivery_acc >> LINK_EWMA_SHIFT);
+    stats->duplicate_score = (uint8_t)(state->duplicate_acc >> LINK_EWMA_SHIFT);
+
+    if (state->stale) {
+        stats->score = 0;
+    } else if (state->sequenced) {
+        // Lost packets weigh more than a weak signal that still gets through
+        stats->score = (uint8_t)((3 * stats->delivery_score + stats->rpd_score) / 4);
+    } else {
+        stats->score = stats->rpd_score;
+    }
+}
@@ -22,11 +22,15 @@
 #include "dma.h"
 #include "i2c.h"
 #include "spi.h"
+#include "tim.h"
 #include "gpio.h"
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "display.h"
+#include "nrf24l01p.h"
+#include "radio.h"
+#include "us_timer.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -92,6 +96,7 @@ int main(void)
   MX_DMA_Init();
   MX_I2C1_Init();
   MX_SPI1_Init();
+  MX_TIM2_Init();
   /* USER CODE BEGIN 2 */
   /* USER CODE END 2 */
 
@@ -192,6 +197,32 @@ void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
   }
 }
+
+/**
+  * @brief  SPI DMA TxRx Complete Callback.
+  */
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi)
+{
+  // Releases CS and wakes the task waiting in nrf24l01p_transfer_wait()
+  nrf24l01p_spi_txrx_cplt_callback(hspi);
+}
+
+/**
+  * @brief  SPI Error Callback.
+  */
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi)
+{
+  nrf24l01p_spi_error_callback(hspi);
+  radio_spi_error_callback(hspi);
+}
+
+/**
+  * @brief  TIM Output Compare Callback (TIM2 microsecond alarms).
+  */
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef *htim)
+{
+  us_timer_oc_callback(htim);
+}
 /* USER CODE END 4 */
 
 /**
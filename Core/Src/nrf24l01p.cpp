@@ -0,0 +1,178 @@
+/*
+ *  nrf24l01_plus.c
+ *
+ *  Created on: 2021. 7. 20.
+ *      Author: mokhwasomssi
+ *
+ *  The driver itself lives in Nrf24Device (nrf24l01p_device.h); this file
+ *  keeps the C API, bound to the radio on SPI1.
+ */
+
+
+#include "nrf24l01p.h"
+#include "nrf24l01p_device.h"
+
+
+/* Air-time profiles */
+const nrf24l01p_profile NRF24L01P_PROFILE_DEFAULT        = {"default",        _1Mbps,   1, 5, _0dBm};
+const nrf24l01p_profile NRF24L01P_PROFILE_MAX_THROUGHPUT = {"max-throughput", _2Mbps,   1, 3, _0dBm};
+const nrf24l01p_profile NRF24L01P_PROFILE_LONG_RANGE     = {"long-range",     _250kbps, 2, 5, _0dBm};
+
+// Radio behind the C API
+Nrf24Default g_nrf24;
+
+
+/* nRF24L01+ Main Functions */
+void nrf24l01p_rx_init(channel MHz, air_data_rate bps)         { g_nrf24.rx_init(MHz, bps); }
+void nrf24l01p_tx_init(channel MHz, air_data_rate bps)         { g_nrf24.tx_init(MHz, bps); }
+
+void nrf24l01p_rx_receive(uint8_t* rx_payload)                  { g_nrf24.rx_receive(rx_payload); }
+void nrf24l01p_tx_transmit(uint8_t* tx_payload)                 { g_nrf24.tx_transmit(tx_payload); }
+
+void nrf24l01p_tx_irq()                                         { g_nrf24.tx_irq(); }
+
+/* nRF24L01+ Register Image */
+bool nrf24l01p_apply_image(const nrf24l01p_register_image* image, bool verify)
+{
+    return g_nrf24.apply_image(image, verify);
+}
+
+void nrf24l01p_ce_high()                                        { g_nrf24.ce_high(); }
+void nrf24l01p_ce_low()                                         { g_nrf24.ce_low(); }
+
+/* nRF24L01+ Sub Functions */
+void nrf24l01p_reset()                                          { g_nrf24.reset(); }
+
+void nrf24l01p_prx_mode()                                       { g_nrf24.prx_mode(); }
+void nrf24l01p_ptx_mode()                                       { g_nrf24.ptx_mode(); }
+
+void nrf24l01p_power_up()                                       { g_nrf24.power_up(); }
+void nrf24l01p_power_down()                                     { g_nrf24.power_down(); }
+
+void nrf24l01p_set_tx_address(uint8_t* address)                 { g_nrf24.set_tx_address(address); }
+void nrf24l01p_set_rx_address_p0(uint8_t* address)              { g_nrf24.set_rx_address_p0(address); }
+
+void nrf24l01p_configure_pipe(uint8_t pipe, const nrf24l01p_pipe_config* config)
+{
+    g_nrf24.configure_pipe(pipe, config);
+}
+
+void nrf24l01p_disable_pipe(uint8_t pipe)                       { g_nrf24.disable_pipe(pipe); }
+
+uint8_t nrf24l01p_get_status()                                  { return g_nrf24.get_status(); }
+uint8_t nrf24l01p_get_fifo_status()                             { return g_nrf24.get_fifo_status(); }
+bool nrf24l01p_get_rpd()                                        { return g_nrf24.get_rpd(); }
+
+void nrf24l01p_rx_set_payload_widths(widths bytes)              { g_nrf24.rx_set_payload_widths(bytes); }
+
+void nrf24l01p_enable_dynamic_payloads(uint8_t pipe_mask)       { g_nrf24.enable_dynamic_payloads(pipe_mask); }
+length nrf24l01p_read_rx_payload_width()                        { return g_nrf24.read_rx_payload_width(); }
+
+uint8_t nrf24l01p_read_rx_fifo(uint8_t* rx_payload)             { return g_nrf24.read_rx_fifo(rx_payload); }
+
+uint8_t nrf24l01p_read_rx_fifo_length(uint8_t* rx_payload, length len)
+{
+    return g_nrf24.read_rx_fifo_length(rx_payload, len);
+}
+
+uint8_t nrf24l01p_read_rx_fifo_dynamic(uint8_t* rx_payload, length* len)
+{
+    return g_nrf24.read_rx_fifo_dynamic(rx_payload, len);
+}
+
+uint8_t nrf24l01p_write_tx_fifo(uint8_t* tx_payload)            { return g_nrf24.write_tx_fifo(tx_payload); }
+
+void nrf24l01p_enable_ack_payloads(bool enable)                 { g_nrf24.enable_ack_payloads(enable); }
+
+uint8_t nrf24l01p_write_ack_payload(uint8_t pipe, const uint8_t* payload, length len)
+{
+    return g_nrf24.write_ack_payload(pipe, payload, len);
+}
+
+void nrf24l01p_flush_rx_fifo()                                  { g_nrf24.flush_rx_fifo(); }
+void nrf24l01p_flush_tx_fifo()                                  { g_nrf24.flush_tx_fifo(); }
+
+void nrf24l01p_clear_rx_dr()                                    { g_nrf24.clear_rx_dr(); }
+void nrf24l01p_clear_tx_ds()                                    { g_nrf24.clear_tx_ds(); }
+void nrf24l01p_clear_max_rt()                                   { g_nrf24.clear_max_rt(); }
+
+void nrf24l01p_set_rf_channel(channel MHz)                      { g_nrf24.set_rf_channel(MHz); }
+void nrf24l01p_set_rf_tx_output_power(output_power dBm)         { g_nrf24.set_rf_tx_output_power(dBm); }
+void nrf24l01p_set_rf_air_data_rate(air_data_rate bps)          { g_nrf24.set_rf_air_data_rate(bps); }
+
+void nrf24l01p_set_crc_length(length bytes)                     { g_nrf24.set_crc_length(bytes); }
+void nrf24l01p_set_address_widths(widths bytes)                 { g_nrf24.set_address_widths(bytes); }
+void nrf24l01p_auto_retransmit_count(count cnt)                 { g_nrf24.auto_retransmit_count(cnt); }
+void nrf24l01p_auto_retransmit_delay(delay us)                  { g_nrf24.auto_retransmit_delay(us); }
+
+uint8_t nrf24l01p_verify_registers()                            { return g_nrf24.verify_registers(); }
+
+/* nRF24L01+ Air-Time Profiles */
+void nrf24l01p_apply_profile(const nrf24l01p_profile* profile)  { g_nrf24.apply_profile(profile); }
+const nrf24l01p_profile* nrf24l01p_get_profile()                { return g_nrf24.get_profile(); }
+
+uint32_t nrf24l01p_air_time_us(const nrf24l01p_profile* profile, length payload_bytes)
+{
+    // Preamble + address + 9-bit packet control field + payload + CRC
+    uint32_t bits = 8 + profile->address_bytes * 8 + 9 + payload_bytes * 8 + profile->crc_bytes * 8;
+
+    switch(profile->bps)
+    {
+        case _250kbps:
+            return bits * 4;
+        case _2Mbps:
+            return (bits + 1) / 2;
+        case _1Mbps:
+        default:
+            return bits;
+    }
+}
+
+uint32_t nrf24l01p_exchange_time_us(const nrf24l01p_profile* profile, length payload_bytes, length ack_bytes)
+{
+    // Packet, PRX RX->TX turnaround, ACK, PTX TX->RX turnaround (130 us each)
+    return nrf24l01p_air_time_us(profile, payload_bytes) + 130
+         + nrf24l01p_air_time_us(profile, ack_bytes) + 130;
+}
+
+/* nRF24L01+ SPI Statistics */
+void nrf24l01p_get_spi_stats(nrf24l01p_spi_stats* stats)        { g_nrf24.get_spi_stats(stats); }
+void nrf24l01p_reset_spi_stats()                                { g_nrf24.reset_spi_stats(); }
+
+/* nRF24L01+ Asynchronous (DMA) Transactions */
+bool nrf24l01p_transfer_async(uint8_t command, const uint8_t* tx_payload, length len)
+{
+    return g_nrf24.transfer_async(command, tx_payload, len);
+}
+
+bool nrf24l01p_transfer_wait(uint8_t* status, uint8_t* rx_payload, length len, uint32_t timeout_ms)
+{
+    return g_nrf24.transfer_wait(status, rx_payload, len, timeout_ms);
+}
+
+void nrf24l01p_spi_txrx_cplt_callback(SPI_HandleTypeDef* hspi)  { g_nrf24.on_spi_txrx_cplt(hspi); }
+void nrf24l01p_spi_error_callback(SPI_HandleTypeDef* hspi)      { g_nrf24.on_spi_error(hspi); }
+
+/* nRF24L01+ Interrupt-Driven Receive Engine */
+bool nrf24l01p_rx_engine_start(const nrf24l01p_rx_engine_config* config)
+{
+    return g_nrf24.rx_engine_start(config);
+}
+
+void nrf24l01p_rx_engine_stop()                                 { g_nrf24.rx_engine_stop(); }
+
+void nrf24l01p_rx_engine_pause()                                { g_nrf24.rx_engine_pause(); }
+void nrf24l01p_rx_engine_resume()                               { g_nrf24.rx_engine_resume(); }
+
+bool nrf24l01p_rx_engine_pop(nrf24l01p_packet_handle* handle)  { return g_nrf24.rx_engine_pop(handle); }
+uint8_t nrf24l01p_rx_engine_pending()                           { return g_nrf24.rx_engine_pending(); }
+void nrf24l01p_rx_engine_get_stats(nrf24l01p_rx_engine_stats* stats) { g_nrf24.rx_engine_get_stats(stats); }
+
+void nrf24l01p_rx_engine_irq(uint32_t timestamp)                { g_nrf24.rx_engine_irq(timestamp); }
+void nrf24l01p_rx_engine_tick()                                 { g_nrf24.rx_engine_tick(); }
+
+/* nRF24L01+ Received-Packet Pool */
+nrf24l01p_packet_handle nrf24l01p_rx_packet_alloc()             { return g_nrf24.rx_packet_alloc(); }
+nrf24l01p_rx_packet* nrf24l01p_rx_packet_get(nrf24l01p_packet_handle handle) { return g_nrf24.rx_packet_get(handle); }
+void nrf24l01p_rx_packet_free(nrf24l01p_packet_handle handle)   { g_nrf24.rx_packet_free(handle); }
+void nrf24l01p_rx_pool_get_stats(nrf24l01p_pool_stats* stats)   { g_nrf24.rx_pool_get_stats(stats); }
@@ -0,0 +1,54 @@
+#include "packet_timing.h"
+#include <string.h>
+
+PacketTiming::PacketTiming()
+{
+    this->edge_cycles = 0;
+    this->edge_pending = false;
+    memset(&this->stats, 0, sizeof(this->stats));
+    this->stats.min_gap_cycles = UINT32_MAX;
+}
+
+void PacketTiming::stamp_edge(uint32_t now)
+{
+    this->edge_cycles = now;
+    this->edge_pending = true;
+}
+
+uint32_t PacketTiming::take_arrival(uint32_t now)
+{
+    uint32_t arrival = this->edge_pending ? this->edge_cycles : now;
+    this->edge_pending = false;
+    return arrival;
+}
+
+void PacketTiming::record(uint32_t arrival, uint32_t now)
+{
+    Stats* stats = &this->stats;
+    uint32_t latency = now - arrival;
+
+    if (stats->packets > 0)
+    {
+        uint32_t gap = arrival - stats->last_arrival;
+
+        stats->last_gap_cycles = gap;
+        if (gap < stats->min_gap_cycles) {
+            stats->min_gap_cycles = gap;
+        }
+        if (gap > stats->max_gap_cycles) {
+            stats->max_gap_cycles = gap;
+        }
+    }
+    stats->packets++;
+    stats->last_arrival = arrival;
+
+    stats->last_latency_cycles = latency;
+    if (latency > stats->max_latency_cycles) {
+        stats->max_latency_cycles = latency;
+    }
+}
+
+const PacketTiming::Stats& PacketTiming::get_stats(void) const
+{
+    return this->stats;
+}
@@ -1,26 +1,146 @@
 #include "radio.h"
 #include "nrf24l01p.h" // Правильний драйвер
+#include "nrf24l01p_config.h"
 #include "FreeRTOS.h"
 #include "task.h"
 #include <string.h>
 #include "display.h"
 #include <stdio.h>
 #include "ui_feedback.h"
+#include "us_timer.h"
 
 // --- Global Objects ---
-SemaphoreHandle_t g_radio_irq_sem; // Семафор для IRQ
 MyRadio g_radio;                   // Глобальний об'єкт радіо
 extern MyDisplay g_display;        // Глобальний об'єкт дисплея
 
+// Upper bound on payloads taken per wakeup (the FIFO refills while we drain)
+#define RADIO_MAX_BATCH 8
+
+// Read the register image back after bring-up
+#define RADIO_VERIFY_IMAGE 1
+
+// Drain the RX FIFO from interrupt/DMA context (nrf24l01p_rx_engine_*) instead of RadioTask
+#define RADIO_RX_ENGINE 1
+#define RADIO_RX_WATERMARK 4    // Packets that wake RadioTask at once
+#define RADIO_RX_TIMEOUT_MS 2   // Longest a smaller batch waits
+
+
+// Pipe 0 carries framed messages (frame.h) instead of one text per payload
+#define RADIO_PIPE0_FRAMED 0
+
+// Pipe 0 accepts only payloads sealed (ChaCha20-Poly1305) with the key in OTP block
+// RADIO_PIPE0_KEY_OTP_BLOCK, written once per device at provisioning. An unwritten
+// block (all 0xFF) leaves the pipe clear. Keys can also arrive at run time: radio_set_pipe_key()
+#define RADIO_PIPE0_KEY_OTP 0
+#define RADIO_PIPE0_KEY_OTP_BLOCK 0
+
+// Measure SecureLink::open() at startup and show its cycles per packet on the status line
+#define RADIO_AEAD_BENCHMARK 0
+
+// Wakeup period while the activity LED is lit
+#define RADIO_BLINK_SERVICE_MS 10
+
+#define RADIO_RF_CHANNEL 106
+
+// Startup channel selection: measure the candidates, announce the quietest on the
+// rendezvous channel (RADIO_ANNOUNCE_TAG), move there. Needs a transmitter that follows.
+#define RADIO_AUTO_CHANNEL 0
+#define RADIO_RENDEZVOUS_CHANNEL RADIO_RF_CHANNEL
+#define RADIO_RENDEZVOUS_PIPE 0
+#define RADIO_SELECT_BUDGET_MS 50       // RPD measurement time per selection
+#define RADIO_RESELECT_DELIVERY 128     // Delivery score (0..255) that triggers a re-selection
+
+// Clear of Wi-Fi channels 1/6/11 (nRF channels 1-23, 26-48, 51-73) where possible
+static const uint8_t RADIO_CHANNEL_CANDIDATES[] = {25, 49, 50, 76, 80, 84, 90, 96, 100, 110, 116, 124};
+
+/**
+ * @brief Receiver register image: channel 106, default profile, pipe 0 with
+ *        dynamic payloads and ACK payloads. Computed at compile time.
+ */
+static constexpr Nrf24ConfigBuilder RX_CONFIG = Nrf24ConfigBuilder()
+    .prx()
+    .power_up()
+    .rf_channel(RADIO_RF_CHANNEL)
+    .data_rate(_1Mbps)
+    .tx_output_power(_0dBm)
+    .crc_length(1)
+    .address_width(5)
+    .auto_retransmit(3, 250)
+    .pipe(0, true, true, NRF24L01P_PAYLOAD_LENGTH)
+    .ack_payloads(true)
+    .mask_irq(NRF24L01P_CONFIG_MASK_TX_DS | NRF24L01P_CONFIG_MASK_MAX_RT); // Приймачу потрібен лише RX_DR
+
+static constexpr nrf24l01p_register_image RX_IMAGE = RX_CONFIG.image();
+
+// nrf24l01p_reset() + nrf24l01p_rx_init() used to take ~30 transactions
+static_assert(RX_CONFIG.transactions(false) <= 12, "nRF24 bring-up exceeds its SPI transaction budget");
+
 uint8_t TX_ADDRESS[5] = {0xEE, 0xDD, 0xCC, 0xBB, 0xAA};
 uint8_t RX_ADDRESS[5] = {0xEE, 0xDD, 0xCC, 0xBB, 0xAA};
 
+#if RADIO_PIPE0_KEY_OTP
+// One 32-byte OTP block holds exactly one key
+static_assert(CHACHAPOLY_KEY_LENGTH == 32 && RADIO_PIPE0_KEY_OTP_BLOCK < 16, "Pipe 0 key must fill one OTP block");
+
+/**
+ * @brief The provisioned pipe 0 key, or NULL if its OTP block was never written.
+ */
+static const uint8_t* otp_pipe_key(void)
+{
+    const uint8_t* key = (const uint8_t*)(FLASH_OTP_BASE + RADIO_PIPE0_KEY_OTP_BLOCK * CHACHAPOLY_KEY_LENGTH);
+
+    for (uint8_t i = 0; i < CHACHAPOLY_KEY_LENGTH; i++)
+    {
+        if (key[i] != 0xFF) {
+            return key;
+        }
+    }
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Pipe 0: text payloads go to the main display zone.
+ */
+static bool display_pipe_handler(nrf24l01p_packet_handle handle, nrf24l01p_rx_packet* packet, void* context)
+{
+    // Статус "Listening..." залишається вгорі; дані в центрі (слот передається DisplayTask)
+    return g_display.post_packet(handle);
+}
+
+/**
+ * @brief Reassembled messages: text goes to the main display zone.
+ */
+static void display_message_handler(uint8_t sender, uint8_t type, const uint8_t* data, uint16_t len, void* context)
+{
+    if (type == FRAME_TYPE_TEXT) {
+        g_display.set_main_text((const char*)data, len);
+    }
+}
+
 // --- C-Wrappers (Entry Point) ---
 extern "C" {
 
 void radio_init(void)
 {
-    g_radio_irq_sem = xSemaphoreCreateBinary();
+    // DWT cycle counter for IRQ-to-task latency
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    // Передавач теж має ввімкнути EN_DPL
+    nrf24l01p_pipe_config pipe0 = {RX_ADDRESS, true, true, NRF24L01P_PAYLOAD_LENGTH};
+    g_radio.open_pipe(0, &pipe0, display_pipe_handler, NULL);
+    g_radio.set_message_handler(display_message_handler, NULL);
+#if RADIO_PIPE0_FRAMED
+    g_radio.set_pipe_framed(0, true);
+#endif
+#if RADIO_PIPE0_KEY_OTP
+    const uint8_t* key = otp_pipe_key();
+    if (key != NULL) {
+        g_radio.set_pipe_key(0, key);
+    }
+#endif
 }
 
 void radio_task_entry(void *argument)
@@ -28,6 +148,50 @@ void radio_task_entry(void *argument)
     g_radio.task();
 }
 
+void radio_irq_callback(void)
+{
+    g_radio.irq_from_isr();
+}
+
+void radio_spi_error_callback(SPI_HandleTypeDef* hspi)
+{
+    if (hspi == &NRF24L01P_SPI_HANDLE) {
+        g_radio.notify_from_isr(RADIO_EVENT_ERROR);
+    }
+}
+
+void radio_tick_callback(void)
+{
+#if RADIO_RX_ENGINE
+    nrf24l01p_rx_engine_tick();
+#endif
+}
+
+void radio_set_scan_mode(bool enable)
+{
+    g_radio.set_scan_mode(enable);
+}
+
+void radio_set_hop_mode(bool enable, uint8_t beacon_pipe)
+{
+    g_radio.set_hop_mode(enable, beacon_pipe);
+}
+
+void radio_set_fec_mode(bool enable)
+{
+    g_radio.set_fec_mode(enable);
+}
+
+void radio_set_pipe_key(uint8_t pipe, const uint8_t* key)
+{
+    g_radio.set_pipe_key(pipe, key);
+}
+
+void radio_clear_pipe_key(uint8_t pipe)
+{
+    g_radio.clear_pipe_key(pipe);
+}
+
 } // extern "C"
 
 // --- C++ Class Implementation ---
@@ -35,6 +199,305 @@ void radio_task_entry(void *argument)
 MyRadio::MyRadio()
 {
     // Конструктор. Черга tx_queue не потрібна.
+    memset(this->batch_histogram, 0, sizeof(this->batch_histogram));
+    memset(this->pipes, 0, sizeof(this->pipes));
+    this->acks.set_generator(MyRadio::generate_ack, this);
+    this->initialized = false;
+    this->profile = &NRF24L01P_PROFILE_DEFAULT;
+    this->task_handle = NULL;
+    this->irq_cycles = 0;
+    this->irq_stamped = false;
+    memset(&this->wake_stats, 0, sizeof(this->wake_stats));
+    this->wake_stats.min_cycles = UINT32_MAX;
+    this->framed_pipes = 0;
+    this->signal_bars = 0;
+    this->scan_requested = false;
+    this->scanning = false;
+    this->rf_channel = RADIO_RF_CHANNEL;
+    memset(this->key_requested, 0, sizeof(this->key_requested));
+    this->key_requests = 0;
+    this->key_clears = 0;
+}
+
+const uint32_t* MyRadio::get_batch_histogram(void) const
+{
+    return this->batch_histogram;
+}
+
+const AckPayloads::Stats& MyRadio::get_ack_stats(void) const
+{
+    return this->acks.get_stats();
+}
+
+const MyRadio::WakeStats& MyRadio::get_wake_stats(void) const
+{
+    return this->wake_stats;
+}
+
+uint32_t MyRadio::get_stack_headroom(void) const
+{
+    TaskHandle_t task = this->task_handle;
+    return (task != NULL) ? (uint32_t)uxTaskGetStackHighWaterMark(task) : 0;
+}
+
+const MyRadio::ArrivalStats& MyRadio::get_arrival_stats(void) const
+{
+    return this->timing.get_stats();
+}
+
+const LinkQuality& MyRadio::get_link_quality(void) const
+{
+    return this->link;
+}
+
+void MyRadio::set_pipe_sequenced(uint8_t pipe, bool sequenced)
+{
+    this->link.set_sequenced(pipe, sequenced);
+}
+
+void MyRadio::set_pipe_framed(uint8_t pipe, bool framed)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+
+    if (framed) {
+        this->framed_pipes |= (uint8_t)(1U << pipe);
+    } else {
+        this->framed_pipes &= (uint8_t)~(1U << pipe);
+    }
+    this->link.set_sequenced(pipe, framed);
+}
+
+void MyRadio::set_message_handler(Reassembler::MessageHandler handler, void* context)
+{
+    this->reassembler.set_handler(handler, context);
+}
+
+const Reassembler& MyRadio::get_reassembler(void) const
+{
+    return this->reassembler;
+}
+
+void MyRadio::set_bulk_sink(BulkReceiver::Sink sink, void* context)
+{
+    this->bulk.set_sink(sink, context);
+}
+
+const BulkReceiver& MyRadio::get_bulk_receiver(void) const
+{
+    return this->bulk;
+}
+
+void MyRadio::set_pipe_key(uint8_t pipe, const uint8_t* key)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+
+    // SecureLink belongs to RadioTask: the key waits here for its next pass
+    taskENTER_CRITICAL();
+    memcpy(this->key_requested[pipe], key, CHACHAPOLY_KEY_LENGTH);
+    this->key_clears &= ~(1U << pipe);
+    this->key_requests |= 1U << pipe;
+    taskEXIT_CRITICAL();
+
+    if (this->task_handle != NULL) {
+        xTaskNotify(this->task_handle, RADIO_EVENT_MODE, eSetBits);
+    }
+}
+
+void MyRadio::clear_pipe_key(uint8_t pipe)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    memset(this->key_requested[pipe], 0, CHACHAPOLY_KEY_LENGTH);
+    this->key_clears |= 1U << pipe;
+    this->key_requests |= 1U << pipe;
+    taskEXIT_CRITICAL();
+
+    if (this->task_handle != NULL) {
+        xTaskNotify(this->task_handle, RADIO_EVENT_MODE, eSetBits);
+    }
+}
+
+void MyRadio::apply_pipe_keys(void)
+{
+    uint8_t key[CHACHAPOLY_KEY_LENGTH];
+
+    for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+    {
+        uint8_t bit = 1U << pipe;
+        bool pending, clear;
+
+        taskENTER_CRITICAL();
+        pending = (this->key_requests & bit) != 0;
+        clear = (this->key_clears & bit) != 0;
+        if (pending)
+        {
+            memcpy(key, this->key_requested[pipe], sizeof(key));
+            memset(this->key_requested[pipe], 0, sizeof(key));
+            this->key_requests &= ~bit;
+        }
+        taskEXIT_CRITICAL();
+
+        if (!pending) {
+            continue;
+        }
+
+        if (clear)
+        {
+            this->secure.clear_key(pipe);
+        }
+        else
+        {
+            uint8_t address[5];
+            this->pipe_address(pipe, address);
+            this->secure.set_key(pipe, key, address);
+            this->link.set_sequenced(pipe, true);
+        }
+    }
+
+    memset(key, 0, sizeof(key));
+}
+
+const SecureLink& MyRadio::get_secure_link(void) const
+{
+    return this->secure;
+}
+
+void MyRadio::set_fec_mode(bool enable)
+{
+    this->fec.request(enable);
+
+    if (this->task_handle != NULL) {
+        xTaskNotify(this->task_handle, RADIO_EVENT_MODE, eSetBits);
+    }
+}
+
+bool MyRadio::is_fec(void) const
+{
+    return this->fec.is_enabled();
+}
+
+const FecMode::Stats& MyRadio::get_fec_stats(void) const
+{
+    return this->fec.get_stats();
+}
+
+void MyRadio::set_scan_mode(bool enable)
+{
+    this->scan_requested = enable;
+
+    if (this->task_handle != NULL) {
+        xTaskNotify(this->task_handle, RADIO_EVENT_MODE, eSetBits);
+    }
+}
+
+bool MyRadio::is_scanning(void) const
+{
+    return this->scanning;
+}
+
+const ChannelScanner& MyRadio::get_scanner(void) const
+{
+    return this->scanner;
+}
+
+void MyRadio::set_hop_mode(bool enable, uint8_t beacon_pipe)
+{
+    if (beacon_pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+
+    this->hopper.request(enable, beacon_pipe);
+
+    if (this->task_handle != NULL) {
+        xTaskNotify(this->task_handle, RADIO_EVENT_MODE, eSetBits);
+    }
+}
+
+const FreqHopper& MyRadio::get_hopper(void) const
+{
+    return this->hopper;
+}
+
+const ChannelSelector& MyRadio::get_channel_selector(void) const
+{
+    return this->selector;
+}
+
+void MyRadio::request_channel_selection(void)
+{
+    this->selector.request();
+
+    if (this->task_handle != NULL) {
+        xTaskNotify(this->task_handle, RADIO_EVENT_MODE, eSetBits);
+    }
+}
+
+MyRadio::RxMode MyRadio::get_rx_mode(void) const
+{
+    return this->rx_mode.get_mode();
+}
+
+const MyRadio::RxModeStats& MyRadio::get_rx_mode_stats(void) const
+{
+    return this->rx_mode.get_stats();
+}
+
+void MyRadio::notify_from_isr(uint32_t events)
+{
+    if (this->task_handle == NULL) {
+        return;
+    }
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xTaskNotifyFromISR(this->task_handle, events, eSetBits, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+void MyRadio::irq_from_isr(void)
+{
+    // Перше, що робимо в перериванні: час приходу пакета
+    uint32_t now = DWT->CYCCNT;
+
+    // Latency is measured from the first edge RadioTask has not serviced yet
+    // (with the receive engine this includes the batching delay)
+    if (!this->irq_stamped)
+    {
+        this->irq_cycles = now;
+        this->irq_stamped = true;
+    }
+#if RADIO_RX_ENGINE
+    nrf24l01p_rx_engine_irq(now);
+#else
+    this->timing.stamp_edge(now);
+    this->notify_from_isr(RADIO_EVENT_RX_READY);
+#endif
+}
+
+void MyRadio::record_wake_latency(void)
+{
+    if (!this->irq_stamped) {
+        return;
+    }
+
+    uint32_t cycles = DWT->CYCCNT - this->irq_cycles;
+    this->irq_stamped = false;
+
+    WakeStats* stats = &this->wake_stats;
+    stats->samples++;
+    stats->last_cycles = cycles;
+    if (cycles < stats->min_cycles) {
+        stats->min_cycles = cycles;
+    }
+    if (cycles > stats->max_cycles) {
+        stats->max_cycles = cycles;
+    }
 }
 
 /**
@@ -42,21 +505,153 @@ MyRadio::MyRadio()
  */
 bool MyRadio::init(void)
 {
-    // Викликаємо ініціалізацію для RX
-    nrf24l01p_rx_init(106, _1Mbps);
-    nrf24l01p_set_rx_address_p0(RX_ADDRESS);
+    // Один прохід по регістрах замість reset + rx_init
+    if (!nrf24l01p_apply_image(&RX_IMAGE, RADIO_VERIFY_IMAGE)) {
+        return false;
+    }
+    if (this->profile != &NRF24L01P_PROFILE_DEFAULT) {
+        nrf24l01p_apply_profile(this->profile);
+    }
 	nrf24l01p_set_tx_address(RX_ADDRESS);
+
+    // Програмуємо всі відкриті труби (pipes), решту вимикаємо
+    for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+    {
+        this->apply_pipe(pipe);
+    }
+
+    // Tpd2stby (1.5 ms) після PWR_UP, потім слухаємо ефір
+    vTaskDelay(pdMS_TO_TICKS(2));
+    nrf24l01p_ce_high();
+
+#if RADIO_RX_ENGINE
+    nrf24l01p_rx_engine_config engine = {
+        this->task_handle, RADIO_EVENT_RX_READY, RADIO_EVENT_ERROR,
+        RADIO_RX_WATERMARK, RADIO_RX_TIMEOUT_MS
+    };
+    if (!nrf24l01p_rx_engine_start(&engine)) {
+        return false;
+    }
+#endif
+
+    this->initialized = true;
     return true;
 }
 
+bool MyRadio::open_pipe(uint8_t pipe, const nrf24l01p_pipe_config* config,
+                        RadioPipeHandler handler, void* context)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return false;
+    }
+
+    PipeSlot* slot = &this->pipes[pipe];
+    memcpy(slot->address, config->address, (pipe < 2) ? sizeof(slot->address) : 1);
+    slot->config = *config;
+    slot->config.address = slot->address;
+    slot->handler = handler;
+    slot->context = context;
+    slot->open = true;
+    this->acks.set_pipe_enabled(pipe, config->auto_ack && config->dynamic_payload);
+
+    if (this->initialized)
+    {
+        nrf24l01p_rx_engine_pause();
+        this->apply_pipe(pipe);
+        nrf24l01p_rx_engine_resume();
+    }
+    return true;
+}
+
+void MyRadio::close_pipe(uint8_t pipe)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+
+    this->pipes[pipe].open = false;
+    this->pipes[pipe].handler = NULL;
+    this->acks.set_pipe_enabled(pipe, false);
+
+    if (this->initialized)
+    {
+        nrf24l01p_rx_engine_pause();
+        this->apply_pipe(pipe);
+        nrf24l01p_rx_engine_resume();
+    }
+}
+
+bool MyRadio::queue_ack_payload(uint8_t pipe, const uint8_t* data, length len)
+{
+    bool queued = this->acks.queue(pipe, data, len);
+
+    // Wake RadioTask so an idle pipe gets its payload preloaded
+    if (queued && this->task_handle != NULL) {
+        xTaskNotify(this->task_handle, RADIO_EVENT_ACK_QUEUED, eSetBits);
+    }
+    return queued;
+}
+
+length MyRadio::generate_ack(uint8_t pipe, uint8_t* out, void* context)
+{
+    MyRadio* radio = (MyRadio*)context;
+
+    // Both are rebuilt fresh for every auto-ack
+    if (radio->secure.get_sync_request(pipe, out)) {
+        return SECURE_SYNC_LENGTH;
+    }
+    if (radio->bulk.is_active() && radio->bulk.get_sender() == pipe) {
+        return radio->bulk.get_status(out);
+    }
+    return 0;
+}
+
+void MyRadio::refresh_bulk_status(void)
+{
+#if RADIO_RX_ENGINE
+    // Packets still in the ring were acknowledged before this write could reach
+    // the air, and would make it stale at once: the last of them reloads it
+    if (nrf24l01p_rx_engine_pending() == 0) {
+        this->acks.refill();
+    }
+#endif
+}
+
+void MyRadio::set_profile(const nrf24l01p_profile* profile)
+{
+    this->profile = profile;
+
+    if (this->initialized)
+    {
+        nrf24l01p_rx_engine_pause();
+        nrf24l01p_apply_profile(profile);
+        if (this->fec.is_enabled()) {
+            nrf24l01p_set_crc_length(0);
+        }
+        nrf24l01p_rx_engine_resume();
+    }
+}
+
+void MyRadio::apply_pipe(uint8_t pipe)
+{
+    if (!this->pipes[pipe].open)
+    {
+        nrf24l01p_disable_pipe(pipe);
+        return;
+    }
+
+    nrf24l01p_pipe_config config = this->pipes[pipe].config;
+    this->fec.configure_pipe(&config);
+    nrf24l01p_configure_pipe(pipe, &config);
+}
+
 /**
  * @brief Головна задача радіо (тільки Приймач)
  */
 void MyRadio::task(void)
 {
-    // 1. Оголошуємо буфер ЗРАЗУ на початку функції
-    uint8_t rx_buf[NRF24L01P_PAYLOAD_LENGTH];
-    memset(rx_buf, 0, NRF24L01P_PAYLOAD_LENGTH); // Очищуємо "сміття" з пам'яті
+    // From here on the EXTI callback and the receive engine notify this task directly
+    this->task_handle = xTaskGetCurrentTaskHandle();
 
     if (!this->init()) {
         g_display.set_status_text("Radio Fail!");
@@ -68,35 +663,536 @@ void MyRadio::task(void)
     g_display.set_status_text("Listening...");
     g_display.set_main_text(""); // Очищуємо головну зону
 
-    // nrf24l01p_rx_init вже встановив CE HIGH, модуль слухає ефір
+    // init() вже встановив CE HIGH, модуль слухає ефір
+
+    this->acks.refill();
+
+#if RADIO_AEAD_BENCHMARK
+    char bench[24];
+    snprintf(bench, sizeof(bench), "AEAD %lu cyc/pkt",
+             (unsigned long)SecureLink::benchmark(SECURE_MAX_PLAINTEXT, 256));
+    g_display.set_status_text(bench);
+    vTaskDelay(pdMS_TO_TICKS(2000));
+    g_display.set_status_text("Listening...");
+#endif
+
+#if RADIO_AUTO_CHANNEL
+    this->select_channel();
+#endif
+
+    this->rx_mode.start(xTaskGetTickCount());
 
     while(1)
     {
-        // Чекаємо на IRQ (отримання даних)
-        if (xSemaphoreTake(g_radio_irq_sem, portMAX_DELAY) == pdTRUE)
+        if (this->scan_requested != this->scanning) {
+            this->set_scanning(this->scan_requested);
+        }
+        if (this->scanning) {
+            this->scan_pass();
+        }
+        if (this->hopper.needs_switch()) {
+            this->set_hopping(this->hopper.is_requested());
+        }
+        if (this->fec.needs_switch()) {
+            this->set_fec(!this->fec.is_enabled());
+        }
+        if (this->key_requests != 0) {
+            this->apply_pipe_keys();
+        }
+
+        uint32_t events = 0;
+        bool restart = false;
+        bool polling = (this->rx_mode.get_mode() == RxModeController::RX_MODE_POLL);
+        TickType_t wait = polling ? pdMS_TO_TICKS(RX_POLL_PERIOD_MS) : pdMS_TO_TICKS(RADIO_IDLE_TIMEOUT_MS);
+
+        // Scanning: the next chunk follows straight after this pass
+        if (this->scanning) {
+            wait = 0;
+        }
+
+        // Wake up in time to end an LED pulse
+        bool blinking = UI_Blink_Service();
+        if (blinking && wait > pdMS_TO_TICKS(RADIO_BLINK_SERVICE_MS)) {
+            wait = pdMS_TO_TICKS(RADIO_BLINK_SERVICE_MS);
+        }
+
+        // Чекаємо на подію (IRQ, помилка SPI, новий ACK payload)
+        if (xTaskNotifyWait(0, RADIO_EVENT_ALL, &events, wait) != pdTRUE) {
+            // A short wait for the LED or the scanner is not an idle timeout
+            events = (polling || blinking || this->scanning) ? 0 : RADIO_EVENT_TIMEOUT;
+        }
+
+        // Retune first: the boundary came as RADIO_EVENT_HOP
+        if (!this->hopper.is_active()) {
+            this->service_channel();
+        } else if (events & RADIO_EVENT_HOP) {
+            this->service_hop();
+        }
+
+        if (polling) {
+            events |= RADIO_EVENT_RX_READY;     // Every pass is a poll; the IRQ line is masked
+        }
+        if (this->scanning) {
+            events |= RADIO_EVENT_RX_READY;     // Edges during the chunk were cleared with RX_DR
+        }
+
+        if (events & RADIO_EVENT_RX_READY) {
+            this->record_wake_latency();
+        }
+
+        if (events & RADIO_EVENT_ERROR)
         {
-            // IRQ спрацював
-            uint8_t status = nrf24l01p_get_status();
+            // A payload read may have been cut short: look at the FIFO again
+            this->wake_stats.spi_errors++;
+            events |= RADIO_EVENT_RX_READY;
+            restart = true;
+        }
 
-            if (status & (1 << 6)) // Перевірка прапора RX_DR
-            {
-                UI_Blink_Triple(); // Блимаємо діодом
+        if ((events & RADIO_EVENT_TIMEOUT) &&
+            HAL_GPIO_ReadPin(NRF24_IRQ_GPIO_Port, NRF24_IRQ_Pin) == GPIO_PIN_RESET)
+        {
+            // IRQ is active low and still asserted: the falling edge was lost
+            this->wake_stats.missed_irqs++;
+            events |= RADIO_EVENT_RX_READY;
+            restart = true;
+        }
+
+        uint8_t batch = 0;
+        if (events & RADIO_EVENT_RX_READY)
+        {
+#if RADIO_RX_ENGINE
+            // Пакети вже в кільцевому буфері (зчитані в перериваннях)
+            batch = this->drain_rx_ring();
+#else
+            // IRQ спрацював: забираємо ВСІ пакети з FIFO
+            batch = this->drain_rx_fifo();
+#endif
+        }
+
+        // No new IRQ edge will come for packets left behind: restart the receive chain.
+        // While polling, this is the poll itself: the chain collects the next batch.
+        if (restart || polling) {
+            nrf24l01p_rx_engine_resume();
+        }
+
+        this->update_rx_mode(batch);
+        this->update_link_indicator();
+        this->reassembler.expire(xTaskGetTickCount() * portTICK_PERIOD_MS);
+        this->bulk.expire(xTaskGetTickCount() * portTICK_PERIOD_MS);
+
+        // Підвантажуємо наступні ACK payload-и
+        this->acks.expire(DWT->CYCCNT);
+        this->acks.refill();
+
+        // Re-arm after the drain: beacons of this pass may have moved the boundary
+        if (this->hopper.is_active()) {
+            this->service_hop();
+        }
+
+        if (batch > 0)
+        {
+            UI_Blink_Pulse(); // Блимаємо діодом без блокування (UI_Blink_Triple спав 250 мс)
+        }
+        else if ((events & RADIO_EVENT_RX_READY) && !polling)
+        {
+            // Скидаємо інші прапори
+            nrf24l01p_rx_engine_pause();
+            nrf24l01p_clear_tx_ds();
+            nrf24l01p_clear_max_rt();
+            nrf24l01p_rx_engine_resume();
+        }
+    }
+}
+
+/**
+ * @brief Drains the RX FIFO until STATUS reports it empty.
+ * @note RX_DR is cleared once, before draining: a packet that lands during
+ *       the loop sets it again and produces a fresh falling edge on IRQ.
+ */
+uint8_t MyRadio::drain_rx_fifo(void)
+{
+    uint8_t batch = 0;
+
+    // Packets of this pass arrived by the latest edge; polled ones get the read time
+    uint32_t arrival = this->timing.take_arrival(DWT->CYCCNT);
+
+    nrf24l01p_clear_rx_dr();
+    uint8_t status = nrf24l01p_get_status();
+
+    while (NRF24L01P_STATUS_RX_P_NO(status) != NRF24L01P_RX_P_NO_EMPTY)
+    {
+        uint8_t pipe = NRF24L01P_STATUS_RX_P_NO(status);
+
+        // Every slot is held downstream: the payload waits in the FIFO and the
+        // missed-IRQ check on the next timeout picks it up
+        nrf24l01p_packet_handle handle = nrf24l01p_rx_packet_alloc();
+        if (handle == NRF24L01P_PACKET_NONE) {
+            break;
+        }
+
+        nrf24l01p_rx_packet* packet = nrf24l01p_rx_packet_get(handle);
+        packet->timestamp = xTaskGetTickCount();
+        packet->arrival = arrival;
+        packet->pipe = pipe;
+
+        if (pipe < NRF24L01P_PIPE_COUNT && (this->fec.is_enabled() || !this->pipes[pipe].config.dynamic_payload))
+        {
+            packet->len = this->fec.is_enabled() ? FEC_CODED_LENGTH : this->pipes[pipe].config.payload_width;
+            nrf24l01p_read_rx_fifo_length(packet->payload, packet->len);
+        }
+        else
+        {
+            nrf24l01p_read_rx_fifo_dynamic(packet->payload, &packet->len);
+        }
+
+        this->dispatch(handle);
+
+        if (++batch == RADIO_MAX_BATCH)
+        {
+            // Still busy: schedule another pass instead of starving other tasks
+            xTaskNotify(xTaskGetCurrentTaskHandle(), RADIO_EVENT_RX_READY, eSetBits);
+            break;
+        }
+        status = nrf24l01p_get_status();
+    }
+
+    this->record_batch(batch);
+    return batch;
+}
+
+uint8_t MyRadio::drain_rx_ring(void)
+{
+    nrf24l01p_packet_handle handle;
+    uint8_t batch = 0;
+
+    while (batch < RADIO_MAX_BATCH && nrf24l01p_rx_engine_pop(&handle))
+    {
+        this->dispatch(handle);
+        batch++;
+    }
+
+    // Still busy: schedule another pass instead of starving other tasks
+    if (nrf24l01p_rx_engine_pending() > 0) {
+        xTaskNotify(xTaskGetCurrentTaskHandle(), RADIO_EVENT_RX_READY, eSetBits);
+    }
+
+    this->record_batch(batch);
+    return batch;
+}
+
+void MyRadio::dispatch(nrf24l01p_packet_handle handle)
+{
+    nrf24l01p_rx_packet* packet = nrf24l01p_rx_packet_get(handle);
+    uint8_t pipe = packet->pipe;
+    length air_len = packet->len;
+    bool kept = false;
+
+    // Without hardware CRC, noise and damaged packets end at the decoder
+    if (pipe < NRF24L01P_PIPE_COUNT && this->fec.decode(packet))
+    {
+        this->acks.on_packet(pipe, packet->arrival);
+        if (pipe == RADIO_RENDEZVOUS_PIPE) {
+            this->selector.on_rendezvous_packet();
+        }
+
+        this->timing.record(packet->arrival, DWT->CYCCNT);
+
+        // Keyed pipes: the counter's low byte is the sequence number, and it is
+        // authenticated data, but only once open() has checked the tag
+        bool secure = this->secure.is_secure(pipe);
+        uint8_t seq = packet->payload[0];
+
+        if (secure && !this->secure.open(packet))
+        {
+            // Forged, replayed or unsealed: dropped before it can move the link
+            // score, the hop schedule or the duplicate filter
+        }
+        else
+        {
+            LinkQuality::Verdict verdict = secure ? this->link.record(packet, seq) : this->link.record(packet);
 
-                // Отримано дані
-                nrf24l01p_rx_receive(rx_buf);
-                rx_buf[NRF24L01P_PAYLOAD_LENGTH - 1] = '\0'; // Гарантуємо нуль-термінатор
+            // Dispatch by the pipe the payload arrived on
+            if (this->hopper.is_beacon(pipe, packet->payload, packet->len))
+            {
+                // Hop beacons stay with RadioTask
+                this->hopper.take_beacon(packet->payload, nrf24l01p_air_time_us(this->profile, air_len),
+                                         packet->arrival);
+            }
+            else if (verdict == LinkQuality::LINK_DUPLICATE && !secure)
+            {
+                // Retransmitted after a lost auto-ack: the first copy was handed over already
+                // (keyed pipes rely on the authenticated replay check instead)
+            }
+            else if (this->framed_pipes & (1U << pipe))
+            {
+                uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+                uint8_t type = (packet->len > 1) ? packet->payload[1] : 0;
 
-                // 3. ОНОВЛЮЄМО ТІЛЬКИ ГОЛОВНУ ЗОНУ
-                // Статус "Listening..." залишається вгорі
-                g_display.set_main_text((char*)rx_buf); // Дані в центрі
+                // Both copy what they keep (arena, window); the slot goes back at once
+                if (type == FRAME_TYPE_BULK_START || type == FRAME_TYPE_BULK_DATA)
+                {
+                    this->bulk.feed(pipe, packet->payload, packet->len, now_ms);
+                    this->refresh_bulk_status();
+                }
+                else
+                {
+                    this->reassembler.feed(pipe, packet->payload, packet->len, now_ms);
+                }
             }
-            else
+            else if (packet->len > 0 && this->pipes[pipe].handler != NULL)
             {
-                // Скидаємо інші прапори
-                nrf24l01p_clear_rx_dr();
-                nrf24l01p_clear_tx_ds();
-                nrf24l01p_clear_max_rt();
+                kept = this->pipes[pipe].handler(handle, packet, this->pipes[pipe].context);
             }
         }
     }
+
+    if (!kept) {
+        nrf24l01p_rx_packet_free(handle);
+    }
+}
+
+void MyRadio::suspend_rx(bool suspend)
+{
+    if (suspend)
+    {
+        if (this->rx_mode.get_mode() == RxModeController::RX_MODE_POLL) {
+            this->set_rx_mode(RxModeController::RX_MODE_IRQ);
+        }
+        HAL_NVIC_DisableIRQ(NRF24_IRQ_EXTI_IRQn);
+        nrf24l01p_rx_engine_pause();
+
+        // Без відкритих труб нічого не приймаємо і не відповідаємо ACK-ами; RPD від адреси не залежить
+        nrf24l01p_ce_low();
+        for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++) {
+            nrf24l01p_disable_pipe(pipe);
+        }
+    }
+    else
+    {
+        nrf24l01p_ce_low();
+        nrf24l01p_set_rf_channel(this->rf_channel);
+        for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++) {
+            this->apply_pipe(pipe);
+        }
+        nrf24l01p_clear_rx_dr();
+        nrf24l01p_ce_high();
+
+        __HAL_GPIO_EXTI_CLEAR_IT(NRF24_IRQ_Pin);
+        HAL_NVIC_ClearPendingIRQ(NRF24_IRQ_EXTI_IRQn);
+        HAL_NVIC_EnableIRQ(NRF24_IRQ_EXTI_IRQn);
+        nrf24l01p_rx_engine_resume();
+    }
+}
+
+void MyRadio::set_scanning(bool enable)
+{
+    if (enable)
+    {
+        this->scanner.reset();
+        g_display.set_status_text("Scanning...");
+        g_display.set_mode(MyDisplay::MODE_SPECTRUM);
+    }
+    else
+    {
+        g_display.set_mode(MyDisplay::MODE_TEXT);
+        g_display.set_status_text("Listening...");
+    }
+
+    this->scanning = enable;
+}
+
+void MyRadio::select_channel(void)
+{
+    // Bounded measurement: whole passes over the candidates until the budget is spent
+    this->suspend_rx(true);
+    uint8_t channel = this->scanner.measure(RADIO_CHANNEL_CANDIDATES, sizeof(RADIO_CHANNEL_CANDIDATES),
+                                            RADIO_SELECT_BUDGET_MS * 1000U);
+    this->rf_channel = RADIO_RENDEZVOUS_CHANNEL;
+    this->suspend_rx(false);
+
+    uint32_t scan_us = this->scanner.get_sweep_cycles() / (SystemCoreClock / 1000000U);
+
+    // The announcement rides on the auto-ack of the next packet on the rendezvous pipe,
+    // or the one after if a reply is already loaded ahead of it (TX FIFO order)
+    uint8_t announce[2] = {RADIO_ANNOUNCE_TAG, channel};
+    uint8_t ahead = this->acks.is_loaded(RADIO_RENDEZVOUS_PIPE) ? 1 : 0;
+    uint8_t announce_packets = 0;
+
+    if (this->acks.load(RADIO_RENDEZVOUS_PIPE, announce, sizeof(announce))) {
+        announce_packets = 1 + ahead;
+    }
+    this->selector.on_selected(channel, scan_us, announce_packets, xTaskGetTickCount());
+
+    char status[24];
+    snprintf(status, sizeof(status), "Ch %u? %lums", channel, (unsigned long)(scan_us / 1000));
+    g_display.set_status_text(status);
+}
+
+void MyRadio::service_channel(void)
+{
+    char status[24];
+
+    switch (this->selector.update(xTaskGetTickCount(), this->link.is_degraded(RADIO_RESELECT_DELIVERY)))
+    {
+        case ChannelSelector::CHANNEL_SELECT:
+            this->select_channel();
+            break;
+        case ChannelSelector::CHANNEL_MOVE:
+            this->tune(this->selector.get_channel(RADIO_RF_CHANNEL));
+            snprintf(status, sizeof(status), "Ch %u", this->selector.get_channel(RADIO_RF_CHANNEL));
+            g_display.set_status_text(status);
+            break;
+        case ChannelSelector::CHANNEL_STAY:
+        default:
+            break;
+    }
+}
+
+void MyRadio::scan_pass(void)
+{
+    char status[24];
+
+    // Receive stops for one chunk only; the rest of the pass serves packets as usual
+    this->suspend_rx(true);
+    bool swept = this->scanner.sweep_step(SCAN_CHUNK_CHANNELS);
+    this->suspend_rx(false);
+
+    if (!swept) {
+        return;
+    }
+
+    // DisplayTask picks up the newest copy whenever it redraws
+    g_display.set_spectrum(this->scanner.get_levels(), this->scanner.get_peaks());
+
+    snprintf(status, sizeof(status), "Scan quiet:%u",
+             this->scanner.get_quietest(0, NRF24L01P_CHANNEL_COUNT - 1));
+    g_display.set_status_text(status);
+}
+
+void MyRadio::set_hopping(bool enable)
+{
+    if (enable)
+    {
+        uint8_t pipe = this->hopper.get_requested_pipe();
+        uint8_t address[5];
+        this->pipe_address(pipe, address);
+
+        this->hopper.start(pipe, address, sizeof(address), SystemCoreClock / 1000000U, DWT->CYCCNT);
+        this->service_hop();
+        g_display.set_status_text("Hopping...");
+    }
+    else
+    {
+        this->hopper.stop();
+        us_timer_cancel_alarm();
+        this->tune(this->selector.get_channel(RADIO_RF_CHANNEL));
+        g_display.set_status_text("Listening...");
+    }
+}
+
+void MyRadio::service_hop(void)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+
+    if (this->hopper.update(DWT->CYCCNT)) {
+        this->tune(this->hopper.get_channel());
+    }
+
+    // The compare wakes RadioTask on the boundary: no tick rounding, no spinning.
+    // Rounded up, so update() on that wakeup always sees the hop as due.
+    uint32_t left = this->hopper.ticks_to_next(DWT->CYCCNT);
+    us_timer_alarm(this->task_handle, RADIO_EVENT_HOP, us_timer_now() + (left + cycles_per_us - 1) / cycles_per_us);
+}
+
+void MyRadio::tune(uint8_t channel)
+{
+    this->rf_channel = channel;
+
+    // Пакети, що вже у FIFO, залишаються; новий канал слухаємо через 130 мкс
+    nrf24l01p_rx_engine_pause();
+    nrf24l01p_ce_low();
+    nrf24l01p_set_rf_channel(channel);
+    nrf24l01p_ce_high();
+    nrf24l01p_rx_engine_resume();
+}
+
+void MyRadio::set_fec(bool enable)
+{
+    nrf24l01p_rx_engine_pause();
+    nrf24l01p_ce_low();
+
+    // EN_AA goes first: the chip keeps EN_CRC set while any pipe acknowledges
+    this->fec.set_enabled(enable);
+    this->acks.set_suspended(enable);
+    for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++) {
+        this->apply_pipe(pipe);
+    }
+    nrf24l01p_set_crc_length(this->fec.crc_bytes(this->profile->crc_bytes));
+
+    // Payloads in the FIFO were received in the old format
+    nrf24l01p_flush_rx_fifo();
+    nrf24l01p_clear_rx_dr();
+    nrf24l01p_ce_high();
+    nrf24l01p_rx_engine_resume();
+
+    g_display.set_status_text(enable ? "Listening FEC" : "Listening...");
+}
+
+void MyRadio::pipe_address(uint8_t pipe, uint8_t* address) const
+{
+    // Pipes 2-5 only own the LSB; the rest comes from pipe 1
+    memcpy(address, this->pipes[(pipe < 2) ? pipe : 1].address, 5);
+    address[0] = this->pipes[pipe].address[0];
+}
+
+void MyRadio::update_link_indicator(void)
+{
+    this->link.age(xTaskGetTickCount());
+
+    uint8_t bars = this->link.get_bars();
+    if (bars != this->signal_bars)
+    {
+        this->signal_bars = bars;
+        g_display.set_signal_level(bars);
+    }
+}
+
+void MyRadio::record_batch(uint8_t batch)
+{
+    uint8_t bin = (batch < BATCH_HISTOGRAM_BINS) ? batch : BATCH_HISTOGRAM_BINS - 1;
+    this->batch_histogram[bin]++;
+}
+
+void MyRadio::update_rx_mode(uint8_t batch)
+{
+    if (this->rx_mode.update(batch, xTaskGetTickCount())) {
+        this->apply_rx_mode();
+    }
+}
+
+void MyRadio::set_rx_mode(RxMode mode)
+{
+    this->rx_mode.set_mode(mode, xTaskGetTickCount());
+    this->apply_rx_mode();
+}
+
+void MyRadio::apply_rx_mode(void)
+{
+    if (this->rx_mode.get_mode() == RxModeController::RX_MODE_POLL)
+    {
+        HAL_NVIC_DisableIRQ(NRF24_IRQ_EXTI_IRQn);
+    }
+    else
+    {
+        // Drop the edges seen while masked; the line may already be low, so collect once by hand
+        __HAL_GPIO_EXTI_CLEAR_IT(NRF24_IRQ_Pin);
+        HAL_NVIC_ClearPendingIRQ(NRF24_IRQ_EXTI_IRQn);
+        HAL_NVIC_EnableIRQ(NRF24_IRQ_EXTI_IRQn);
+
+#if RADIO_RX_ENGINE
+        nrf24l01p_rx_engine_resume();
+#else
+        xTaskNotify(xTaskGetCurrentTaskHandle(), RADIO_EVENT_RX_READY, eSetBits);
+#endif
+    }
 }
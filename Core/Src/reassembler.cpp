@@ -0,0 +1,190 @@
+#include "reassembler.h"
+#include <string.h>
+
+#define REASSEMBLY_UNKNOWN      0xFF
+
+Reassembler::Reassembler()
+{
+    memset(this->slots, 0, sizeof(this->slots));
+    memset(this->recent, 0, sizeof(this->recent));
+    memset(&this->stats, 0, sizeof(this->stats));
+    this->handler = NULL;
+    this->context = NULL;
+}
+
+void Reassembler::set_handler(MessageHandler handler, void* context)
+{
+    this->handler = handler;
+    this->context = context;
+}
+
+void Reassembler::feed(uint8_t sender, const uint8_t* payload, length len, uint32_t now_ms)
+{
+    frame_view frame;
+
+    if (sender >= NRF24L01P_PIPE_COUNT || !frame_parse(payload, len, &frame))
+    {
+        this->stats.malformed++;
+        return;
+    }
+    this->stats.fragments++;
+
+    // Retransmitted piece of the message just delivered
+    Recent* recent = &this->recent[sender];
+    if (recent->valid && recent->msg_id == frame.msg_id)
+    {
+        this->stats.duplicates++;
+        return;
+    }
+
+    // Whole message in one packet: no arena, hand the payload over as it is
+    if (frame.index == 0 && frame.last)
+    {
+        this->deliver(sender, frame.type, frame.msg_id, frame.data, frame.data_len);
+        return;
+    }
+
+    // Every fragment but the last is full, so a fragment's offset is fixed by its index
+    if (!frame.last && frame.data_len != FRAME_DATA_LENGTH)
+    {
+        this->stats.malformed++;
+        return;
+    }
+
+    Slot* slot = this->find(sender, frame.msg_id);
+    if (slot == NULL) {
+        slot = this->claim(sender, frame.msg_id, frame.type, now_ms);
+    }
+
+    uint64_t bit = (uint64_t)1 << frame.index;
+    if (slot->have & bit)
+    {
+        this->stats.duplicates++;
+        return;
+    }
+
+    if (frame.last)
+    {
+        // A second, different "last" fragment, or data already stored past it
+        if ((slot->last_index != REASSEMBLY_UNKNOWN && slot->last_index != frame.index) ||
+            (slot->have >> frame.index) > 1)
+        {
+            this->stats.malformed++;
+            return;
+        }
+        slot->last_index = frame.index;
+        slot->last_len = frame.data_len;
+    }
+    else if (slot->last_index != REASSEMBLY_UNKNOWN && frame.index > slot->last_index)
+    {
+        this->stats.malformed++;
+        return;
+    }
+
+    memcpy(&slot->data[frame.index * FRAME_DATA_LENGTH], frame.data, frame.data_len);
+    slot->have |= bit;
+
+    if (slot->last_index == REASSEMBLY_UNKNOWN) {
+        return;
+    }
+
+    uint64_t all = ((uint64_t)1 << (slot->last_index + 1)) - 1;
+    if (slot->have == all)
+    {
+        uint16_t total = slot->last_index * FRAME_DATA_LENGTH + slot->last_len;
+
+        this->deliver(sender, slot->type, slot->msg_id, slot->data, total);
+        slot->used = false;
+    }
+}
+
+void Reassembler::expire(uint32_t now_ms)
+{
+    for (uint8_t i = 0; i < REASSEMBLY_SLOTS; i++)
+    {
+        Slot* slot = &this->slots[i];
+
+        if (slot->used && now_ms - slot->started_ms >= REASSEMBLY_TIMEOUT_MS)
+        {
+            slot->used = false;
+            this->stats.timeouts++;
+        }
+    }
+}
+
+uint8_t Reassembler::pending(void) const
+{
+    uint8_t count = 0;
+
+    for (uint8_t i = 0; i < REASSEMBLY_SLOTS; i++)
+    {
+        count += this->slots[i].used ? 1 : 0;
+    }
+    return count;
+}
+
+const Reassembler::Stats& Reassembler::get_stats(void) const
+{
+    return this->stats;
+}
+
+Reassembler::Slot* Reassembler::find(uint8_t sender, uint8_t msg_id)
+{
+    for (uint8_t i = 0; i < REASSEMBLY_SLOTS; i++)
+    {
+        Slot* slot = &this->slots[i];
+
+        if (slot->used && slot->sender == sender && slot->msg_id == msg_id) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+Reassembler::Slot* Reassembler::claim(uint8_t sender, uint8_t msg_id, uint8_t type, uint32_t now_ms)
+{
+    Slot* slot = NULL;
+
+    for (uint8_t i = 0; i < REASSEMBLY_SLOTS && slot == NULL; i++)
+    {
+        if (!this->slots[i].used) {
+            slot = &this->slots[i];
+        }
+    }
+
+    if (slot == NULL)
+    {
+        // Arena full: the oldest partial message is the least likely to complete
+        slot = &this->slots[0];
+        for (uint8_t i = 1; i < REASSEMBLY_SLOTS; i++)
+        {
+            if ((int32_t)(this->slots[i].started_ms - slot->started_ms) < 0) {
+                slot = &this->slots[i];
+            }
+        }
+        this->stats.evictions++;
+    }
+
+    slot->used = true;
+    slot->sender = sender;
+    slot->msg_id = msg_id;
+    slot->type = type;
+    slot->last_index = REASSEMBLY_UNKNOWN;
+    slot->last_len = 0;
+    slot->have = 0;
+    slot->started_ms = now_ms;
+    return slot;
+}
+
+void Reassembler::deliver(uint8_t sender, uint8_t type, uint8_t msg_id, const uint8_t* data, uint16_t len)
+{
+    this->recent[sender].valid = true;
+    this->recent[sender].msg_id = msg_id;
+
+    this->stats.messages++;
+    this->stats.bytes += len;
+
+    if (this->handler != NULL) {
+        this->handler(sender, type, data, len, this->context);
+    }
+}
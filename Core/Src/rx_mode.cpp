@@ -0,0 +1,104 @@
+#include "rx_mode.h"
+#include <string.h>
+
+RxModeController::RxModeController()
+{
+    this->mode = RX_MODE_IRQ;
+    memset(&this->stats, 0, sizeof(this->stats));
+    this->since = 0;
+    this->window_start = 0;
+    this->window_packets = 0;
+    this->idle_polls = 0;
+}
+
+void RxModeController::start(TickType_t now)
+{
+    this->mode = RX_MODE_IRQ;
+    this->since = now;
+    this->window_start = now;
+    this->window_packets = 0;
+    this->idle_polls = 0;
+}
+
+bool RxModeController::update(uint8_t batch, TickType_t now)
+{
+    TickType_t elapsed = now - this->window_start;
+
+    this->window_packets += batch;
+
+    if (this->mode == RX_MODE_POLL)
+    {
+        this->stats.polls++;
+        this->stats.poll_packets += batch;
+        if (batch == 0) {
+            this->stats.empty_polls++;
+        }
+
+        // Traffic stopped: don't wait for the window to run out
+        this->idle_polls = (batch == 0) ? this->idle_polls + 1 : 0;
+        if (this->idle_polls >= RX_POLL_IDLE_POLLS)
+        {
+            this->set_mode(RX_MODE_IRQ, now);
+            return true;
+        }
+    }
+
+    if (elapsed < pdMS_TO_TICKS(RX_POLL_RATE_WINDOW_MS)) {
+        return false;
+    }
+
+    uint32_t pps = this->window_packets * configTICK_RATE_HZ / elapsed;
+
+    if (this->mode == RX_MODE_IRQ && pps >= RX_POLL_ENTER_PPS)
+    {
+        this->set_mode(RX_MODE_POLL, now);
+        return true;
+    }
+    if (this->mode == RX_MODE_POLL && pps < RX_POLL_EXIT_PPS)
+    {
+        this->set_mode(RX_MODE_IRQ, now);
+        return true;
+    }
+
+    // Same mode: only bank the time and start a new window
+    this->bank_time(now);
+    this->window_start = now;
+    this->window_packets = 0;
+    return false;
+}
+
+void RxModeController::set_mode(Mode mode, TickType_t now)
+{
+    this->bank_time(now);
+    this->window_start = now;
+    this->window_packets = 0;
+    this->idle_polls = 0;
+
+    if (mode != this->mode)
+    {
+        if (mode == RX_MODE_POLL) {
+            this->stats.to_poll++;
+        } else {
+            this->stats.to_irq++;
+        }
+    }
+    this->mode = mode;
+}
+
+RxModeController::Mode RxModeController::get_mode(void) const
+{
+    return this->mode;
+}
+
+const RxModeController::Stats& RxModeController::get_stats(void) const
+{
+    return this->stats;
+}
+
+void RxModeController::bank_time(TickType_t now)
+{
+    uint32_t* ticks = (this->mode == RX_MODE_POLL) ? &this->stats.poll_ticks : &this->stats.irq_ticks;
+
+    *ticks += now - this->since;
+    this->since = now;
+}
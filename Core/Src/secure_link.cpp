@@ -0,0 +1,236 @@
+#include "secure_link.h"
+#include <string.h>
+
+SecureLink::SecureLink()
+{
+    memset(this->pipes, 0, sizeof(this->pipes));
+}
+
+void SecureLink::set_key(uint8_t pipe, const uint8_t* key, const uint8_t* address)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+
+    PipeKey* state = &this->pipes[pipe];
+    memcpy(state->key, key, sizeof(state->key));
+    memcpy(state->address, address, sizeof(state->address));
+    state->keyed = true;
+    state->counter_valid = false;
+    state->challenge_valid = false;
+    state->top = 0;
+    state->seen = 0;
+}
+
+void SecureLink::clear_key(uint8_t pipe)
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return;
+    }
+
+    PipeKey* state = &this->pipes[pipe];
+    memset(state->key, 0, sizeof(state->key));
+    state->keyed = false;
+}
+
+bool SecureLink::is_secure(uint8_t pipe) const
+{
+    return pipe < NRF24L01P_PIPE_COUNT && this->pipes[pipe].keyed;
+}
+
+bool SecureLink::open(nrf24l01p_rx_packet* packet)
+{
+    PipeKey* state = &this->pipes[packet->pipe];
+    Stats* stats = &state->stats;
+    uint32_t start = DWT->CYCCNT;
+
+    if (packet->len < SECURE_OVERHEAD)
+    {
+        stats->malformed++;
+        return false;
+    }
+
+    uint8_t* payload = packet->payload;
+    uint32_t counter = payload[0] | ((uint32_t)payload[1] << 8) |
+                       ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+
+    // The first word from the sender fixes the challenge it has to echo
+    if (!state->counter_valid && !state->challenge_valid) {
+        make_challenge(state, packet->arrival);
+    }
+
+    // Replays are the cheap case: no crypto for a counter we already took
+    if (state->counter_valid && !check_replay(state, counter, false))
+    {
+        stats->replayed++;
+        return false;
+    }
+
+    uint8_t nonce[CHACHAPOLY_NONCE_LENGTH];
+    length text_len = packet->len - SECURE_OVERHEAD;
+    make_nonce(state->address, counter, nonce);
+
+    bool ok = chachapoly_open(state->key, nonce, payload, SECURE_COUNTER_LENGTH,
+                              &payload[SECURE_COUNTER_LENGTH], text_len,
+                              &payload[SECURE_COUNTER_LENGTH + text_len], SECURE_TAG_LENGTH);
+
+    uint32_t cycles = DWT->CYCCNT - start;
+    stats->last_cycles = cycles;
+    if (cycles > stats->max_cycles) {
+        stats->max_cycles = cycles;
+    }
+    stats->total_cycles += cycles;
+    stats->total_bytes += packet->len;
+
+    if (!ok)
+    {
+        stats->forged++;
+        return false;
+    }
+
+    if (!state->counter_valid)
+    {
+        // Only a fresh answer to this boot's challenge may start the window
+        uint8_t* text = &payload[SECURE_COUNTER_LENGTH];
+        uint32_t echo = text[1] | ((uint32_t)text[2] << 8) | ((uint32_t)text[3] << 16) | ((uint32_t)text[4] << 24);
+
+        if (text_len == SECURE_SYNC_LENGTH && text[0] == SECURE_SYNC_TAG && echo == state->challenge)
+        {
+            // Every lower counter was sealed before the challenge existed: none is fresh
+            state->counter_valid = true;
+            state->top = counter;
+            state->seen = ~(uint64_t)0;
+            stats->syncs++;
+        }
+        else
+        {
+            stats->unsynced++;
+        }
+        return false;
+    }
+    check_replay(state, counter, true);
+
+    // Plaintext to the front: handlers see an ordinary payload
+    memmove(payload, &payload[SECURE_COUNTER_LENGTH], text_len);
+    packet->len = text_len;
+
+    stats->accepted++;
+    stats->bytes += text_len;
+    return true;
+}
+
+bool SecureLink::get_sync_request(uint8_t pipe, uint8_t* reply) const
+{
+    if (pipe >= NRF24L01P_PIPE_COUNT) {
+        return false;
+    }
+
+    const PipeKey* state = &this->pipes[pipe];
+    if (!state->keyed || state->counter_valid || !state->challenge_valid) {
+        return false;
+    }
+
+    reply[0] = SECURE_SYNC_TAG;
+    reply[1] = (uint8_t)state->challenge;
+    reply[2] = (uint8_t)(state->challenge >> 8);
+    reply[3] = (uint8_t)(state->challenge >> 16);
+    reply[4] = (uint8_t)(state->challenge >> 24);
+    return true;
+}
+
+const SecureLink::Stats& SecureLink::get_stats(uint8_t pipe) const
+{
+    return this->pipes[pipe < NRF24L01P_PIPE_COUNT ? pipe : 0].stats;
+}
+
+uint32_t SecureLink::get_cycles_per_byte(void) const
+{
+    uint64_t cycles = 0;
+    uint64_t bytes = 0;
+
+    for (uint8_t i = 0; i < NRF24L01P_PIPE_COUNT; i++)
+    {
+        cycles += this->pipes[i].stats.total_cycles;
+        bytes += this->pipes[i].stats.total_bytes;
+    }
+    return (bytes > 0) ? (uint32_t)(cycles / bytes) : 0;
+}
+
+uint32_t SecureLink::benchmark(length len, uint32_t rounds)
+{
+    static const uint8_t key[CHACHAPOLY_KEY_LENGTH] = {0};
+    static const uint8_t address[5] = {0};
+    uint8_t buffer[NRF24L01P_PAYLOAD_LENGTH] = {0};
+    uint8_t tag[CHACHAPOLY_TAG_LENGTH];
+    uint8_t nonce[CHACHAPOLY_NONCE_LENGTH];
+    uint32_t cycles = 0;
+
+    if (len > SECURE_MAX_PLAINTEXT) {
+        len = SECURE_MAX_PLAINTEXT;
+    }
+
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        make_nonce(address, i, nonce);
+        chachapoly_seal(key, nonce, buffer, SECURE_COUNTER_LENGTH, &buffer[SECURE_COUNTER_LENGTH], len, tag);
+
+        uint32_t start = DWT->CYCCNT;
+        chachapoly_open(key, nonce, buffer, SECURE_COUNTER_LENGTH, &buffer[SECURE_COUNTER_LENGTH], len,
+                        tag, SECURE_TAG_LENGTH);
+        cycles += DWT->CYCCNT - start;
+    }
+    return (rounds > 0) ? cycles / rounds : 0;
+}
+
+bool SecureLink::check_replay(PipeKey* pipe, uint32_t counter, bool commit)
+{
+    if (counter > pipe->top)
+    {
+        if (commit)
+        {
+            uint32_t shift = counter - pipe->top;
+            pipe->seen = (shift < SECURE_REPLAY_WINDOW) ? (pipe->seen << shift) | 1 : 1;
+            pipe->top = counter;
+        }
+        return true;
+    }
+
+    uint32_t age = pipe->top - counter;
+    if (age >= SECURE_REPLAY_WINDOW || (pipe->seen & ((uint64_t)1 << age))) {
+        return false;
+    }
+
+    if (commit) {
+        pipe->seen |= (uint64_t)1 << age;
+    }
+    return true;
+}
+
+void SecureLink::make_challenge(PipeKey* pipe, uint32_t arrival)
+{
+    // The tag over nothing is a keyed function of the nonce; bytes 5..7 are 0xFF
+    // where senders' nonces have zeros, so no sealed packet shares it
+    uint8_t nonce[CHACHAPOLY_NONCE_LENGTH];
+    uint8_t tag[CHACHAPOLY_TAG_LENGTH];
+
+    make_nonce(pipe->address, arrival ^ DWT->CYCCNT, nonce);
+    nonce[5] = 0xFF;
+    nonce[6] = 0xFF;
+    nonce[7] = 0xFF;
+    chachapoly_seal(pipe->key, nonce, NULL, 0, NULL, 0, tag);
+
+    pipe->challenge = tag[0] | ((uint32_t)tag[1] << 8) | ((uint32_t)tag[2] << 16) | ((uint32_t)tag[3] << 24);
+    pipe->challenge_valid = true;
+}
+
+void SecureLink::make_nonce(const uint8_t* address, uint32_t counter, uint8_t* nonce)
+{
+    memcpy(nonce, address, 5);
+    nonce[5] = 0;
+    nonce[6] = 0;
+    nonce[7] = 0;
+    nonce[8] = (uint8_t)counter;
+    nonce[9] = (uint8_t)(counter >> 8);
+    nonce[10] = (uint8_t)(counter >> 16);
+    nonce[11] = (uint8_t)(counter >> 24);
+}
@@ -60,6 +60,7 @@ extern DMA_HandleTypeDef hdma_i2c1_tx;
 extern I2C_HandleTypeDef hi2c1;
 extern DMA_HandleTypeDef hdma_spi1_tx;
 extern DMA_HandleTypeDef hdma_spi1_rx;
+extern TIM_HandleTypeDef htim2;
 extern TIM_HandleTypeDef htim11;
 
 /* USER CODE BEGIN EV */
@@ -206,6 +207,20 @@ void TIM1_TRG_COM_TIM11_IRQHandler(void)
   /* USER CODE END TIM1_TRG_COM_TIM11_IRQn 1 */
 }
 
+/**
+  * @brief This function handles TIM2 global interrupt.
+  */
+void TIM2_IRQHandler(void)
+{
+  /* USER CODE BEGIN TIM2_IRQn 0 */
+
+  /* USER CODE END TIM2_IRQn 0 */
+  HAL_TIM_IRQHandler(&htim2);
+  /* USER CODE BEGIN TIM2_IRQn 1 */
+
+  /* USER CODE END TIM2_IRQn 1 */
+}
+
 /**
   * @brief This function handles I2C1 event interrupt.
   */
@@ -274,10 +289,8 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
   if (GPIO_Pin == NRF24_IRQ_Pin) // Check if it's our radio pin (PB1)
   {
     // This is an interrupt from the nRF24
-    // Give the semaphore to wake up the 'radio_task'
-	  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-	  xSemaphoreGiveFromISR(g_radio_irq_sem, &xHigherPriorityTaskWoken);
-	  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    // Notify the 'radio_task' directly (RADIO_EVENT_RX_READY)
+    radio_irq_callback();
   }
 }
 /* USER CODE END 1 */
@@ -7,6 +7,12 @@
 
 #include "ui_feedback.h"
 
+// LED on-time of UI_Blink_Pulse()
+#define UI_PULSE_MS 50
+
+static TickType_t pulse_start;
+static bool pulse_active;
+
 /**
  * @brief Turns on the LED for feedback (blink start).
  */
@@ -48,3 +54,27 @@ void UI_Blink_Triple(void)
 	vTaskDelay(pdMS_TO_TICKS(50));
 
 }
+
+/**
+ * @brief Turns the LED on without blocking; UI_Blink_Service() turns it off.
+ */
+void UI_Blink_Pulse(void)
+{
+	UI_Blink_Start();
+	pulse_start = xTaskGetTickCount();
+	pulse_active = true;
+}
+
+/**
+ * @brief Ends a UI_Blink_Pulse() once UI_PULSE_MS have passed.
+ * @return true while the pulse is still lit.
+ */
+bool UI_Blink_Service(void)
+{
+	if (pulse_active && xTaskGetTickCount() - pulse_start >= pdMS_TO_TICKS(UI_PULSE_MS))
+	{
+		UI_Blink_End();
+		pulse_active = false;
+	}
+	return pulse_active;
+}
@@ -0,0 +1,133 @@
+/*
+ * us_timer.c
+ *
+ * Microsecond alarms on the compare channels of TIM2 (1 MHz, free-running):
+ * sub-tick deadlines without spinning on DWT.
+ * CC1 - us_timer_alarm() (one task), CC2 - us_timer_sleep() (one sleeper at a time).
+ */
+
+#include "us_timer.h"
+#include "tim.h"
+
+static TaskHandle_t alarm_task;
+static uint32_t alarm_bits;
+static TaskHandle_t sleep_task;
+
+/**
+ * @brief Arms a compare interrupt for `at`.
+ * @note The check after enabling catches a match that went by while CCR was set;
+ *       TIM2 shares the RTOS-managed priority, so the critical section keeps the
+ *       callback out until the channel is either armed or given up.
+ * @return false if `at` has already passed (nothing armed).
+ */
+static bool us_timer_arm(uint32_t channel, uint32_t it, uint32_t at)
+{
+	bool armed = true;
+
+	taskENTER_CRITICAL();
+	__HAL_TIM_DISABLE_IT(&htim2, it);
+	__HAL_TIM_SET_COMPARE(&htim2, channel, at);
+	__HAL_TIM_CLEAR_FLAG(&htim2, it);
+	__HAL_TIM_ENABLE_IT(&htim2, it);
+
+	if ((int32_t)(at - us_timer_now()) <= 0)
+	{
+		__HAL_TIM_DISABLE_IT(&htim2, it);
+		__HAL_TIM_CLEAR_FLAG(&htim2, it);
+		armed = false;
+	}
+	taskEXIT_CRITICAL();
+
+	return armed;
+}
+
+uint32_t us_timer_now(void)
+{
+	return __HAL_TIM_GET_COUNTER(&htim2);
+}
+
+void us_timer_alarm(TaskHandle_t task, uint32_t bits, uint32_t at)
+{
+	alarm_task = task;
+	alarm_bits = bits;
+
+	if (!us_timer_arm(TIM_CHANNEL_1, TIM_IT_CC1, at)) {
+		xTaskNotify(task, bits, eSetBits);
+	}
+}
+
+void us_timer_cancel_alarm(void)
+{
+	__HAL_TIM_DISABLE_IT(&htim2, TIM_IT_CC1);
+}
+
+void us_timer_sleep(uint32_t us)
+{
+	uint32_t at = us_timer_now() + us;
+
+	if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+	{
+		while ((int32_t)(at - us_timer_now()) > 0) {
+		}
+		return;
+	}
+
+	sleep_task = xTaskGetCurrentTaskHandle();
+	if (!us_timer_arm(TIM_CHANNEL_2, TIM_IT_CC2, at))
+	{
+		sleep_task = NULL;
+		return;
+	}
+
+	// A tick more than the sleep: a stopped timer cannot hang the caller
+	TickType_t ticks = pdMS_TO_TICKS(us / 1000U) + 2;
+	TickType_t start = xTaskGetTickCount();
+	bool foreign = false;
+
+	for (;;)
+	{
+		uint32_t value = 0;
+		TickType_t elapsed = xTaskGetTickCount() - start;
+
+		if (elapsed >= ticks || xTaskNotifyWait(0, US_TIMER_NOTIFY_SLEEP, &value, ticks - elapsed) != pdTRUE) {
+			break;
+		}
+		foreign |= (value & ~US_TIMER_NOTIFY_SLEEP) != 0;
+		if (value & US_TIMER_NOTIFY_SLEEP) {
+			break;
+		}
+	}
+
+	__HAL_TIM_DISABLE_IT(&htim2, TIM_IT_CC2);
+	sleep_task = NULL;
+
+	// Returning from the wait cleared the pending state; re-arm it for bits we did not own
+	if (foreign) {
+		xTaskNotify(xTaskGetCurrentTaskHandle(), 0, eSetBits);
+	}
+}
+
+void us_timer_oc_callback(TIM_HandleTypeDef *htim)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	if (htim->Instance != TIM2) {
+		return;
+	}
+
+	if (htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1)
+	{
+		// One-shot: the free-running counter would match again in 71 minutes
+		__HAL_TIM_DISABLE_IT(htim, TIM_IT_CC1);
+		xTaskNotifyFromISR(alarm_task, alarm_bits, eSetBits, &xHigherPriorityTaskWoken);
+	}
+	else if (htim->Channel == HAL_TIM_ACTIVE_CHANNEL_2)
+	{
+		__HAL_TIM_DISABLE_IT(htim, TIM_IT_CC2);
+		if (sleep_task != NULL) {
+			xTaskNotifyFromISR(sleep_task, US_TIMER_NOTIFY_SLEEP, eSetBits, &xHigherPriorityTaskWoken);
+		}
+	}
+
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
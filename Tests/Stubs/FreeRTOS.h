@@ -0,0 +1,38 @@
+/*
+ *  FreeRTOS.h (host stub)
+ *
+ *  Types and macros of the FreeRTOS port, for one simulated task on a host
+ *  (Support/host.cpp). Critical sections are no-ops: host tests either run
+ *  single-threaded or only share lock-free structures between threads.
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+#include <assert.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                         ((BaseType_t)0)
+#define pdTRUE                          ((BaseType_t)1)
+#define pdPASS                          pdTRUE
+#define pdFAIL                          pdFALSE
+#define portMAX_DELAY                   ((TickType_t)0xFFFFFFFFUL)
+
+#define configTICK_RATE_HZ              ((TickType_t)1000)
+#define portTICK_PERIOD_MS              ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs)        ((TickType_t)(((TickType_t)(xTimeInMs) * configTICK_RATE_HZ) / (TickType_t)1000U))
+
+#define configASSERT(x)                 assert(x)
+
+#define portYIELD_FROM_ISR(x)           ((void)(x))
+#define taskYIELD()                     ((void)0)
+#define taskENTER_CRITICAL()            ((void)0)
+#define taskEXIT_CRITICAL()             ((void)0)
+#define taskENTER_CRITICAL_FROM_ISR()   ((UBaseType_t)0)
+#define taskEXIT_CRITICAL_FROM_ISR(x)   ((void)(x))
+
+#endif /* INC_FREERTOS_H */
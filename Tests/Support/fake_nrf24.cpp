@@ -0,0 +1,244 @@
+#include "fake_nrf24.h"
+#include "nrf24l01p.h"
+#include <string.h>
+
+#define FAKE_FIFO_DEPTH     3
+
+FakeNrf24::FakeNrf24()
+{
+    memset(&this->counters, 0, sizeof(this->counters));
+    memset(this->regs, 0, sizeof(this->regs));
+
+    // Reset values (datasheet, section 9)
+    this->regs[NRF24L01P_REG_CONFIG] = 0x08;
+    this->regs[NRF24L01P_REG_EN_AA] = 0x3F;
+    this->regs[NRF24L01P_REG_EN_RXADDR] = 0x03;
+    this->regs[NRF24L01P_REG_SETUP_AW] = 0x03;
+    this->regs[NRF24L01P_REG_SETUP_RETR] = 0x03;
+    this->regs[NRF24L01P_REG_RF_CH] = 0x02;
+    this->regs[NRF24L01P_REG_RF_SETUP] = 0x0E;
+    this->regs[NRF24L01P_REG_RX_ADDR_P2] = 0xC3;
+    this->regs[NRF24L01P_REG_RX_ADDR_P3] = 0xC4;
+    this->regs[NRF24L01P_REG_RX_ADDR_P4] = 0xC5;
+    this->regs[NRF24L01P_REG_RX_ADDR_P5] = 0xC6;
+    memset(this->rx_addr[0], 0xE7, 5);
+    memset(this->rx_addr[1], 0xC2, 5);
+    memset(this->tx_addr, 0xE7, 5);
+
+    this->stuck_reg = -1;
+    this->stuck_value = 0;
+}
+
+void FakeNrf24::spi(void* context, const uint8_t* tx, uint8_t* rx, uint16_t len)
+{
+    static_cast<FakeNrf24*>(context)->clock(tx, rx, len);
+}
+
+uint8_t FakeNrf24::status() const
+{
+    uint8_t pipe = this->rx_fifo.empty() ? NRF24L01P_RX_P_NO_EMPTY : this->rx_fifo.front().pipe;
+
+    return (uint8_t)((this->regs[NRF24L01P_REG_STATUS] & 0x70) | (pipe << 1) |
+                     (this->tx_fifo.size() >= FAKE_FIFO_DEPTH ? 0x01 : 0x00));
+}
+
+uint8_t FakeNrf24::fifo_status() const
+{
+    uint8_t value = 0;
+
+    if (this->tx_fifo.size() >= FAKE_FIFO_DEPTH) {
+        value |= NRF24L01P_FIFO_STATUS_TX_FULL;
+    }
+    if (this->tx_fifo.empty()) {
+        value |= NRF24L01P_FIFO_STATUS_TX_EMPTY;
+    }
+    if (this->rx_fifo.size() >= FAKE_FIFO_DEPTH) {
+        value |= NRF24L01P_FIFO_STATUS_RX_FULL;
+    }
+    if (this->rx_fifo.empty()) {
+        value |= NRF24L01P_FIFO_STATUS_RX_EMPTY;
+    }
+    return value;
+}
+
+bool FakeNrf24::irq() const
+{
+    // CONFIG MASK_* bits sit where STATUS keeps the matching flags
+    return (this->regs[NRF24L01P_REG_STATUS] & 0x70 & ~this->regs[NRF24L01P_REG_CONFIG]) != 0;
+}
+
+uint8_t FakeNrf24::reg(uint8_t address) const
+{
+    return this->read(address);
+}
+
+void FakeNrf24::set_reg(uint8_t address, uint8_t value)
+{
+    this->regs[address & 0x1F] = value;
+}
+
+void FakeNrf24::stick(uint8_t address, uint8_t value)
+{
+    this->stuck_reg = address;
+    this->stuck_value = value;
+}
+
+uint8_t FakeNrf24::read(uint8_t address) const
+{
+    if (address == this->stuck_reg) {
+        return this->stuck_value;
+    }
+
+    switch (address)
+    {
+        case NRF24L01P_REG_STATUS:
+            return this->status();
+        case NRF24L01P_REG_FIFO_STATUS:
+            return this->fifo_status();
+        default:
+            return this->regs[address & 0x1F];
+    }
+}
+
+void FakeNrf24::write(uint8_t address, const uint8_t* data, uint16_t len)
+{
+    if (len == 0 || address == this->stuck_reg) {
+        return;
+    }
+
+    switch (address)
+    {
+        case NRF24L01P_REG_STATUS:
+            // Interrupt flags clear by writing 1
+            if (data[0] & NRF24L01P_STATUS_RX_DR) {
+                this->counters.status_clears++;
+            }
+            this->regs[address] &= ~(data[0] & 0x70);
+            break;
+        case NRF24L01P_REG_RX_ADDR_P0:
+        case NRF24L01P_REG_RX_ADDR_P1:
+            memcpy(this->rx_addr[address - NRF24L01P_REG_RX_ADDR_P0], data, len > 5 ? 5 : len);
+            this->regs[address] = data[0];
+            break;
+        case NRF24L01P_REG_TX_ADDR:
+            memcpy(this->tx_addr, data, len > 5 ? 5 : len);
+            this->regs[address] = data[0];
+            break;
+        case NRF24L01P_REG_RPD:
+        case NRF24L01P_REG_FIFO_STATUS:
+        case NRF24L01P_REG_OBSERVE_TX:
+            break;                  // Read-only
+        default:
+            this->regs[address & 0x1F] = data[0];
+            break;
+    }
+}
+
+void FakeNrf24::clock(const uint8_t* tx, uint8_t* rx, uint16_t len)
+{
+    uint8_t command = tx[0];
+
+    this->counters.frames++;
+    this->counters.bytes += len;
+    memset(rx, 0, len);
+    rx[0] = this->status();
+
+    if ((command & 0xE0) == NRF24L01P_CMD_R_REGISTER)
+    {
+        uint8_t address = command & 0x1F;
+
+        this->counters.register_reads++;
+        if (address == NRF24L01P_REG_RX_ADDR_P0 || address == NRF24L01P_REG_RX_ADDR_P1) {
+            memcpy(&rx[1], this->rx_addr[address - NRF24L01P_REG_RX_ADDR_P0], len > 6 ? 5 : len - 1);
+        } else if (address == NRF24L01P_REG_TX_ADDR) {
+            memcpy(&rx[1], this->tx_addr, len > 6 ? 5 : len - 1);
+        } else if (len > 1) {
+            rx[1] = this->read(address);
+        }
+        return;
+    }
+
+    if ((command & 0xE0) == NRF24L01P_CMD_W_REGISTER)
+    {
+        this->counters.register_writes++;
+        this->write(command & 0x1F, &tx[1], (uint16_t)(len - 1));
+        return;
+    }
+
+    if ((command & 0xF8) == NRF24L01P_CMD_W_ACK_PAYLOAD)
+    {
+        this->counters.ack_writes++;
+        if (this->tx_fifo.size() < FAKE_FIFO_DEPTH) {
+            this->tx_fifo.push_back({(uint8_t)(command & 0x07), std::vector<uint8_t>(&tx[1], &tx[len])});
+        }
+        return;
+    }
+
+    switch (command)
+    {
+        case NRF24L01P_CMD_R_RX_PL_WID:
+            this->counters.width_reads++;
+            if (len > 1 && !this->rx_fifo.empty()) {
+                rx[1] = (uint8_t)this->rx_fifo.front().data.size();
+            }
+            break;
+
+        case NRF24L01P_CMD_R_RX_PAYLOAD:
+            this->counters.payload_reads++;
+            if (!this->rx_fifo.empty())
+            {
+                const std::vector<uint8_t>& data = this->rx_fifo.front().data;
+                memcpy(&rx[1], data.data(), data.size() < (size_t)(len - 1) ? data.size() : (size_t)(len - 1));
+                this->rx_fifo.pop_front();
+            }
+            break;
+
+        case NRF24L01P_CMD_W_TX_PAYLOAD:
+        case NRF24L01P_CMD_W_TX_PAYLOAD_NOACK:
+            if (this->tx_fifo.size() < FAKE_FIFO_DEPTH) {
+                this->tx_fifo.push_back({0, std::vector<uint8_t>(&tx[1], &tx[len])});
+            }
+            break;
+
+        case NRF24L01P_CMD_FLUSH_RX:
+            this->counters.flush_rx++;
+            this->rx_fifo.clear();
+            break;
+
+        case NRF24L01P_CMD_FLUSH_TX:
+            this->counters.flush_tx++;
+            this->tx_fifo.clear();
+            break;
+
+        default:                    // NOP, REUSE_TX_PL
+            break;
+    }
+}
+
+bool FakeNrf24::receive(uint8_t pipe, const uint8_t* data, uint8_t len, bool rpd)
+{
+    if (this->rx_fifo.size() >= FAKE_FIFO_DEPTH)
+    {
+        this->counters.lost++;
+        return false;
+    }
+
+    this->rx_fifo.push_back({pipe, std::vector<uint8_t>(data, data + len)});
+    this->regs[NRF24L01P_REG_STATUS] |= NRF24L01P_STATUS_RX_DR;
+    this->regs[NRF24L01P_REG_RPD] = rpd ? 1 : 0;
+
+    if (this->regs[NRF24L01P_REG_EN_AA] & (1 << pipe))
+    {
+        for (std::deque<Payload>::iterator it = this->tx_fifo.begin(); it != this->tx_fifo.end(); ++it)
+        {
+            if (it->pipe == pipe)
+            {
+                this->acks_sent.push_back(*it);
+                this->tx_fifo.erase(it);
+                this->regs[NRF24L01P_REG_STATUS] |= NRF24L01P_STATUS_TX_DS;
+                break;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <deque>
+#include <vector>
+
+/**
+ * @brief Register-level nRF24L01+ for the host SPI bus: registers, the 3-deep
+ *        RX and TX FIFOs, STATUS/FIFO_STATUS and the SPI commands.
+ * @note Packets "arrive" through receive(); with auto-ack on the pipe the
+ *       chip sends the oldest ACK payload queued for it, as the silicon does.
+ */
+class FakeNrf24
+{
+public:
+    struct Counters
+    {
+        uint32_t frames;            // CS windows clocked
+        uint32_t bytes;
+        uint32_t register_reads;
+        uint32_t register_writes;
+        uint32_t status_clears;     // W_REGISTER STATUS with RX_DR set
+        uint32_t width_reads;       // R_RX_PL_WID
+        uint32_t payload_reads;     // R_RX_PAYLOAD
+        uint32_t flush_rx;
+        uint32_t flush_tx;
+        uint32_t ack_writes;        // W_ACK_PAYLOAD
+        uint32_t lost;              // Packets that found the RX FIFO full
+    };
+
+    struct Payload
+    {
+        uint8_t pipe;
+        std::vector<uint8_t> data;
+    };
+
+    FakeNrf24();
+
+    /**
+     * @brief host_spi_device entry: context is the FakeNrf24.
+     */
+    static void spi(void* context, const uint8_t* tx, uint8_t* rx, uint16_t len);
+
+    void clock(const uint8_t* tx, uint8_t* rx, uint16_t len);
+
+    /**
+     * @brief A packet on the air for pipe.
+     * @return False if it was lost to a full RX FIFO (not acknowledged either).
+     */
+    bool receive(uint8_t pipe, const uint8_t* data, uint8_t len, bool rpd = true);
+
+    /**
+     * @brief Level of the IRQ line (true = asserted, pin low).
+     */
+    bool irq() const;
+
+    uint8_t status() const;
+    uint8_t fifo_status() const;
+    uint8_t reg(uint8_t address) const;
+    void set_reg(uint8_t address, uint8_t value);
+
+    /**
+     * @brief The register ignores writes and reads value (a broken chip).
+     */
+    void stick(uint8_t address, uint8_t value);
+
+    size_t rx_count() const { return this->rx_fifo.size(); }
+    size_t tx_count() const { return this->tx_fifo.size(); }
+
+    const uint8_t* rx_address(uint8_t pipe) const { return this->rx_addr[pipe]; }
+    const uint8_t* tx_address() const { return this->tx_addr; }
+
+    Counters counters;
+    std::vector<Payload> acks_sent;     // ACK payloads that went on the air, oldest first
+
+private:
+    uint8_t read(uint8_t address) const;
+    void write(uint8_t address, const uint8_t* data, uint16_t len);
+
+    uint8_t regs[0x20];
+    uint8_t rx_addr[2][5];
+    uint8_t tx_addr[5];
+    int16_t stuck_reg;
+    uint8_t stuck_value;
+    std::deque<Payload> rx_fifo;
+    std::deque<Payload> tx_fifo;
+};
@@ -0,0 +1,334 @@
+#include "host.h"
+#include "spi.h"
+#include "host_test.h"
+#include <string.h>
+#include <sys/mman.h>
+
+GPIO_TypeDef host_gpioa, host_gpiob, host_gpioc;
+DWT_Type host_dwt;
+CoreDebug_Type host_coredebug;
+uint32_t SystemCoreClock = 100000000;
+
+SPI_HandleTypeDef hspi1;
+int host_test_failures = 0;
+
+static int host_task;               // Address stands in for the one task handle
+
+static struct
+{
+    TickType_t tick;
+    bool running;
+    uint32_t value;
+    bool pending;
+    void (*block_hook)(void*);
+    void* block_context;
+} rtos;
+
+static struct
+{
+    host_spi_device device;
+    void* context;
+    void (*cplt)(SPI_HandleTypeDef*);
+    void (*error)(SPI_HandleTypeDef*);
+    SPI_HandleTypeDef* hspi;
+    const uint8_t* tx;
+    uint8_t* rx;
+    uint16_t len;
+    bool pending;
+    bool stalled;
+    bool cs_low;
+    bool cs_used;
+    host_spi_stats stats;
+} bus;
+
+/**
+ * @brief Memory behind GPIOA..GPIOC_BASE, so GpioPin's BSRR stores (g_nrf24 and
+ *        the nrf24l01p_* C API) land somewhere on the host.
+ */
+static void map_gpio_ports(void)
+{
+    static bool mapped = false;
+
+    if (!mapped)
+    {
+        void* page = mmap((void*)GPIOA_BASE, 0x1000, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+        CHECK(page == (void*)GPIOA_BASE);
+        mapped = true;
+    }
+}
+
+void host_reset(void)
+{
+    map_gpio_ports();
+    memset(&rtos, 0, sizeof(rtos));
+    memset(&bus, 0, sizeof(bus));
+    rtos.running = true;
+    host_dwt.CYCCNT = 0;
+}
+
+void host_set_scheduler_running(bool running)
+{
+    rtos.running = running;
+}
+
+void host_advance_ticks(TickType_t ticks)
+{
+    rtos.tick += ticks;
+    host_dwt.CYCCNT += ticks * (SystemCoreClock / configTICK_RATE_HZ);
+}
+
+void host_advance_us(uint32_t us)
+{
+    host_dwt.CYCCNT += us * (SystemCoreClock / 1000000);
+}
+
+void host_on_block(void (*hook)(void* context), void* context)
+{
+    rtos.block_hook = hook;
+    rtos.block_context = context;
+}
+
+void host_spi_attach(host_spi_device device, void* context)
+{
+    bus.device = device;
+    bus.context = context;
+}
+
+void host_spi_on_complete(void (*cplt)(SPI_HandleTypeDef* hspi), void (*error)(SPI_HandleTypeDef* hspi))
+{
+    bus.cplt = cplt;
+    bus.error = error;
+}
+
+bool host_spi_dma_pending(void)
+{
+    return bus.pending;
+}
+
+void host_spi_stall(bool stalled)
+{
+    bus.stalled = stalled;
+}
+
+const host_spi_stats* host_spi_get_stats(void)
+{
+    return &bus.stats;
+}
+
+static void clock_frame(const uint8_t* tx, uint8_t* rx, uint16_t len)
+{
+    if (!bus.cs_low) {
+        bus.stats.outside_cs++;
+    } else if (bus.cs_used) {
+        bus.stats.split_windows++;
+    }
+    bus.cs_used = true;
+
+    if (bus.device != NULL) {
+        bus.device(bus.context, tx, rx, len);
+    } else {
+        memset(rx, 0xFF, len);
+    }
+}
+
+void host_spi_complete_dma(bool fail)
+{
+    if (!bus.pending) {
+        return;
+    }
+    bus.pending = false;
+
+    if (fail)
+    {
+        if (bus.error != NULL) {
+            bus.error(bus.hspi);
+        }
+        return;
+    }
+
+    clock_frame(bus.tx, bus.rx, bus.len);
+    if (bus.cplt != NULL) {
+        bus.cplt(bus.hspi);
+    }
+}
+
+uint32_t host_spi_run_dma(void)
+{
+    uint32_t transfers = 0;
+
+    while (bus.pending)
+    {
+        host_spi_complete_dma(false);
+        transfers++;
+    }
+    return transfers;
+}
+
+void HostCsPin::set()
+{
+    bus.cs_low = false;
+}
+
+void HostCsPin::reset()
+{
+    if (!bus.cs_low) {
+        bus.stats.cs_windows++;
+    }
+    bus.cs_low = true;
+    bus.cs_used = false;
+}
+
+extern "C" {
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData,
+                                          uint16_t Size, uint32_t Timeout)
+{
+    if (bus.pending) {
+        return HAL_BUSY;
+    }
+    bus.stats.blocking++;
+    clock_frame(pTxData, pRxData, Size);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData,
+                                              uint16_t Size)
+{
+    if (bus.pending) {
+        return HAL_BUSY;
+    }
+    bus.stats.dma++;
+    bus.hspi = hspi;
+    bus.tx = pTxData;
+    bus.rx = pRxData;
+    bus.len = Size;
+    bus.pending = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef* hspi)
+{
+    bus.stats.aborts++;
+    bus.pending = false;
+    return HAL_OK;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+    return (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET) {
+        GPIOx->ODR |= GPIO_Pin;
+    } else {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin)
+{
+    GPIOx->ODR ^= GPIO_Pin;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+}
+
+void Error_Handler(void)
+{
+    abort();
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return rtos.tick;
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+    return rtos.tick;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return rtos.running ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &host_task;
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+    host_advance_ticks(xTicksToDelay);
+}
+
+BaseType_t xTaskNotify(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction)
+{
+    if (eAction == eSetBits) {
+        rtos.value |= ulValue;
+    } else if (eAction == eIncrement) {
+        rtos.value++;
+    } else if (eAction != eNoAction) {
+        rtos.value = ulValue;
+    }
+    rtos.pending = true;
+    return pdPASS;
+}
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction,
+                              BaseType_t* pxHigherPriorityTaskWoken)
+{
+    if (pxHigherPriorityTaskWoken != NULL) {
+        *pxHigherPriorityTaskWoken = pdTRUE;
+    }
+    return xTaskNotify(xTaskToNotify, ulValue, eAction);
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit,
+                           uint32_t* pulNotificationValue, TickType_t xTicksToWait)
+{
+    if (!rtos.pending)
+    {
+        rtos.value &= ~ulBitsToClearOnEntry;
+
+        // The task sleeps: interrupts happen now
+        if (xTicksToWait > 0)
+        {
+            if (rtos.block_hook != NULL) {
+                rtos.block_hook(rtos.block_context);
+            }
+            if (!rtos.pending && bus.pending && !bus.stalled) {
+                host_spi_complete_dma(false);
+            }
+        }
+
+        if (!rtos.pending)
+        {
+            if (xTicksToWait != portMAX_DELAY) {
+                host_advance_ticks(xTicksToWait);
+            }
+            if (pulNotificationValue != NULL) {
+                *pulNotificationValue = rtos.value;
+            }
+            return pdFALSE;
+        }
+    }
+
+    if (pulNotificationValue != NULL) {
+        *pulNotificationValue = rtos.value;
+    }
+    rtos.value &= ~ulBitsToClearOnExit;
+    rtos.pending = false;
+    return pdTRUE;
+}
+
+} // extern "C"
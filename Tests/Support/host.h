@@ -0,0 +1,100 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "main.h"
+
+/*
+ * Host model behind the HAL/FreeRTOS stubs: one task, a tick counter and the
+ * DWT cycle counter advanced together, and one SPI bus whose DMA transfers
+ * complete "while the task sleeps" in xTaskNotifyWait, the way they do on
+ * the board.
+ */
+
+/**
+ * @brief SPI device on the simulated bus: one call per CS window (one frame).
+ */
+typedef void (*host_spi_device)(void* context, const uint8_t* tx, uint8_t* rx, uint16_t len);
+
+typedef struct
+{
+    uint32_t blocking;              // HAL_SPI_TransmitReceive calls
+    uint32_t dma;                   // HAL_SPI_TransmitReceive_DMA calls
+    uint32_t aborts;                // HAL_SPI_Abort calls
+    uint32_t cs_windows;            // CSN low periods
+    uint32_t split_windows;         // Frames clocked into a CS window that already had one
+    uint32_t outside_cs;            // Frames clocked with CSN high
+} host_spi_stats;
+
+/**
+ * @brief Back to tick 0: no notifications, no SPI device, scheduler running.
+ * @note Also backs the GPIO port addresses, so the nrf24l01p_* C API runs on the bus.
+ */
+void host_reset(void);
+
+void host_set_scheduler_running(bool running);
+
+/**
+ * @brief Moves the tick count (and DWT->CYCCNT at SystemCoreClock).
+ */
+void host_advance_ticks(TickType_t ticks);
+
+/**
+ * @brief Moves DWT->CYCCNT alone, for code timed in cycles.
+ */
+void host_advance_us(uint32_t us);
+
+/**
+ * @brief Something that happens while the task blocks (a radio IRQ, a timer...).
+ * @note Runs before a pending DMA transfer is completed; NULL removes it.
+ */
+void host_on_block(void (*hook)(void* context), void* context);
+
+void host_spi_attach(host_spi_device device, void* context);
+void host_spi_on_complete(void (*cplt)(SPI_HandleTypeDef* hspi), void (*error)(SPI_HandleTypeDef* hspi));
+
+/**
+ * @brief True while a DMA transfer is in flight.
+ */
+bool host_spi_dma_pending(void);
+
+/**
+ * @brief Completes the transfer in flight (and runs the callback, which may start the next).
+ * @param fail Complete with HAL_SPI_ErrorCallback instead.
+ */
+void host_spi_complete_dma(bool fail);
+
+/**
+ * @brief Completes transfers until the bus is idle (a whole receive engine chain).
+ * @return Transfers completed.
+ */
+uint32_t host_spi_run_dma(void);
+
+/**
+ * @brief A stalled DMA never completes on its own (tests the timeout paths).
+ */
+void host_spi_stall(bool stalled);
+
+const host_spi_stats* host_spi_get_stats(void);
+
+#ifdef __cplusplus
+
+/**
+ * @brief CSN of the simulated bus: counts windows for host_spi_stats.
+ */
+struct HostCsPin
+{
+    static void set();
+    static void reset();
+};
+
+/**
+ * @brief Pin with no side effects (CE).
+ */
+struct HostPin
+{
+    static void set() {}
+    static void reset() {}
+};
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * CHECK() records a failure and carries on, so one run reports every broken
+ * expectation; main() ends with return host_test_result().
+ */
+extern int host_test_failures;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++;                                                   \
+        }                                                                           \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                              \
+    do {                                                                            \
+        long long _a = (long long)(a), _b = (long long)(b);                         \
+        if (_a != _b) {                                                             \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",       \
+                    __FILE__, __LINE__, #a, #b, _a, _b);                            \
+            host_test_failures++;                                                   \
+        }                                                                           \
+    } while (0)
+
+static inline int host_test_result(void)
+{
+    if (host_test_failures > 0) {
+        fprintf(stderr, "%d check(s) failed\n", host_test_failures);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
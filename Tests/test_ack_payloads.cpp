@@ -0,0 +1,222 @@
+/*
+ * ACK-payload queues over the simulated TX FIFO: one payload per pipe loaded,
+ * replies popped only by an auto-ack that took them, generated payloads behind
+ * queued replies, the age flush with parking, and FEC suspension.
+ */
+#include "ack_payloads.h"
+#include "fake_nrf24.h"
+#include "host.h"
+#include "host_test.h"
+#include <string.h>
+
+static uint8_t g_generated_pipe = 0xFF;     // Pipe with a generated payload (bulk status)
+
+static length generator(uint8_t pipe, uint8_t* out, void* context)
+{
+    if (pipe != g_generated_pipe) {
+        return 0;
+    }
+    out[0] = 0xB5;
+    out[1] = pipe;
+    return 2;
+}
+
+static void setup(FakeNrf24& fake, AckPayloads& acks)
+{
+    host_reset();
+    host_spi_attach(FakeNrf24::spi, &fake);
+    g_generated_pipe = 0xFF;
+
+    acks.set_generator(generator, NULL);
+    for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++) {
+        acks.set_pipe_enabled(pipe, true);
+    }
+}
+
+/**
+ * @brief A packet on pipe: the fake sends its oldest ACK payload, RadioTask sees it.
+ */
+static void hear(FakeNrf24& fake, AckPayloads& acks, uint8_t pipe)
+{
+    static const uint8_t data[4] = {1, 2, 3, 4};
+
+    host_advance_us(100);
+    CHECK(fake.receive(pipe, data, sizeof(data)));
+    nrf24l01p_flush_rx_fifo();
+    acks.on_packet(pipe, DWT->CYCCNT);
+}
+
+static bool sent(const FakeNrf24& fake, size_t index, uint8_t pipe, uint8_t first)
+{
+    return index < fake.acks_sent.size() && fake.acks_sent[index].pipe == pipe &&
+           fake.acks_sent[index].data[0] == first;
+}
+
+static void test_one_loaded_per_pipe()
+{
+    FakeNrf24 fake;
+    AckPayloads acks;
+    setup(fake, acks);
+
+    uint8_t reply[3] = {0, 0, 0};
+    acks.set_pipe_enabled(2, false);
+    CHECK(!acks.queue(2, reply, sizeof(reply)));
+    CHECK(!acks.queue(1, reply, 0));
+
+    for (uint8_t i = 0; i < ACK_QUEUE_DEPTH; i++)
+    {
+        reply[0] = (uint8_t)(10 + i);
+        CHECK(acks.queue(1, reply, sizeof(reply)));
+    }
+    CHECK(!acks.queue(1, reply, sizeof(reply)));
+
+    // Only the head goes into the FIFO; the rest follow one auto-ack at a time
+    acks.refill();
+    CHECK_EQ(fake.tx_count(), 1);
+    CHECK(acks.is_loaded(1));
+
+    for (uint8_t i = 0; i < ACK_QUEUE_DEPTH; i++)
+    {
+        hear(fake, acks, 1);
+        CHECK(sent(fake, i, 1, (uint8_t)(10 + i)));
+        acks.refill();
+    }
+    CHECK_EQ(fake.tx_count(), 0);
+    CHECK_EQ(acks.get_stats().replies, ACK_QUEUE_DEPTH);
+    CHECK(acks.queue(1, reply, sizeof(reply)));
+}
+
+static void test_arrival_before_load()
+{
+    FakeNrf24 fake;
+    AckPayloads acks;
+    setup(fake, acks);
+
+    uint8_t reply[1] = {42};
+    CHECK(acks.queue(0, reply, sizeof(reply)));
+    uint32_t earlier = DWT->CYCCNT;
+    host_advance_us(10);
+    acks.refill();
+
+    // A packet that arrived before the write was acknowledged without it
+    acks.on_packet(0, earlier);
+    CHECK(acks.is_loaded(0));
+    CHECK_EQ(acks.get_stats().replies, 0);
+
+    hear(fake, acks, 0);
+    CHECK(sent(fake, 0, 0, 42));
+    CHECK(!acks.is_loaded(0));
+    CHECK_EQ(acks.get_stats().replies, 1);
+}
+
+static void test_generated_behind_queued()
+{
+    FakeNrf24 fake;
+    AckPayloads acks;
+    setup(fake, acks);
+    g_generated_pipe = 3;
+
+    uint8_t reply[1] = {7};
+    CHECK(acks.queue(3, reply, sizeof(reply)));
+    acks.refill();
+    hear(fake, acks, 3);
+    acks.refill();
+    hear(fake, acks, 3);
+    acks.refill();
+
+    // The queued reply first; the generated payload is reloaded after every auto-ack
+    CHECK(sent(fake, 0, 3, 7));
+    CHECK(sent(fake, 1, 3, 0xB5));
+    CHECK(acks.is_loaded(3));
+    CHECK_EQ(fake.tx_count(), 1);
+}
+
+static void test_age_flush()
+{
+    FakeNrf24 fake;
+    AckPayloads acks;
+    setup(fake, acks);
+
+    uint8_t reply[1];
+    for (uint8_t pipe = 0; pipe < 3; pipe++)
+    {
+        reply[0] = pipe;
+        CHECK(acks.queue(pipe, reply, sizeof(reply)));
+    }
+    acks.refill();
+    CHECK_EQ(fake.tx_count(), 3);
+
+    // Pipe 3 waits behind three silent senders; their payloads are not old yet
+    reply[0] = 3;
+    CHECK(acks.queue(3, reply, sizeof(reply)));
+    acks.refill();
+    CHECK(!acks.is_loaded(3));
+    CHECK_EQ(acks.get_stats().fifo_full, 1);
+
+    host_advance_us(ACK_MAX_AGE_MS * 1000U - 200);
+    acks.expire(DWT->CYCCNT);
+    CHECK_EQ(fake.counters.flush_tx, 0);
+
+    // Pipe 0 is heard just before the limit: its reply goes and pipe 3 takes the slot
+    hear(fake, acks, 0);
+    acks.refill();
+    CHECK(acks.is_loaded(3));
+    CHECK(acks.queue(0, reply, sizeof(reply)));
+
+    host_advance_us(200);
+    acks.expire(DWT->CYCCNT);
+    CHECK_EQ(fake.counters.flush_tx, 1);
+    CHECK_EQ(acks.get_stats().flushes, 1);
+    CHECK_EQ(fake.tx_count(), 0);
+
+    // The stale pipes are parked, the fresh ones reload
+    acks.refill();
+    CHECK(acks.is_loaded(0));
+    CHECK(acks.is_loaded(3));
+    CHECK(!acks.is_loaded(1));
+    CHECK(!acks.is_loaded(2));
+
+    // A parked sender is heard (without a payload to take) and its reply comes back
+    hear(fake, acks, 1);
+    acks.refill();
+    CHECK(acks.is_loaded(1));
+    size_t before = fake.acks_sent.size();
+    hear(fake, acks, 1);
+    CHECK(sent(fake, before, 1, 1));
+}
+
+static void test_suspended_and_one_off()
+{
+    FakeNrf24 fake;
+    AckPayloads acks;
+    setup(fake, acks);
+
+    uint8_t reply[1] = {9};
+    CHECK(acks.queue(0, reply, sizeof(reply)));
+    acks.set_suspended(true);
+    acks.refill();
+    CHECK_EQ(fake.tx_count(), 0);
+    acks.set_suspended(false);
+    acks.refill();
+    CHECK_EQ(fake.tx_count(), 1);
+
+    // A one-off behind the loaded reply: the reply still leaves its queue first
+    uint8_t announce[2] = {0xA7, 40};
+    CHECK(acks.load(0, announce, sizeof(announce)));
+    hear(fake, acks, 0);
+    CHECK(sent(fake, 0, 0, 9));
+    CHECK_EQ(acks.get_stats().replies, 1);
+    hear(fake, acks, 0);
+    CHECK(sent(fake, 1, 0, 0xA7));
+    CHECK_EQ(acks.get_stats().replies, 1);
+}
+
+int main()
+{
+    test_one_loaded_per_pipe();
+    test_arrival_before_load();
+    test_generated_behind_queued();
+    test_age_flush();
+    test_suspended_and_one_off();
+    return host_test_result();
+}
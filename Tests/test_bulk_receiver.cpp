@@ -0,0 +1,351 @@
+/*
+ * BulkReceiver: in-order delivery through gaps, duplicates, the window edge,
+ * timeouts, and the goodput of the selective-repeat loop against a simulated
+ * link that carries the status back in auto-acks with RadioTask's lag.
+ */
+#include "bulk_receiver.h"
+#include "host_test.h"
+#include <string.h>
+#include <random>
+#include <vector>
+
+#define SENDER      1
+#define XFER        7
+
+static std::vector<uint8_t> g_out;
+
+static bool sink(uint32_t offset, const uint8_t* data, uint16_t len, void* context)
+{
+    // Offsets must arrive in order, without gaps or repeats
+    if (offset != g_out.size()) {
+        return false;
+    }
+    g_out.insert(g_out.end(), data, data + len);
+    return true;
+}
+
+static length make_start(uint8_t* payload, uint8_t seq, uint32_t size)
+{
+    payload[0] = seq;
+    payload[1] = FRAME_TYPE_BULK_START;
+    payload[2] = XFER;
+    payload[3] = 0;
+    memcpy(&payload[4], &size, sizeof(size));
+    return BULK_START_LENGTH;
+}
+
+static length make_block(uint8_t* payload, uint8_t seq, const std::vector<uint8_t>& blob, uint16_t block)
+{
+    uint32_t offset = (uint32_t)block * BULK_BLOCK_LENGTH;
+    length n = (blob.size() - offset < BULK_BLOCK_LENGTH) ? (length)(blob.size() - offset) : BULK_BLOCK_LENGTH;
+
+    payload[0] = seq;
+    payload[1] = FRAME_TYPE_BULK_DATA;
+    payload[2] = XFER;
+    payload[3] = (uint8_t)block;
+    payload[4] = (uint8_t)(block >> 8);
+    memcpy(&payload[BULK_HEADER_LENGTH], &blob[offset], n);
+    return BULK_HEADER_LENGTH + n;
+}
+
+static std::vector<uint8_t> make_blob(uint32_t size, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> blob(size);
+
+    for (uint8_t& b : blob) {
+        b = (uint8_t)rng();
+    }
+    return blob;
+}
+
+static void feed_block(BulkReceiver& rx, const std::vector<uint8_t>& blob, uint16_t block, uint32_t now_ms = 0)
+{
+    uint8_t payload[NRF24L01P_PAYLOAD_LENGTH];
+    rx.feed(SENDER, payload, make_block(payload, 0, blob, block), now_ms);
+}
+
+static void test_gaps_and_duplicates()
+{
+    std::vector<uint8_t> blob = make_blob(10 * BULK_BLOCK_LENGTH + 5, 1);
+    uint8_t payload[NRF24L01P_PAYLOAD_LENGTH];
+    uint8_t status[BULK_STATUS_LENGTH];
+    BulkReceiver rx;
+
+    g_out.clear();
+    rx.set_sink(sink, NULL);
+    rx.feed(SENDER, payload, make_start(payload, 0, (uint32_t)blob.size()), 0);
+    CHECK(rx.is_active());
+    CHECK_EQ(rx.get_state(), BulkReceiver::BULK_RECEIVING);
+
+    // Blocks 1 and 3 ahead of a gap at 0 (and 2): buffered, bitmap NACKs 0 and 2
+    feed_block(rx, blob, 1);
+    feed_block(rx, blob, 3);
+    CHECK_EQ(g_out.size(), 0);
+    CHECK_EQ(rx.get_status(status), BULK_STATUS_LENGTH);
+    CHECK_EQ(status[0], BULK_STATUS_TAG);
+    CHECK_EQ(status[1], XFER);
+    CHECK_EQ(status[3] | (status[4] << 8), 0);
+    CHECK_EQ(status[5], 0x0A);
+
+    // Filling 0 slides over 1; 2 then slides over 3
+    feed_block(rx, blob, 0);
+    CHECK_EQ(g_out.size(), 2 * BULK_BLOCK_LENGTH);
+    feed_block(rx, blob, 2);
+    CHECK_EQ(g_out.size(), 4 * BULK_BLOCK_LENGTH);
+    rx.get_status(status);
+    CHECK_EQ(status[3] | (status[4] << 8), 4);
+    CHECK_EQ(status[5], 0);
+
+    feed_block(rx, blob, 1);
+    feed_block(rx, blob, 6);
+    feed_block(rx, blob, 6);
+    CHECK_EQ(rx.get_stats().duplicates, 2);
+
+    for (uint16_t block = 4; block <= 10; block++) {
+        feed_block(rx, blob, block);
+    }
+    CHECK_EQ(rx.get_state(), BulkReceiver::BULK_DONE);
+    CHECK(g_out == blob);
+    CHECK_EQ(rx.get_stats().completed, 1);
+    CHECK_EQ(rx.get_stats().blocks, 11);
+}
+
+static void test_window_and_timeout()
+{
+    std::vector<uint8_t> blob = make_blob(100 * BULK_BLOCK_LENGTH, 2);
+    uint8_t payload[NRF24L01P_PAYLOAD_LENGTH];
+    BulkReceiver rx;
+
+    g_out.clear();
+    rx.set_sink(sink, NULL);
+    rx.feed(SENDER, payload, make_start(payload, 0, (uint32_t)blob.size()), 0);
+
+    feed_block(rx, blob, BULK_WINDOW, 10);
+    CHECK_EQ(rx.get_stats().out_of_window, 1);
+    feed_block(rx, blob, BULK_WINDOW - 1, 10);
+    CHECK_EQ(rx.get_stats().out_of_window, 1);
+
+    // Another transfer's blocks do not keep this one alive
+    make_block(payload, 0, blob, 0);
+    payload[2] = XFER + 1;
+    rx.feed(SENDER, payload, BULK_HEADER_LENGTH + BULK_BLOCK_LENGTH, 1000);
+    CHECK_EQ(rx.get_stats().stale, 1);
+
+    rx.expire(10 + BULK_TIMEOUT_MS - 1);
+    CHECK_EQ(rx.get_state(), BulkReceiver::BULK_RECEIVING);
+    rx.expire(10 + BULK_TIMEOUT_MS);
+    CHECK_EQ(rx.get_state(), BulkReceiver::BULK_ABORTED);
+    CHECK_EQ(rx.get_stats().timeouts, 1);
+}
+
+/*
+ * Goodput model, one slot per ESB exchange (32-byte payload, 9-byte ACK payload,
+ * two turnarounds at 1 Mbps: RADIO_SLOT_US).
+ *
+ *   sender    ESB retransmits a packet until its ACK arrives; otherwise sends the
+ *             lowest NACKed block, then new blocks up to base + BULK_WINDOW, then
+ *             the oldest unacknowledged block once RTO_SLOTS have passed
+ *   chip      a packet is lost with probability p, its ACK too; an ACK carries the
+ *             status only if it was loaded before the packet arrived
+ *   RadioTask woken by watermark packets or after TIMEOUT_SLOTS, drains the ring
+ *             and reloads the status after the last bulk packet (radio.cpp)
+ */
+#define RADIO_SLOT_US       720
+#define TIMEOUT_SLOTS       3       // RADIO_RX_TIMEOUT_MS
+#define RTO_SLOTS           16
+#define NACK_HOLDOFF_SLOTS  8       // A status older than this resend is no news
+
+struct Goodput
+{
+    double kbytes_per_s;
+    double limit_kbytes_per_s;
+    uint32_t sent;
+    uint32_t blocks;
+    double status_share;            // Auto-acks that carried a status
+    bool intact;
+};
+
+static Goodput simulate(double loss, uint8_t watermark, uint32_t size)
+{
+    std::mt19937 rng(42);
+    std::bernoulli_distribution lost(loss);
+    std::vector<uint8_t> blob = make_blob(size, 3);
+    uint16_t blocks = (uint16_t)((size + BULK_BLOCK_LENGTH - 1) / BULK_BLOCK_LENGTH);
+
+    std::vector<bool> acked(blocks, false), nacked(blocks, false);
+    std::vector<long> last_sent(blocks, -1000000);
+    uint16_t sender_base = 0, next_new = 0;
+    bool started = false, esb_pending = false, done = false;
+    uint8_t packet[NRF24L01P_PAYLOAD_LENGTH];
+    length packet_len = 0;
+    uint8_t seq = 0;
+    int last_seq = -1;
+
+    BulkReceiver rx;
+    struct Arrival { uint8_t payload[NRF24L01P_PAYLOAD_LENGTH]; length len; long slot; };
+    std::vector<Arrival> ring;
+    uint8_t status[BULK_STATUS_LENGTH];
+    bool loaded = false;
+    long loaded_slot = 0;
+    uint32_t acks = 0, statuses = 0;
+    Goodput result = {};
+
+    g_out.clear();
+    rx.set_sink(sink, NULL);
+
+    long slot;
+    for (slot = 0; !done && slot < 2000000; slot++)
+    {
+        // --- Sender ---
+        if (!esb_pending)
+        {
+            int pick = -1;
+
+            if (started)
+            {
+                for (uint16_t b = sender_base; b < next_new && pick < 0; b++) {
+                    if (nacked[b] && !acked[b] && slot - last_sent[b] >= NACK_HOLDOFF_SLOTS) {
+                        pick = b;
+                    }
+                }
+                if (pick < 0 && next_new < blocks && next_new < sender_base + BULK_WINDOW) {
+                    pick = next_new++;
+                }
+                for (uint16_t b = sender_base; b < next_new && pick < 0; b++) {
+                    if (!acked[b] && slot - last_sent[b] >= RTO_SLOTS) {
+                        pick = b;
+                    }
+                }
+                if (pick < 0) {
+                    continue;               // Window stalled: the slot goes by idle
+                }
+                last_sent[pick] = slot;
+                nacked[pick] = false;
+                packet_len = make_block(packet, seq++, blob, (uint16_t)pick);
+            }
+            else
+            {
+                packet_len = make_start(packet, seq++, size);
+            }
+            result.sent++;
+            esb_pending = true;
+        }
+
+        // --- Air and chip ---
+        if (!lost(rng))
+        {
+            // A retransmission after a lost ACK is dropped as a duplicate (LinkQuality)
+            if (packet[0] != last_seq)
+            {
+                last_seq = packet[0];
+                Arrival arrival;
+                memcpy(arrival.payload, packet, packet_len);
+                arrival.len = packet_len;
+                arrival.slot = slot;
+                ring.push_back(arrival);
+            }
+
+            bool carries = loaded && loaded_slot < slot;
+            uint8_t ack[BULK_STATUS_LENGTH] = {0};
+            if (carries)
+            {
+                memcpy(ack, status, sizeof(ack));
+                loaded = false;
+            }
+
+            if (!lost(rng))
+            {
+                esb_pending = false;
+                acks++;
+                statuses += carries ? 1 : 0;
+                if (carries && ack[1] == XFER)
+                {
+                    started = true;
+                    uint16_t base = ack[3] | (ack[4] << 8);
+                    uint32_t bitmap = ack[5] | (ack[6] << 8) | (ack[7] << 16) | ((uint32_t)ack[8] << 24);
+                    uint8_t highest = 0;
+
+                    for (uint16_t b = sender_base; b < base && b < blocks; b++) {
+                        acked[b] = true;
+                    }
+                    if (base > sender_base) {
+                        sender_base = base;
+                    }
+                    for (uint8_t i = 0; i < BULK_WINDOW; i++) {
+                        if ((bitmap >> i) & 1) {
+                            highest = i;
+                            if (base + i < blocks) {
+                                acked[base + i] = true;
+                            }
+                        }
+                    }
+                    for (uint8_t i = 0; i < highest; i++) {
+                        if (!((bitmap >> i) & 1) && base + i < blocks) {
+                            nacked[base + i] = true;
+                        }
+                    }
+                    done = (ack[2] == BulkReceiver::BULK_DONE);
+                }
+            }
+        }
+
+        // --- RadioTask ---
+        if (!ring.empty() && (ring.size() >= watermark || slot - ring.front().slot >= TIMEOUT_SLOTS))
+        {
+            for (const Arrival& arrival : ring) {
+                rx.feed(SENDER, arrival.payload, arrival.len, 0);
+            }
+            ring.clear();
+
+            if (!loaded)
+            {
+                rx.get_status(status);
+                loaded = true;
+                loaded_slot = slot;
+            }
+        }
+    }
+
+    double seconds = slot * (RADIO_SLOT_US / 1e6);
+    result.kbytes_per_s = size / seconds / 1e3;
+    result.limit_kbytes_per_s = (1 - loss) * (1 - loss) * BULK_BLOCK_LENGTH / (RADIO_SLOT_US / 1e6) / 1e3;
+    result.blocks = blocks;
+    result.status_share = acks ? (double)statuses / acks : 0;
+    result.intact = done && g_out == blob;
+    return result;
+}
+
+static void test_goodput()
+{
+    static const double LOSSES[] = {0.0, 0.01, 0.05, 0.10, 0.20, 0.30};
+    static const uint8_t WATERMARKS[] = {1, 4};
+
+    for (uint8_t watermark : WATERMARKS)
+    {
+        for (double loss : LOSSES)
+        {
+            Goodput g = simulate(loss, watermark, 64 * 1024);
+            double share = g.kbytes_per_s / g.limit_kbytes_per_s;
+
+            printf("watermark %u  loss %3.0f%%  goodput %5.1f kB/s of %5.1f (%3.0f%%)  sent %lu/%lu  status in %3.0f%% of acks\n",
+                   watermark, loss * 100, g.kbytes_per_s, g.limit_kbytes_per_s, share * 100,
+                   (unsigned long)g.sent, (unsigned long)g.blocks, g.status_share * 100);
+
+            CHECK(g.intact);
+            if (loss <= 0.10) {
+                CHECK(share > 0.90);
+            } else {
+                CHECK(share > 0.75);
+            }
+        }
+    }
+}
+
+int main()
+{
+    test_gaps_and_duplicates();
+    test_window_and_timeout();
+    test_goodput();
+    return host_test_result();
+}
@@ -0,0 +1,206 @@
+/*
+ * ChaCha20-Poly1305 against the RFC 8439 test vectors (2.8.2 seal, A.5 open),
+ * plus the truncated-tag and forgery paths SecureLink relies on, and the host
+ * cost of chachapoly_open() per byte against a saturated 2 Mbps link.
+ */
+#include "chacha20poly1305.h"
+#include "nrf24l01p.h"
+#include "host_test.h"
+#include <string.h>
+#include <chrono>
+
+static size_t unhex(const char* text, uint8_t* out)
+{
+    size_t len = strlen(text) / 2;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        unsigned value = 0;
+        sscanf(&text[2 * i], "%2x", &value);
+        out[i] = (uint8_t)value;
+    }
+    return len;
+}
+
+// RFC 8439 2.8.2
+static const char* SUNSCREEN =
+    "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, "
+    "sunscreen would be it.";
+static const char* SUNSCREEN_CIPHERTEXT =
+    "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca9671282fafb69da92728b"
+    "1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+    "3ff4def08e4b7a9de576d26586cec64b6116";
+static const char* SUNSCREEN_TAG = "1ae10b594f09e26a7e902ecbd0600691";
+
+// RFC 8439 A.5
+static const char* A5_KEY = "1c9240a5eb55d38af333888604f6b5f0473917c1402b80099dca5cbc207075c0";
+static const char* A5_NONCE = "000000000102030405060708";
+static const char* A5_AAD = "f33388860000000000004e91";
+static const char* A5_TAG = "eead9d67890cbb22392336fea1851f38";
+static const char* A5_CIPHERTEXT =
+    "64a0861575861af460f062c79be643bd5e805cfd345cf389f108670ac76c8cb24c6cfc18755d43eea09ee94e382d26b0"
+    "bdb7b73c321b0100d4f03b7f355894cf332f830e710b97ce98c8a84abd0b948114ad176e008d33bd60f982b1ff37c855"
+    "9797a06ef4f0ef61c186324e2b3506383606907b6a7c02b0f9f6157b53c867e4b9166c767b804d46a59b5216cde7a4e9"
+    "9040c5a40433225ee282a1b0a06c523eaf4534d7f83fa1155b0047718cbc546a0d072b04b3564eea1b422273f548271a"
+    "0bb2316053fa76991955ebd63159434ecebb4e466dae5a1073a6727627097a1049e617d91d361094fa68f0ff77987130"
+    "305beaba2eda04df997b714d6c6f2c29a6ad5cb4022b02709b";
+static const char* A5_PLAINTEXT_START = "Internet-Drafts are draft documents valid for a maximum of six months";
+
+static void test_seal_vector()
+{
+    uint8_t key[CHACHAPOLY_KEY_LENGTH];
+    uint8_t nonce[CHACHAPOLY_NONCE_LENGTH];
+    uint8_t aad[12];
+    uint8_t buffer[128];
+    uint8_t expected[128];
+    uint8_t tag[CHACHAPOLY_TAG_LENGTH];
+    uint8_t expected_tag[CHACHAPOLY_TAG_LENGTH];
+    size_t len = strlen(SUNSCREEN);
+
+    for (uint8_t i = 0; i < CHACHAPOLY_KEY_LENGTH; i++) {
+        key[i] = (uint8_t)(0x80 + i);
+    }
+    unhex("070000004041424344454647", nonce);
+    unhex("50515253c0c1c2c3c4c5c6c7", aad);
+    CHECK_EQ(unhex(SUNSCREEN_CIPHERTEXT, expected), len);
+    unhex(SUNSCREEN_TAG, expected_tag);
+
+    memcpy(buffer, SUNSCREEN, len);
+    chachapoly_seal(key, nonce, aad, sizeof(aad), buffer, len, tag);
+    CHECK(memcmp(buffer, expected, len) == 0);
+    CHECK(memcmp(tag, expected_tag, sizeof(tag)) == 0);
+
+    // Full and truncated tags both open it
+    uint8_t copy[128];
+    memcpy(copy, buffer, len);
+    CHECK(chachapoly_open(key, nonce, aad, sizeof(aad), copy, len, tag, CHACHAPOLY_TAG_LENGTH));
+    CHECK(memcmp(copy, SUNSCREEN, len) == 0);
+    CHECK(chachapoly_open(key, nonce, aad, sizeof(aad), buffer, len, tag, 8));
+    CHECK(memcmp(buffer, SUNSCREEN, len) == 0);
+}
+
+static void test_open_vector()
+{
+    uint8_t key[CHACHAPOLY_KEY_LENGTH];
+    uint8_t nonce[CHACHAPOLY_NONCE_LENGTH];
+    uint8_t aad[12];
+    uint8_t tag[CHACHAPOLY_TAG_LENGTH];
+    uint8_t buffer[320];
+
+    unhex(A5_KEY, key);
+    unhex(A5_NONCE, nonce);
+    unhex(A5_AAD, aad);
+    unhex(A5_TAG, tag);
+    size_t len = unhex(A5_CIPHERTEXT, buffer);
+
+    CHECK(chachapoly_open(key, nonce, aad, sizeof(aad), buffer, len, tag, CHACHAPOLY_TAG_LENGTH));
+    CHECK(memcmp(buffer, A5_PLAINTEXT_START, strlen(A5_PLAINTEXT_START)) == 0);
+}
+
+static void test_forgeries()
+{
+    uint8_t key[CHACHAPOLY_KEY_LENGTH] = {1};
+    uint8_t nonce[CHACHAPOLY_NONCE_LENGTH] = {2};
+    uint8_t aad[4] = {3, 0, 0, 0};
+    uint8_t buffer[20] = {0};
+    uint8_t tag[CHACHAPOLY_TAG_LENGTH];
+
+    chachapoly_seal(key, nonce, aad, sizeof(aad), buffer, sizeof(buffer), tag);
+
+    // Every single-bit flip of ciphertext, associated data or tag is caught
+    // and leaves the ciphertext untouched
+    for (size_t bit = 0; bit < 8 * sizeof(buffer); bit++)
+    {
+        uint8_t copy[sizeof(buffer)];
+        memcpy(copy, buffer, sizeof(buffer));
+        copy[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+
+        uint8_t flipped[sizeof(buffer)];
+        memcpy(flipped, copy, sizeof(copy));
+        CHECK(!chachapoly_open(key, nonce, aad, sizeof(aad), copy, sizeof(copy), tag, 8));
+        CHECK(memcmp(copy, flipped, sizeof(copy)) == 0);
+    }
+    for (size_t bit = 0; bit < 8 * sizeof(aad); bit++)
+    {
+        uint8_t copy[sizeof(buffer)];
+        uint8_t bad[sizeof(aad)];
+        memcpy(copy, buffer, sizeof(buffer));
+        memcpy(bad, aad, sizeof(aad));
+        bad[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        CHECK(!chachapoly_open(key, nonce, bad, sizeof(bad), copy, sizeof(copy), tag, 8));
+    }
+    for (size_t bit = 0; bit < 8 * 8; bit++)
+    {
+        uint8_t copy[sizeof(buffer)];
+        uint8_t bad[CHACHAPOLY_TAG_LENGTH];
+        memcpy(copy, buffer, sizeof(buffer));
+        memcpy(bad, tag, sizeof(tag));
+        bad[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+        CHECK(!chachapoly_open(key, nonce, aad, sizeof(aad), copy, sizeof(copy), bad, 8));
+    }
+
+    // Wrong nonce (another sender's address or counter)
+    nonce[11] ^= 1;
+    CHECK(!chachapoly_open(key, nonce, aad, sizeof(aad), buffer, sizeof(buffer), tag, 8));
+}
+
+// Nanoseconds per chachapoly_open() of len bytes (SecureLink's 8-byte tag), best of a few runs
+static double time_open(size_t len, uint32_t rounds)
+{
+    static uint8_t sealed[4096];
+    static uint8_t buffer[4096];
+    uint8_t key[CHACHAPOLY_KEY_LENGTH] = {7};
+    uint8_t nonce[CHACHAPOLY_NONCE_LENGTH] = {9};
+    uint8_t aad[4] = {1, 2, 3, 4};
+    uint8_t tag[CHACHAPOLY_TAG_LENGTH];
+    double best = 1e30;
+
+    for (size_t i = 0; i < len; i++) {
+        sealed[i] = (uint8_t)i;
+    }
+    chachapoly_seal(key, nonce, aad, sizeof(aad), sealed, len, tag);
+
+    for (int run = 0; run < 5; run++)
+    {
+        bool opened = true;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < rounds; i++)
+        {
+            memcpy(buffer, sealed, len);
+            opened &= chachapoly_open(key, nonce, aad, sizeof(aad), buffer, len, tag, 8);
+        }
+        auto end = std::chrono::steady_clock::now();
+        CHECK(opened);
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+        if (ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+static void test_open_cost()
+{
+    // Back-to-back full payloads at 2 Mbps (3-byte address, 1-byte CRC, no acks):
+    // the shortest time RadioTask can have per packet
+    uint32_t budget_us = nrf24l01p_air_time_us(&NRF24L01P_PROFILE_MAX_THROUGHPUT, NRF24L01P_PAYLOAD_LENGTH);
+    double packet_ns = time_open(20, 20000);
+    double bulk_ns = time_open(4096, 200);
+
+    printf("open: %6.0f ns per 20-byte packet (%.1f ns/B), %.2f ns/B in bulk\n",
+           packet_ns, packet_ns / 20, bulk_ns / 4096);
+    printf("budget: %u us per packet at 2 Mbps (%lu cycles at %lu MHz on target), host open uses %.2f%% of it\n",
+           (unsigned)budget_us, (unsigned long)(budget_us * (SystemCoreClock / 1000000U)),
+           (unsigned long)(SystemCoreClock / 1000000U), 100.0 * packet_ns / (budget_us * 1000.0));
+    CHECK(packet_ns < budget_us * 1000.0);
+}
+
+int main()
+{
+    test_seal_vector();
+    test_open_vector();
+    test_forgeries();
+    test_open_cost();
+    return host_test_result();
+}
@@ -0,0 +1,90 @@
+/*
+ * Channel selection: the rendezvous handoff confirmed by packets (with a reply
+ * loaded ahead of the announcement), the rendezvous timeout, re-selection only
+ * after CHANNEL_RESELECT_MIN_MS on a degraded link, and requests.
+ */
+#include "channel_selector.h"
+#include "host_test.h"
+
+static void test_handoff()
+{
+    ChannelSelector selector;
+
+    CHECK_EQ(selector.get_state(), ChannelSelector::CHANNEL_FIXED);
+    CHECK_EQ(selector.update(0, true), ChannelSelector::CHANNEL_STAY);
+    CHECK_EQ(selector.get_channel(106), 106);
+
+    // A reply was loaded ahead of the announcement: the second packet takes it
+    selector.on_selected(84, 1500, 2, 100);
+    CHECK_EQ(selector.get_state(), ChannelSelector::CHANNEL_RENDEZVOUS);
+    CHECK_EQ(selector.get_channel(106), 106);
+
+    selector.on_rendezvous_packet();
+    CHECK_EQ(selector.update(110, false), ChannelSelector::CHANNEL_STAY);
+    selector.on_rendezvous_packet();
+    CHECK_EQ(selector.update(120, false), ChannelSelector::CHANNEL_MOVE);
+    CHECK_EQ(selector.get_state(), ChannelSelector::CHANNEL_SELECTED);
+    CHECK_EQ(selector.get_channel(106), 84);
+
+    const ChannelSelector::Stats& stats = selector.get_stats();
+    CHECK_EQ(stats.selections, 1);
+    CHECK_EQ(stats.announced, 1);
+    CHECK_EQ(stats.last_scan_us, 1500);
+    CHECK_EQ(stats.channel, 84);
+
+    // Packets after the handoff do not count towards the next one
+    selector.on_rendezvous_packet();
+    selector.on_selected(50, 900, 1, 200);
+    CHECK_EQ(selector.update(201, false), ChannelSelector::CHANNEL_STAY);
+    CHECK_EQ(stats.max_scan_us, 1500);
+}
+
+static void test_rendezvous_timeout()
+{
+    ChannelSelector selector;
+    TickType_t limit = pdMS_TO_TICKS(CHANNEL_RENDEZVOUS_MS);
+
+    selector.on_selected(76, 1000, 1, 1000);
+    CHECK_EQ(selector.update(1000 + limit - 1, false), ChannelSelector::CHANNEL_STAY);
+    CHECK_EQ(selector.update(1000 + limit, false), ChannelSelector::CHANNEL_MOVE);
+    CHECK_EQ(selector.get_stats().rendezvous_timeouts, 1);
+    CHECK_EQ(selector.get_stats().announced, 0);
+
+    // The announcement could not be loaded: nothing to wait for
+    selector.on_selected(80, 1000, 0, 5000);
+    CHECK_EQ(selector.update(5000, false), ChannelSelector::CHANNEL_MOVE);
+    CHECK_EQ(selector.get_stats().announced, 1);
+}
+
+static void test_reselection_and_request()
+{
+    ChannelSelector selector;
+    TickType_t hold = pdMS_TO_TICKS(CHANNEL_RESELECT_MIN_MS);
+
+    selector.on_selected(90, 1000, 0, 0);
+    CHECK_EQ(selector.update(10, false), ChannelSelector::CHANNEL_MOVE);
+
+    // A degraded link waits out the hold time; a good one stays after it
+    CHECK_EQ(selector.update(10 + hold - 1, true), ChannelSelector::CHANNEL_STAY);
+    CHECK_EQ(selector.update(10 + hold, false), ChannelSelector::CHANNEL_STAY);
+    CHECK_EQ(selector.update(10 + hold, true), ChannelSelector::CHANNEL_SELECT);
+    CHECK_EQ(selector.get_stats().reselections, 1);
+
+    // A request goes first, whatever the state, until a selection is made
+    selector.on_selected(96, 1000, 1, 20000);
+    selector.request();
+    CHECK_EQ(selector.update(20001, false), ChannelSelector::CHANNEL_SELECT);
+    CHECK_EQ(selector.update(20002, false), ChannelSelector::CHANNEL_SELECT);
+    selector.on_selected(100, 1000, 1, 20003);
+    CHECK_EQ(selector.update(20004, false), ChannelSelector::CHANNEL_STAY);
+    CHECK_EQ(selector.get_stats().selections, 3);
+    CHECK_EQ(selector.get_stats().reselections, 1);
+}
+
+int main()
+{
+    test_handoff();
+    test_rendezvous_timeout();
+    test_reselection_and_request();
+    return host_test_result();
+}
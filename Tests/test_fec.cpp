@@ -0,0 +1,178 @@
+/*
+ * FEC codec: round trip, every single-bit error, every burst of up to 32 bits
+ * (the interleaver's promise), double errors in one codeword, CRC-16 check
+ * value, and goodput against random bit errors next to plain CRC frames.
+ */
+#include "fec.h"
+#include "nrf24l01p.h"
+#include "host_test.h"
+#include <string.h>
+#include <random>
+
+static uint8_t g_data[FEC_DATA_LENGTH];
+static uint8_t g_coded[FEC_CODED_LENGTH];
+
+static void flip(uint8_t* buf, uint16_t bit)
+{
+    buf[bit / 8] ^= (uint8_t)(1 << (bit % 8));
+}
+
+static bool decodes_to_data(uint8_t* buf, uint8_t expected_fixes)
+{
+    length len = 0;
+    uint8_t fixed = 0;
+
+    return fec_decode(buf, &len, &fixed) == FEC_OK && len == FEC_DATA_LENGTH &&
+           memcmp(buf, g_data, FEC_DATA_LENGTH) == 0 && fixed == expected_fixes;
+}
+
+static void test_crc16()
+{
+    // CRC-16/CCITT-FALSE check value
+    CHECK_EQ(fec_crc16((const uint8_t*)"123456789", 9), 0x29B1);
+}
+
+static void test_round_trip()
+{
+    uint8_t buf[FEC_CODED_LENGTH];
+    length len = 0;
+
+    memcpy(buf, g_coded, sizeof(buf));
+    CHECK(decodes_to_data(buf, 0));
+
+    // Short messages and an oversized one (cut to FEC_DATA_LENGTH)
+    fec_encode((const uint8_t*)"ab", 2, buf);
+    CHECK_EQ(fec_decode(buf, &len, NULL), FEC_OK);
+    CHECK_EQ(len, 2);
+    CHECK(memcmp(buf, "ab", 2) == 0);
+
+    uint8_t big[FEC_DATA_LENGTH + 5] = {0};
+    fec_encode(big, sizeof(big), buf);
+    CHECK_EQ(fec_decode(buf, &len, NULL), FEC_OK);
+    CHECK_EQ(len, FEC_DATA_LENGTH);
+}
+
+static void test_single_bits_and_bursts()
+{
+    uint8_t buf[FEC_CODED_LENGTH];
+    uint32_t failures = 0;
+
+    for (uint16_t bit = 0; bit < 8 * FEC_CODED_LENGTH; bit++)
+    {
+        memcpy(buf, g_coded, sizeof(buf));
+        flip(buf, bit);
+        failures += decodes_to_data(buf, 1) ? 0 : 1;
+    }
+    CHECK_EQ(failures, 0);
+
+    // A burst of up to 32 air bits hits each codeword at most once
+    for (uint16_t start = 0; start < 8 * FEC_CODED_LENGTH; start++)
+    {
+        for (uint16_t burst = 1; burst <= 32 && start + burst <= 8 * FEC_CODED_LENGTH; burst++)
+        {
+            memcpy(buf, g_coded, sizeof(buf));
+            for (uint16_t bit = start; bit < start + burst; bit++) {
+                flip(buf, bit);
+            }
+            failures += decodes_to_data(buf, (uint8_t)burst) ? 0 : 1;
+        }
+    }
+    CHECK_EQ(failures, 0);
+}
+
+static void test_double_error()
+{
+    uint8_t buf[FEC_CODED_LENGTH];
+    length len = 0;
+
+    // Air bits 0 and 32 are bits 0 and 1 of codeword 0 (air byte 4k+g, bit k)
+    memcpy(buf, g_coded, sizeof(buf));
+    flip(buf, 0);
+    flip(buf, 8 * 4 + 0);
+    CHECK_EQ(fec_decode(buf, &len, NULL), FEC_UNCORRECTABLE);
+}
+
+static void test_random_errors()
+{
+    static const double BERS[] = {1e-4, 1e-3, 2e-3, 3e-3, 4e-3, 5e-3, 1e-2, 2e-2, 3e-2};
+    std::mt19937 rng(9);
+    double crossover = 0;
+
+    // Plain frames: a full payload under the chip's CRC, dropped on any bit error
+    // in payload or CRC (the address and control field cost both modes the same)
+    uint16_t plain_bits = 8 * (NRF24L01P_PAYLOAD_LENGTH + NRF24L01P_PROFILE_DEFAULT.crc_bytes);
+
+    printf("BER     FEC delivered  B/frame   plain delivered  B/frame\n");
+    for (double ber : BERS)
+    {
+        std::bernoulli_distribution error(ber);
+        uint32_t delivered = 0, wrong = 0, plain = 0, packets = 20000;
+
+        for (uint32_t i = 0; i < packets; i++)
+        {
+            uint8_t data[FEC_DATA_LENGTH];
+            uint8_t buf[FEC_CODED_LENGTH];
+            length len = 0;
+
+            for (uint8_t& b : data) {
+                b = (uint8_t)rng();
+            }
+            fec_encode(data, sizeof(data), buf);
+            for (uint16_t bit = 0; bit < 8 * FEC_CODED_LENGTH; bit++) {
+                if (error(rng)) {
+                    flip(buf, bit);
+                }
+            }
+
+            if (fec_decode(buf, &len, NULL) == FEC_OK)
+            {
+                if (len == FEC_DATA_LENGTH && memcmp(buf, data, len) == 0) {
+                    delivered++;
+                } else {
+                    wrong++;
+                }
+            }
+
+            bool intact = true;
+            for (uint16_t bit = 0; bit < plain_bits; bit++) {
+                if (error(rng)) {
+                    intact = false;
+                }
+            }
+            plain += intact ? 1 : 0;
+        }
+
+        // Goodput: payload bytes delivered per frame sent
+        double fec_goodput = (double)FEC_DATA_LENGTH * delivered / packets;
+        double plain_goodput = (double)NRF24L01P_PAYLOAD_LENGTH * plain / packets;
+
+        printf("%.0e  %12.1f%%  %7.2f   %14.1f%%  %7.2f\n", ber, 100.0 * delivered / packets,
+               fec_goodput, 100.0 * plain / packets, plain_goodput);
+        CHECK_EQ(wrong, 0);
+        if (ber <= 1e-2) {
+            CHECK(delivered > packets * 0.9);
+        }
+        if (crossover == 0 && fec_goodput > plain_goodput) {
+            crossover = ber;
+        }
+    }
+
+    // A clean link is better off with 32 bytes a frame; a noisy one with FEC
+    printf("FEC delivers more payload from BER %.0e\n", crossover);
+    CHECK(crossover > 1e-3 && crossover <= 1e-2);
+}
+
+int main()
+{
+    for (uint8_t i = 0; i < FEC_DATA_LENGTH; i++) {
+        g_data[i] = (uint8_t)(0x5A ^ (i * 37));
+    }
+    fec_encode(g_data, FEC_DATA_LENGTH, g_coded);
+
+    test_crc16();
+    test_round_trip();
+    test_single_bits_and_bursts();
+    test_double_error();
+    test_random_errors();
+    return host_test_result();
+}
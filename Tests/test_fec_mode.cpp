@@ -0,0 +1,83 @@
+/*
+ * FEC mode: the request/active switch, the pipe override and the decoder's
+ * counters (decoded, corrected, uncorrectable, CRC errors, wrong lengths).
+ */
+#include "fec_mode.h"
+#include "host_test.h"
+#include <string.h>
+
+static void code(nrf24l01p_rx_packet* packet, const char* text)
+{
+    fec_encode((const uint8_t*)text, (length)strlen(text), packet->payload);
+    packet->len = FEC_CODED_LENGTH;
+}
+
+static void test_switch_and_override()
+{
+    FecMode fec;
+    nrf24l01p_pipe_config config = {};
+
+    config.auto_ack = true;
+    config.dynamic_payload = true;
+    config.payload_width = 8;
+
+    CHECK(!fec.needs_switch());
+    fec.request(true);
+    CHECK(fec.needs_switch());
+    CHECK(!fec.is_enabled());
+
+    // Nothing is overridden until the chip has switched
+    fec.configure_pipe(&config);
+    CHECK(config.auto_ack);
+    CHECK_EQ(fec.crc_bytes(2), 2);
+
+    fec.set_enabled(true);
+    CHECK(!fec.needs_switch());
+    fec.configure_pipe(&config);
+    CHECK(!config.auto_ack);
+    CHECK(!config.dynamic_payload);
+    CHECK_EQ(config.payload_width, FEC_CODED_LENGTH);
+    CHECK_EQ(fec.crc_bytes(2), 0);
+}
+
+static void test_decode()
+{
+    FecMode fec;
+    nrf24l01p_rx_packet packet = {};
+
+    // Disabled: packets pass untouched
+    packet.len = 5;
+    CHECK(fec.decode(&packet));
+    CHECK_EQ(packet.len, 5);
+    CHECK_EQ(fec.get_stats().decoded, 0);
+
+    fec.set_enabled(true);
+    code(&packet, "hello");
+    packet.payload[3] ^= 0x10;
+    CHECK(fec.decode(&packet));
+    CHECK_EQ(packet.len, 5);
+    CHECK(memcmp(packet.payload, "hello", 5) == 0);
+
+    code(&packet, "hello");
+    packet.payload[0] ^= 0x01;          // Air bits 0 and 32: two errors in codeword 0
+    packet.payload[4] ^= 0x01;
+    CHECK(!fec.decode(&packet));
+
+    code(&packet, "hello");
+    packet.len = 10;                    // Not a coded payload
+    CHECK(!fec.decode(&packet));
+
+    const FecMode::Stats& stats = fec.get_stats();
+    CHECK_EQ(stats.decoded, 1);
+    CHECK_EQ(stats.corrected_packets, 1);
+    CHECK_EQ(stats.corrected_bits, 1);
+    CHECK_EQ(stats.uncorrectable, 1);
+    CHECK_EQ(stats.crc_errors, 1);
+}
+
+int main()
+{
+    test_switch_and_override();
+    test_decode();
+    return host_test_result();
+}
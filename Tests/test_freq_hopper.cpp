@@ -0,0 +1,262 @@
+/*
+ * FreqHopper against a modelled transmitter: a hop schedule with its own
+ * clock drift, a beacon per hop with random losses, an interference outage,
+ * and a receiver that only follows the hopper's update()/ticks_to_next().
+ * Also the mode switch and beacon recognition RadioTask relies on.
+ */
+#include "freq_hopper.h"
+#include "frame.h"
+#include "host_test.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TICKS_PER_US        100         // DWT at 100 MHz
+#define BEACON_OFFSET_US    200         // Beacon start after the hop boundary
+#define BEACON_AIR_US       150         // Beacon time on air (IRQ at its end)
+
+static const uint8_t ADDRESS[5] = {0xEE, 0xDD, 0xCC, 0xBB, 0xAA};
+
+/**
+ * @brief Transmitter side: hop k starts at t0 + k * dwell * (1 + drift).
+ */
+struct Transmitter
+{
+    double t0;
+    double drift;
+    long first_hop;                     // Hop k where the schedule started...
+    uint8_t first_index;                // ...with this index
+
+    uint8_t index(long k) const
+    {
+        return (uint8_t)((k - this->first_hop + this->first_index) % HOP_SEQUENCE_LENGTH);
+    }
+
+    double hop_start(long k) const
+    {
+        return this->t0 + (double)(k - this->first_hop) * HOP_DWELL_US * TICKS_PER_US * (1.0 + this->drift);
+    }
+};
+
+/**
+ * @brief Receiver side: the task wakes at every hop boundary the hopper asks for.
+ */
+struct Receiver
+{
+    FreqHopper hopper;
+    uint64_t now;
+    int channel;
+
+    void run_until(double t)
+    {
+        for (;;)
+        {
+            uint32_t next = this->hopper.ticks_to_next((uint32_t)this->now);
+            if ((double)(this->now + next) > t) {
+                break;
+            }
+            this->now += next;
+            this->step();
+        }
+        this->now = (uint64_t)t;
+        this->step();
+    }
+
+    void step()
+    {
+        if (this->hopper.update((uint32_t)this->now)) {
+            this->channel = this->hopper.get_channel();
+        }
+    }
+};
+
+struct Scenario
+{
+    double drift;
+    uint32_t loss_percent;              // Beacons lost at random
+    long outage_from, outage_to;        // Hops with every beacon lost
+    long restart_at;                    // Hop where the transmitter starts a new schedule (-1: never)
+};
+
+struct Result
+{
+    long first_sync_hop;
+    long synced_hops;
+    long hops;
+    long resync_hops;                   // Hops from the end of the outage (or the restart) to the next beacon caught
+};
+
+static void run(const Scenario& scenario, long hops, Result* result)
+{
+    Transmitter tx = {0, scenario.drift, 0, 9};
+    Receiver rx;
+    long outage_end = -1;
+
+    memset(result, 0, sizeof(*result));
+    result->first_sync_hop = -1;
+    result->resync_hops = -1;
+
+    // Start close to the 32-bit wrap: every interval must survive it
+    rx.now = 0xFFFFFFFFULL - 50000000ULL;
+    rx.channel = -1;
+    rx.hopper.start(0, ADDRESS, sizeof(ADDRESS), TICKS_PER_US, (uint32_t)rx.now);
+    rx.step();
+    tx.t0 = (double)rx.now + 7777777.0;
+
+    srand(1);
+    for (long k = 0; k < hops; k++)
+    {
+        if (k == scenario.restart_at)
+        {
+            // Power cycle: hop 0 of a fresh schedule at an unrelated phase
+            tx.t0 = tx.hop_start(k) + 3333333.0;
+            tx.first_hop = k;
+            tx.first_index = 0;
+            outage_end = k;
+        }
+
+        uint8_t index = tx.index(k);
+        double arrival = tx.hop_start(k) + (BEACON_OFFSET_US + BEACON_AIR_US) * TICKS_PER_US;
+        rx.run_until(arrival);
+
+        bool lost = (uint32_t)(rand() % 100) < scenario.loss_percent ||
+                    (k >= scenario.outage_from && k < scenario.outage_to);
+
+        if (!lost && rx.channel == rx.hopper.channel_at(index))
+        {
+            rx.hopper.on_beacon(index, BEACON_OFFSET_US + BEACON_AIR_US, (uint32_t)rx.now);
+            if (result->first_sync_hop < 0) {
+                result->first_sync_hop = k;
+            }
+            if (outage_end >= 0 && result->resync_hops < 0) {
+                result->resync_hops = k - outage_end;
+            }
+        }
+
+        if (k == scenario.outage_to) {
+            outage_end = k;
+        }
+        if (rx.hopper.get_state() == FreqHopper::HOP_SYNCED) {
+            result->synced_hops++;
+        }
+        result->hops++;
+    }
+}
+
+static void test_sequence()
+{
+    FreqHopper a, b;
+    bool used[HOP_LAST_CHANNEL + 1] = {false};
+
+    a.start(0, ADDRESS, sizeof(ADDRESS), TICKS_PER_US, 0);
+    b.start(0, ADDRESS, sizeof(ADDRESS), TICKS_PER_US, 12345);
+
+    for (uint8_t i = 0; i < HOP_SEQUENCE_LENGTH; i++)
+    {
+        uint8_t channel = a.channel_at(i);
+        CHECK(channel >= HOP_FIRST_CHANNEL && channel <= HOP_LAST_CHANNEL);
+        CHECK(!used[channel]);
+        used[channel] = true;
+        CHECK_EQ(channel, b.channel_at(i));     // The transmitter derives the same sequence
+    }
+
+    static const uint8_t other[5] = {0xEE, 0xDD, 0xCC, 0xBB, 0xAB};
+    b.start(0, other, sizeof(other), TICKS_PER_US, 0);
+    CHECK(memcmp(&a, &b, sizeof(a)) != 0);
+}
+
+static void test_acquire_and_track()
+{
+    const Scenario scenario = {50e-6, 10, -1, -1, -1};
+    Result result;
+    run(scenario, 20000, &result);
+
+    printf("acquire: first sync at hop %ld, synced %.1f%% of hops\n",
+           result.first_sync_hop, 100.0 * result.synced_hops / result.hops);
+
+    // Parked on one channel, the transmitter comes by within a cycle and a hop
+    CHECK(result.first_sync_hop >= 0 && result.first_sync_hop <= HOP_SEQUENCE_LENGTH + 1);
+    CHECK(result.synced_hops >= result.hops * 99 / 100);
+}
+
+static void test_outage()
+{
+    long total = 0, worst = 0, runs = 0;
+
+    // Outages past the sync loss end in every phase of the re-acquisition cycle
+    for (long length = HOP_SYNC_LOSS_HOPS + 1; length < HOP_PREDICTION_HOPS - HOP_SEQUENCE_LENGTH; length += 3)
+    {
+        const Scenario scenario = {50e-6, 0, 2000, 2000 + length, -1};
+        Result result;
+        run(scenario, 2400, &result);
+
+        CHECK(result.resync_hops >= 0 && result.resync_hops <= HOP_SEQUENCE_LENGTH + 1);
+        total += result.resync_hops;
+        worst = (result.resync_hops > worst) ? result.resync_hops : worst;
+        runs++;
+    }
+
+    printf("outage: back in sync %.1f hops after the outage on average, %ld at worst\n",
+           (double)total / runs, worst);
+
+    // Parking alone averages about half a cycle (7.3 hops in this scenario)
+    CHECK(3 * total < runs * HOP_SEQUENCE_LENGTH);
+}
+
+static void test_transmitter_restart()
+{
+    const Scenario scenario = {-30e-6, 0, -1, -1, 5000};
+    Result result;
+    run(scenario, 10000, &result);
+
+    printf("restart: back in sync %ld hops after the transmitter restarted\n", result.resync_hops);
+    CHECK(result.resync_hops >= 0 && result.resync_hops <= HOP_SYNC_LOSS_HOPS + HOP_SEQUENCE_LENGTH + 1);
+    CHECK(result.synced_hops >= result.hops * 98 / 100);
+}
+
+static void test_mode_and_beacons()
+{
+    FreqHopper hopper;
+    uint8_t beacon[HOP_BEACON_LENGTH] = {7, FRAME_TYPE_BEACON, 3, 0x2C, 0x01};   // Hop 3, 300 us in
+
+    hopper.request(true, 2);
+    CHECK(hopper.needs_switch());
+    CHECK_EQ(hopper.get_requested_pipe(), 2);
+
+    // Nothing is a beacon until the schedule runs
+    CHECK(!hopper.is_beacon(2, beacon, sizeof(beacon)));
+    hopper.start(hopper.get_requested_pipe(), ADDRESS, sizeof(ADDRESS), TICKS_PER_US, 0);
+    CHECK(!hopper.needs_switch());
+    CHECK(hopper.is_beacon(2, beacon, sizeof(beacon)));
+
+    // Other pipes, lengths and frame types go to their handlers
+    CHECK(!hopper.is_beacon(1, beacon, sizeof(beacon)));
+    CHECK(!hopper.is_beacon(2, beacon, sizeof(beacon) - 1));
+    beacon[1] = FRAME_TYPE_TEXT;
+    CHECK(!hopper.is_beacon(2, beacon, sizeof(beacon)));
+    beacon[1] = FRAME_TYPE_BEACON;
+
+    // The hop began 300 us plus the air time before the end of the beacon
+    uint32_t arrival = 1000000;
+    hopper.take_beacon(beacon, 100, arrival);
+    CHECK_EQ(hopper.get_state(), FreqHopper::HOP_SYNCED);
+    CHECK_EQ(hopper.get_stats().beacons, 1);
+    hopper.update(arrival);
+    CHECK_EQ(hopper.get_channel(), hopper.channel_at(3));
+    CHECK_EQ(hopper.ticks_to_next(arrival), (HOP_DWELL_US - 400) * TICKS_PER_US);
+
+    hopper.request(false, 2);
+    CHECK(hopper.needs_switch());
+    hopper.stop();
+    CHECK(!hopper.needs_switch());
+    CHECK(!hopper.is_beacon(2, beacon, sizeof(beacon)));
+}
+
+int main()
+{
+    test_sequence();
+    test_mode_and_beacons();
+    test_acquire_and_track();
+    test_outage();
+    test_transmitter_restart();
+    return host_test_result();
+}
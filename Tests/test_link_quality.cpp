@@ -0,0 +1,191 @@
+/*
+ * LinkQuality sequence tracking: retransmissions, late packets anywhere in the
+ * 64-number window and sender restarts, including a restart whose new numbers
+ * fall inside the window (every packet after it must still be handed over),
+ * and what is_degraded() makes of a sender's first packets and of silence.
+ */
+#include "link_quality.h"
+#include "host_test.h"
+#include <string.h>
+
+#define PIPE    1
+
+static TickType_t now;
+
+static LinkQuality::Verdict feed(LinkQuality& link, uint8_t seq)
+{
+    nrf24l01p_rx_packet packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.timestamp = now;
+    packet.pipe = PIPE;
+    packet.len = 8;
+    packet.rpd = 1;
+    packet.payload[0] = seq;
+    return link.record(&packet);
+}
+
+static void send(LinkQuality& link, uint8_t first, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        CHECK_EQ(feed(link, (uint8_t)(first + i)), LinkQuality::LINK_NEW);
+    }
+}
+
+static void test_in_order()
+{
+    LinkQuality link;
+    link.set_sequenced(PIPE, true);
+
+    // Wraps through 255 -> 0
+    for (uint16_t i = 0; i < 600; i++) {
+        CHECK_EQ(feed(link, (uint8_t)i), LinkQuality::LINK_NEW);
+    }
+    CHECK_EQ(link.get_stats(PIPE).lost, 0);
+    CHECK_EQ(link.get_stats(PIPE).resyncs, 0);
+    CHECK_EQ(link.get_stats(PIPE).delivery_score, 255);
+}
+
+static void test_retransmission_and_late()
+{
+    LinkQuality link;
+    link.set_sequenced(PIPE, true);
+
+    send(link, 0, 10);
+    CHECK_EQ(feed(link, 9), LinkQuality::LINK_DUPLICATE);      // Lost auto-ack
+    CHECK_EQ(feed(link, 9), LinkQuality::LINK_DUPLICATE);
+
+    CHECK_EQ(feed(link, 12), LinkQuality::LINK_NEW);
+    CHECK_EQ(link.get_stats(PIPE).lost, 2);
+    CHECK_EQ(feed(link, 10), LinkQuality::LINK_LATE);
+    CHECK_EQ(link.get_stats(PIPE).lost, 1);
+    CHECK_EQ(feed(link, 10), LinkQuality::LINK_DUPLICATE);
+
+    CHECK_EQ(link.get_stats(PIPE).duplicates, 3);
+    CHECK_EQ(link.get_stats(PIPE).reordered, 1);
+    CHECK_EQ(link.get_stats(PIPE).resyncs, 0);
+}
+
+static void test_reorder_across_window()
+{
+    LinkQuality link;
+    link.set_sequenced(PIPE, true);
+
+    // 20 arrives 20 numbers late, then the newest one is retransmitted
+    send(link, 0, 20);
+    send(link, 21, 20);
+    CHECK_EQ(link.get_stats(PIPE).lost, 1);
+    CHECK_EQ(feed(link, 20), LinkQuality::LINK_LATE);
+    CHECK_EQ(feed(link, 40), LinkQuality::LINK_DUPLICATE);
+    CHECK_EQ(feed(link, 20), LinkQuality::LINK_DUPLICATE);
+
+    // The window still holds: the next number is new, nothing is lost twice
+    CHECK_EQ(feed(link, 41), LinkQuality::LINK_NEW);
+    CHECK_EQ(link.get_stats(PIPE).lost, 0);
+    CHECK_EQ(link.get_stats(PIPE).reordered, 1);
+    CHECK_EQ(link.get_stats(PIPE).duplicates, 2);
+    CHECK_EQ(link.get_stats(PIPE).resyncs, 0);
+
+    // Every number received is looked up, back to the first one
+    for (uint8_t age = 1; age <= 41; age++) {
+        CHECK_EQ(feed(link, (uint8_t)(41 - age)), LinkQuality::LINK_DUPLICATE);
+    }
+    CHECK_EQ(link.get_stats(PIPE).resyncs, 0);
+    CHECK_EQ(link.get_stats(PIPE).lost, 0);
+}
+
+static void test_restart_inside_window()
+{
+    LinkQuality link;
+    link.set_sequenced(PIPE, true);
+
+    // 0..40 seen, then the sender reboots and counts from 0 again: 0..40 are all
+    // still in the bitmap, yet after the reboot's silence none of the new packets
+    // is a duplicate
+    send(link, 0, 41);
+    now += pdMS_TO_TICKS(LINK_RESTART_GAP_MS);
+    send(link, 0, 20);
+
+    CHECK_EQ(link.get_stats(PIPE).resyncs, 1);
+    CHECK_EQ(link.get_stats(PIPE).duplicates, 0);
+    CHECK_EQ(link.get_stats(PIPE).lost, 0);
+
+    // The new count is tracked as usual
+    CHECK_EQ(feed(link, 19), LinkQuality::LINK_DUPLICATE);
+    CHECK_EQ(feed(link, 21), LinkQuality::LINK_NEW);
+    CHECK_EQ(link.get_stats(PIPE).lost, 1);
+}
+
+static void test_restart_just_behind()
+{
+    LinkQuality link;
+    link.set_sequenced(PIPE, true);
+
+    // Without a silence a restart looks like retransmissions until
+    // LINK_RESYNC_DUPLICATES numbers in a row have counted up through old ones
+    send(link, 0, 41);
+    for (uint8_t seq = 0; seq < LINK_RESYNC_DUPLICATES - 1; seq++) {
+        CHECK_EQ(feed(link, seq), LinkQuality::LINK_DUPLICATE);
+    }
+    CHECK_EQ(feed(link, LINK_RESYNC_DUPLICATES - 1), LinkQuality::LINK_NEW);
+    send(link, LINK_RESYNC_DUPLICATES, 10);
+    CHECK_EQ(link.get_stats(PIPE).resyncs, 1);
+}
+
+static void test_restart_jump_sweep()
+{
+    // Every backward jump past the bitmap is a restart from its first packet
+    for (uint8_t jump = LINK_SEQ_WINDOW; jump < 128; jump++)
+    {
+        LinkQuality link;
+        link.set_sequenced(PIPE, true);
+
+        send(link, 0, 200);
+        uint8_t restart = (uint8_t)(199 - jump);
+        CHECK_EQ(feed(link, restart), LinkQuality::LINK_NEW);
+        CHECK_EQ(feed(link, (uint8_t)(restart + 1)), LinkQuality::LINK_NEW);
+        CHECK_EQ(link.get_stats(PIPE).resyncs, 1);
+        CHECK_EQ(link.get_stats(PIPE).duplicates, 0);
+    }
+}
+
+static void test_degraded()
+{
+    LinkQuality link;
+    link.set_sequenced(PIPE, true);
+
+    // Nobody heard yet, then every pipe stale: idle, not degraded
+    CHECK(!link.is_degraded(128));
+
+    // A sender that shows up late is judged on its losses, not on the empty history
+    now += pdMS_TO_TICKS(20000);
+    for (uint8_t seq = 0; seq < 5; seq++)
+    {
+        feed(link, seq);
+        CHECK(!link.is_degraded(128));
+    }
+    CHECK_EQ(link.get_stats(PIPE).delivery_score, 255);
+
+    // Heavy loss is degraded
+    for (uint8_t seq = 5; seq < 100; seq += 4) {
+        feed(link, seq);
+    }
+    CHECK(link.is_degraded(128));
+
+    // The sender goes quiet: idle again
+    now += pdMS_TO_TICKS(LINK_STALE_MS);
+    link.age(now);
+    CHECK(!link.is_degraded(128));
+}
+
+int main()
+{
+    test_in_order();
+    test_retransmission_and_late();
+    test_reorder_across_window();
+    test_restart_inside_window();
+    test_restart_just_behind();
+    test_restart_jump_sweep();
+    test_degraded();
+    return host_test_result();
+}
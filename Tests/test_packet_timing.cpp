@@ -0,0 +1,48 @@
+/*
+ * Packet timing: edge stamps handed to one drain only, polled packets stamped
+ * with the read time, and gap/latency statistics across the counter wrap.
+ */
+#include "packet_timing.h"
+#include "host_test.h"
+
+static void test_edge_stamps()
+{
+    PacketTiming timing;
+
+    // No edge: a polled packet gets the read time
+    CHECK_EQ(timing.take_arrival(500), 500);
+
+    // The latest edge goes to the next drain only
+    timing.stamp_edge(1000);
+    timing.stamp_edge(1200);
+    CHECK_EQ(timing.take_arrival(1300), 1200);
+    CHECK_EQ(timing.take_arrival(1400), 1400);
+}
+
+static void test_statistics()
+{
+    PacketTiming timing;
+    const PacketTiming::Stats& stats = timing.get_stats();
+
+    // Three packets of one batch, then one across the 32-bit wrap
+    timing.record(0xFFFFF000UL, 0xFFFFF100UL);
+    timing.record(0xFFFFF000UL, 0xFFFFF180UL);
+    timing.record(0xFFFFF000UL, 0xFFFFF200UL);
+    CHECK_EQ(stats.packets, 3);
+    CHECK_EQ(stats.min_gap_cycles, 0);
+    CHECK_EQ(stats.max_latency_cycles, 0x200);
+
+    timing.record(0x00000800UL, 0x00000900UL);
+    CHECK_EQ(stats.packets, 4);
+    CHECK_EQ(stats.last_gap_cycles, 0x1800);
+    CHECK_EQ(stats.max_gap_cycles, 0x1800);
+    CHECK_EQ(stats.last_latency_cycles, 0x100);
+    CHECK_EQ(stats.max_latency_cycles, 0x200);
+}
+
+int main()
+{
+    test_edge_stamps();
+    test_statistics();
+    return host_test_result();
+}
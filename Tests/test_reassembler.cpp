@@ -0,0 +1,246 @@
+/*
+ * Reassembler: messages rebuilt from shuffled and duplicated fragments,
+ * interleaved senders, timeouts and eviction when every slot is busy, and the
+ * reassembly cost per byte of ~1 KB messages.
+ */
+#include "reassembler.h"
+#include "host_test.h"
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+typedef std::vector<uint8_t> Bytes;
+
+struct Delivery
+{
+    uint8_t sender;
+    uint8_t type;
+    Bytes data;
+};
+
+static std::vector<Delivery> g_delivered;
+
+static void handler(uint8_t sender, uint8_t type, const uint8_t* data, uint16_t len, void* context)
+{
+    g_delivered.push_back(Delivery{sender, type, Bytes(data, data + len)});
+}
+
+/**
+ * @brief The sender's side of frame.h: message -> framed payloads.
+ */
+static std::vector<Bytes> fragment(uint8_t msg_id, const Bytes& message)
+{
+    std::vector<Bytes> fragments;
+    size_t count = (message.size() + FRAME_DATA_LENGTH - 1) / FRAME_DATA_LENGTH;
+
+    if (count == 0) {
+        count = 1;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t from = i * FRAME_DATA_LENGTH;
+        size_t to = std::min(message.size(), from + FRAME_DATA_LENGTH);
+        Bytes payload = {0, FRAME_TYPE_DATA, msg_id, (uint8_t)(i | ((i == count - 1) ? FRAME_FRAG_LAST : 0))};
+
+        payload.insert(payload.end(), message.begin() + from, message.begin() + to);
+        fragments.push_back(payload);
+    }
+    return fragments;
+}
+
+static Bytes random_message(std::mt19937& rng, size_t len)
+{
+    Bytes message(len);
+    for (uint8_t& b : message) {
+        b = (uint8_t)rng();
+    }
+    return message;
+}
+
+static void feed_all(Reassembler& reassembler, uint8_t sender, const std::vector<Bytes>& payloads, uint32_t now_ms)
+{
+    for (const Bytes& payload : payloads) {
+        reassembler.feed(sender, payload.data(), (length)payload.size(), now_ms);
+    }
+}
+
+static void test_shuffled_and_duplicated()
+{
+    std::mt19937 rng(1);
+    Reassembler reassembler;
+    reassembler.set_handler(handler, NULL);
+
+    for (uint16_t id = 0; id < 200; id++)
+    {
+        Bytes message = random_message(rng, 1 + rng() % FRAME_MAX_MESSAGE);
+        std::vector<Bytes> fragments = fragment((uint8_t)id, message);
+        std::vector<Bytes> air = fragments;
+
+        for (const Bytes& payload : fragments) {
+            if (rng() % 3 == 0) {
+                air.push_back(payload);     // Retransmitted after a lost auto-ack
+            }
+        }
+        std::shuffle(air.begin(), air.end(), rng);
+
+        g_delivered.clear();
+        feed_all(reassembler, 1, air, id * 10);
+        CHECK_EQ(g_delivered.size(), 1);
+        if (g_delivered.size() == 1)
+        {
+            CHECK(g_delivered[0].data == message);
+            CHECK_EQ(g_delivered[0].sender, 1);
+            CHECK_EQ(g_delivered[0].type, FRAME_TYPE_DATA);
+        }
+    }
+    CHECK_EQ(reassembler.pending(), 0);
+    CHECK_EQ(reassembler.get_stats().messages, 200);
+    CHECK_EQ(reassembler.get_stats().malformed, 0);
+}
+
+static void test_interleaved_senders()
+{
+    std::mt19937 rng(2);
+    Reassembler reassembler;
+    reassembler.set_handler(handler, NULL);
+
+    // Same message id from two senders: separate messages
+    Bytes a = random_message(rng, 900);
+    Bytes b = random_message(rng, 700);
+    std::vector<Bytes> fa = fragment(9, a);
+    std::vector<Bytes> fb = fragment(9, b);
+
+    g_delivered.clear();
+    for (size_t i = 0; i < std::max(fa.size(), fb.size()); i++)
+    {
+        if (i < fa.size()) {
+            reassembler.feed(3, fa[i].data(), (length)fa[i].size(), 0);
+        }
+        if (i < fb.size()) {
+            reassembler.feed(4, fb[i].data(), (length)fb[i].size(), 0);
+        }
+    }
+
+    CHECK_EQ(g_delivered.size(), 2);
+    if (g_delivered.size() == 2)
+    {
+        CHECK_EQ(g_delivered[0].sender, 4);
+        CHECK(g_delivered[0].data == b);
+        CHECK_EQ(g_delivered[1].sender, 3);
+        CHECK(g_delivered[1].data == a);
+    }
+}
+
+static void test_timeout_and_eviction()
+{
+    Reassembler reassembler;
+    reassembler.set_handler(handler, NULL);
+    g_delivered.clear();
+
+    // A lost fragment: nothing is delivered, the slot is freed after the timeout
+    std::vector<Bytes> fragments = fragment(1, Bytes(500, 7));
+    fragments.erase(fragments.begin() + 3);
+    feed_all(reassembler, 2, fragments, 1000);
+    CHECK(g_delivered.empty());
+    CHECK_EQ(reassembler.pending(), 1);
+
+    reassembler.expire(1000 + REASSEMBLY_TIMEOUT_MS - 1);
+    CHECK_EQ(reassembler.pending(), 1);
+    reassembler.expire(1000 + REASSEMBLY_TIMEOUT_MS);
+    CHECK_EQ(reassembler.pending(), 0);
+    CHECK_EQ(reassembler.get_stats().timeouts, 1);
+
+    // One partial message more than there are slots: the oldest makes room
+    for (uint8_t id = 0; id <= REASSEMBLY_SLOTS; id++)
+    {
+        Bytes first = fragment(id, Bytes(100, id))[0];
+        reassembler.feed(2, first.data(), (length)first.size(), 2000 + id);
+    }
+    CHECK_EQ(reassembler.pending(), REASSEMBLY_SLOTS);
+    CHECK_EQ(reassembler.get_stats().evictions, 1);
+
+    // The evicted message starts over; the newest completes
+    std::vector<Bytes> newest = fragment(REASSEMBLY_SLOTS, Bytes(100, REASSEMBLY_SLOTS));
+    feed_all(reassembler, 2, newest, 2100);
+    CHECK_EQ(g_delivered.size(), 1);
+    CHECK_EQ(reassembler.pending(), REASSEMBLY_SLOTS - 1);
+}
+
+static void test_single_fragment_and_late_copy()
+{
+    Reassembler reassembler;
+    reassembler.set_handler(handler, NULL);
+    g_delivered.clear();
+
+    std::vector<Bytes> single = fragment(5, Bytes{'h', 'i'});
+    feed_all(reassembler, 1, single, 0);
+    CHECK_EQ(g_delivered.size(), 1);
+    CHECK_EQ(reassembler.pending(), 0);
+
+    // A late copy of the message just delivered is not delivered again
+    feed_all(reassembler, 1, single, 1);
+    CHECK_EQ(g_delivered.size(), 1);
+    CHECK_EQ(reassembler.get_stats().duplicates, 1);
+}
+
+static void count_bytes(uint8_t sender, uint8_t type, const uint8_t* data, uint16_t len, void* context)
+{
+    *(uint32_t*)context += len;
+}
+
+static void test_cost_per_byte()
+{
+    std::mt19937 rng(5);
+    Reassembler reassembler;
+    uint32_t delivered = 0;
+    reassembler.set_handler(count_bytes, &delivered);
+
+    // Full-size messages, fragments in order and shuffled (the copy per fragment
+    // plus the bookkeeping RadioTask pays for every payload). Two message numbers
+    // take turns: a repeated one would be dropped as a late copy
+    const uint32_t rounds = 2000;
+    Bytes message = random_message(rng, FRAME_MAX_MESSAGE);
+    std::vector<Bytes> orders[2][2];
+    for (uint8_t id = 0; id < 2; id++)
+    {
+        orders[0][id] = fragment(id, message);
+        orders[1][id] = orders[0][id];
+        std::shuffle(orders[1][id].begin(), orders[1][id].end(), rng);
+    }
+
+    printf("order     message  fragments  ns/message  ns/byte\n");
+    for (int pass = 0; pass < 2; pass++)
+    {
+        double best = 1e30;
+
+        for (int run = 0; run < 5; run++)
+        {
+            delivered = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < rounds; i++) {
+                feed_all(reassembler, 1, orders[pass][i & 1], i);
+            }
+            auto end = std::chrono::steady_clock::now();
+            CHECK_EQ(delivered, rounds * (uint32_t)message.size());
+
+            double ns = std::chrono::duration<double, std::nano>(end - start).count() / rounds;
+            if (ns < best) {
+                best = ns;
+            }
+        }
+        printf("%-8s  %7u  %9u  %10.0f  %7.2f\n", pass ? "shuffled" : "in order",
+               (unsigned)message.size(), (unsigned)orders[pass][0].size(), best, best / message.size());
+    }
+}
+
+int main()
+{
+    test_shuffled_and_duplicated();
+    test_interleaved_senders();
+    test_timeout_and_eviction();
+    test_single_fragment_and_late_copy();
+    test_cost_per_byte();
+    return host_test_result();
+}
@@ -0,0 +1,131 @@
+/*
+ * Compile-time register image: apply_image() spends exactly the transactions
+ * Nrf24ConfigBuilder::transactions() promises, leaves the chip holding the
+ * image, and the readback pass catches a register that did not take.
+ */
+#include "nrf24l01p_device.h"
+#include "nrf24l01p_config.h"
+#include "fake_nrf24.h"
+#include "host.h"
+#include "host_test.h"
+
+static Nrf24Device<hspi1, HostCsPin, HostPin> radio;
+
+// The receiver's bring-up configuration (radio.cpp)
+static constexpr Nrf24ConfigBuilder RX_CONFIG = Nrf24ConfigBuilder()
+    .prx()
+    .power_up()
+    .rf_channel(76)
+    .data_rate(_1Mbps)
+    .tx_output_power(_0dBm)
+    .crc_length(1)
+    .address_width(5)
+    .auto_retransmit(3, 250)
+    .pipe(0, true, true, NRF24L01P_PAYLOAD_LENGTH)
+    .ack_payloads(true)
+    .mask_irq(NRF24L01P_CONFIG_MASK_TX_DS | NRF24L01P_CONFIG_MASK_MAX_RT);
+
+// Static-width pipes need their RX_PW_Pn written
+static constexpr Nrf24ConfigBuilder STATIC_CONFIG = Nrf24ConfigBuilder()
+    .prx()
+    .power_up()
+    .rf_channel(2)
+    .data_rate(_2Mbps)
+    .crc_length(2)
+    .address_width(3)
+    .pipe(0, false, false, 32)
+    .pipe(1, true, false, 8)
+    .pipe(2, true, true, 0);
+
+static uint32_t transactions(void)
+{
+    nrf24l01p_spi_stats stats;
+
+    radio.get_spi_stats(&stats);
+    return stats.spi_transactions;
+}
+
+static void setup(FakeNrf24& fake)
+{
+    host_reset();
+    host_set_scheduler_running(false);
+    host_spi_attach(FakeNrf24::spi, &fake);
+    radio.reset_spi_stats();
+}
+
+static void check_chip(const FakeNrf24& fake, const nrf24l01p_register_image& image)
+{
+    CHECK_EQ(fake.reg(NRF24L01P_REG_CONFIG), image.config);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_EN_AA), image.en_aa);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_EN_RXADDR), image.en_rxaddr);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_SETUP_AW), image.setup_aw);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_SETUP_RETR), image.setup_retr);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_RF_CH), image.rf_ch);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_RF_SETUP), image.rf_setup);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_DYNPD), image.dynpd);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_FEATURE), image.feature);
+
+    for (uint8_t pipe = 0; pipe < NRF24L01P_PIPE_COUNT; pipe++)
+    {
+        if (nrf24l01p_image_pipe_needs_width(&image, pipe)) {
+            CHECK_EQ(fake.reg(NRF24L01P_REG_RX_PW_P0 + pipe), image.rx_pw[pipe]);
+        }
+    }
+}
+
+static void test_transaction_count(const Nrf24ConfigBuilder& config)
+{
+    static const uint8_t junk[3] = {1, 2, 3};
+    nrf24l01p_register_image image = config.image();
+    FakeNrf24 fake;
+
+    for (bool verify : {false, true})
+    {
+        setup(fake);
+        fake.receive(0, junk, sizeof(junk));   // Left over from before the reset
+
+        CHECK(radio.apply_image(&image, verify));
+        CHECK_EQ(transactions(), config.transactions(verify));
+        CHECK_EQ(host_spi_get_stats()->split_windows, 0);
+        CHECK_EQ(fake.rx_count(), 0);
+        CHECK(!fake.irq());
+        check_chip(fake, image);
+    }
+}
+
+static void test_readback_mismatch()
+{
+    nrf24l01p_register_image image = RX_CONFIG.image();
+    FakeNrf24 fake;
+    setup(fake);
+
+    fake.stick(NRF24L01P_REG_RF_SETUP, 0x00);
+    CHECK(radio.apply_image(&image, false));    // Without readback nobody notices
+    CHECK(!radio.apply_image(&image, true));
+}
+
+static void test_against_step_by_step()
+{
+    nrf24l01p_register_image image = RX_CONFIG.image();
+    FakeNrf24 fake;
+    setup(fake);
+
+    radio.rx_init(76, _1Mbps);
+    uint32_t legacy = transactions();
+
+    radio.reset_spi_stats();
+    radio.apply_image(&image, false);
+
+    printf("bring-up: reset + rx_init %u transactions, register image %u\n",
+           (unsigned)legacy, (unsigned)transactions());
+    CHECK(transactions() < legacy);
+}
+
+int main()
+{
+    test_transaction_count(RX_CONFIG);
+    test_transaction_count(STATIC_CONFIG);
+    test_readback_mismatch();
+    test_against_step_by_step();
+    return host_test_result();
+}
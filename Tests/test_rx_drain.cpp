@@ -0,0 +1,142 @@
+/*
+ * Burst drain: three back-to-back packets behind one falling IRQ edge come out
+ * of the RX FIFO in one chain with a single RX_DR clear, and a packet landing
+ * after the clear is picked up by a rerun instead of being stranded with the
+ * IRQ line held low.
+ */
+#include "nrf24l01p_device.h"
+#include "fake_nrf24.h"
+#include "host.h"
+#include "host_test.h"
+
+#define READY_BIT   (1UL << 0)
+#define ERROR_BIT   (1UL << 1)
+
+static Nrf24Device<hspi1, HostCsPin, HostPin> radio;
+
+static void spi_cplt(SPI_HandleTypeDef* hspi)
+{
+    radio.on_spi_txrx_cplt(hspi);
+}
+
+static void spi_error(SPI_HandleTypeDef* hspi)
+{
+    radio.on_spi_error(hspi);
+}
+
+static void setup(FakeNrf24& fake)
+{
+    nrf24l01p_rx_engine_config config = {};
+
+    host_reset();
+    host_spi_attach(FakeNrf24::spi, &fake);
+    host_spi_on_complete(spi_cplt, spi_error);
+
+    radio.rx_engine_stop();
+    radio.enable_dynamic_payloads(0x3F);
+
+    config.task = xTaskGetCurrentTaskHandle();
+    config.ready_bits = READY_BIT;
+    config.error_bits = ERROR_BIT;
+    config.watermark = 1;
+    config.timeout_ms = 2;
+    CHECK(radio.rx_engine_start(&config));
+    host_spi_run_dma();         // The start-up chain finds the FIFO empty
+
+    fake.counters = FakeNrf24::Counters();
+}
+
+static void send(FakeNrf24& fake, uint8_t pipe, uint8_t tag, uint8_t len)
+{
+    uint8_t data[NRF24L01P_PAYLOAD_LENGTH];
+
+    memset(data, tag, sizeof(data));
+    CHECK(fake.receive(pipe, data, len));
+}
+
+static void expect(uint8_t pipe, uint8_t tag, uint8_t len, uint32_t arrival)
+{
+    nrf24l01p_packet_handle handle;
+
+    CHECK(radio.rx_engine_pop(&handle));
+    if (handle == NRF24L01P_PACKET_NONE) {
+        return;
+    }
+
+    nrf24l01p_rx_packet* packet = radio.rx_packet_get(handle);
+    CHECK_EQ(packet->pipe, pipe);
+    CHECK_EQ(packet->len, len);
+    CHECK_EQ(packet->payload[0], tag);
+    CHECK_EQ(packet->payload[len - 1], tag);
+    CHECK_EQ(packet->arrival, arrival);
+    radio.rx_packet_free(handle);
+}
+
+static void test_burst_of_three()
+{
+    FakeNrf24 fake;
+    nrf24l01p_rx_engine_stats stats;
+    setup(fake);
+    radio.rx_engine_get_stats(&stats);
+    uint32_t chains = stats.chains;
+
+    send(fake, 1, 0xA1, 32);
+    send(fake, 2, 0xA2, 7);
+    send(fake, 1, 0xA3, 1);
+    CHECK(fake.irq());
+
+    // One falling edge for the whole burst
+    radio.rx_engine_irq(1234);
+    host_spi_run_dma();
+
+    radio.rx_engine_get_stats(&stats);
+    CHECK_EQ(stats.chains - chains, 1);
+    CHECK_EQ(stats.packets, 3);
+    CHECK_EQ(stats.errors, 0);
+    CHECK_EQ(fake.counters.status_clears, 1);
+    CHECK_EQ(fake.rx_count(), 0);
+    CHECK(!fake.irq());
+
+    expect(1, 0xA1, 32, 1234);
+    expect(2, 0xA2, 7, 1234);
+    expect(1, 0xA3, 1, 1234);
+    CHECK_EQ(radio.rx_engine_pending(), 0);
+
+    uint32_t value = 0;
+    CHECK(xTaskNotifyWait(0, 0xFFFFFFFFUL, &value, 0) == pdTRUE);
+    CHECK(value & READY_BIT);
+    CHECK(!(value & ERROR_BIT));
+}
+
+static void test_packet_after_clear()
+{
+    FakeNrf24 fake;
+    nrf24l01p_rx_engine_stats stats;
+    setup(fake);
+
+    send(fake, 0, 0xB1, 4);
+    radio.rx_engine_irq(100);
+    host_spi_complete_dma(false);           // RX_DR cleared, chain goes on
+
+    send(fake, 0, 0xB2, 4);                 // New edge while the chain runs
+    radio.rx_engine_irq(200);
+    host_spi_run_dma();
+
+    radio.rx_engine_get_stats(&stats);
+    CHECK_EQ(stats.packets, 2);
+    CHECK_EQ(fake.rx_count(), 0);
+    CHECK(!fake.irq());                     // Nothing left holding the line low
+
+    expect(0, 0xB1, 4, 100);
+    nrf24l01p_packet_handle handle;
+    CHECK(radio.rx_engine_pop(&handle));
+    CHECK_EQ(radio.rx_packet_get(handle)->payload[0], 0xB2);
+    radio.rx_packet_free(handle);
+}
+
+int main()
+{
+    test_burst_of_three();
+    test_packet_after_clear();
+    return host_test_result();
+}
@@ -0,0 +1,186 @@
+/*
+ * IRQ/poll switching: RxModeController driven by a simulated RadioTask under
+ * constant packet rates. Prints the modelled CPU cost per second with the
+ * IRQ line alone and with adaptive polling, and checks the switching rules
+ * (threshold, hysteresis, early exit on idle, time accounting).
+ */
+#include "rx_mode.h"
+#include "host_test.h"
+#include <string.h>
+
+// Cost model (µs, STM32F411 at 100 MHz, rough): one interrupt entry/exit with
+// its handler, one task wakeup (notify + context switch both ways), one packet
+// through dispatch
+#define COST_ISR_US         2
+#define COST_WAKE_US        6
+#define COST_PACKET_US      10
+
+// Receive engine settings of radio.cpp
+#define ENGINE_WATERMARK    4
+#define ENGINE_TIMEOUT_MS   2
+
+struct SimResult
+{
+    uint32_t packets;
+    uint32_t wakeups;
+    uint32_t interrupts;
+    uint32_t cpu_us;
+    RxModeController::Stats stats;
+    RxModeController::Mode mode;
+};
+
+/**
+ * @brief Runs `ms` ticks of traffic at `pps` into the controller.
+ * @param adaptive false: the controller is ignored and the task always sleeps on the IRQ.
+ */
+static void simulate(RxModeController& ctl, TickType_t& tick, uint32_t pps, uint32_t ms,
+                     bool adaptive, SimResult* result)
+{
+    uint32_t spacing = (pps > 0) ? 1000000 / pps : 0;
+    uint32_t next = (pps > 0) ? tick * 1000 + spacing : UINT32_MAX;
+    uint32_t pending = 0;
+    TickType_t oldest = 0;
+
+    for (uint32_t end = tick + ms; tick < end; tick++)
+    {
+        uint32_t arrived = 0;
+
+        while (next < (tick + 1) * 1000)
+        {
+            arrived++;
+            next += spacing;
+        }
+        result->packets += arrived;
+
+        if (adaptive && ctl.get_mode() == RxModeController::RX_MODE_POLL)
+        {
+            // IRQ masked; one wakeup per period, the chain clears, reads RPD,
+            // then width + payload per packet and a last width probe
+            result->wakeups++;
+            result->interrupts += (arrived > 0) ? 3 + 2 * arrived : 1;
+            result->cpu_us += COST_WAKE_US + COST_PACKET_US * arrived;
+            ctl.update((uint8_t)arrived, tick);
+            continue;
+        }
+
+        // IRQ mode: every packet is an edge and a chain of its own (EXTI, clear,
+        // RPD, width, payload, width); the task wakes at the watermark or timeout
+        result->interrupts += 6 * arrived;
+        for (uint32_t n = 0; n < arrived; n++)
+        {
+            if (pending++ == 0) {
+                oldest = tick;
+            }
+            if (pending >= ENGINE_WATERMARK)
+            {
+                result->wakeups++;
+                result->cpu_us += COST_WAKE_US + COST_PACKET_US * pending;
+                if (adaptive) {
+                    ctl.update((uint8_t)pending, tick);
+                }
+                pending = 0;
+            }
+        }
+        if (pending > 0 && tick - oldest >= ENGINE_TIMEOUT_MS)
+        {
+            result->wakeups++;
+            result->cpu_us += COST_WAKE_US + COST_PACKET_US * pending;
+            if (adaptive) {
+                ctl.update((uint8_t)pending, tick);
+            }
+            pending = 0;
+        }
+    }
+
+    result->cpu_us += COST_ISR_US * result->interrupts;
+    result->stats = ctl.get_stats();
+    result->mode = ctl.get_mode();
+}
+
+static void run(uint32_t pps, bool adaptive, SimResult* result)
+{
+    RxModeController ctl;
+    TickType_t tick = 0;
+
+    memset(result, 0, sizeof(*result));
+    ctl.start(tick);
+    simulate(ctl, tick, pps, 1000, adaptive, result);
+}
+
+static void test_throughput_table()
+{
+    static const uint32_t rates[] = {100, 500, 1000, 2000, 3000};
+
+    printf("  pps   IRQ: wake/pkt  cpu us/s   adaptive: wake/pkt  cpu us/s  mode\n");
+    for (uint32_t pps : rates)
+    {
+        SimResult irq, adaptive;
+        run(pps, false, &irq);
+        run(pps, true, &adaptive);
+
+        printf("%5u   %13.2f  %8u   %18.2f  %8u  %s\n", (unsigned)pps,
+               (double)irq.wakeups / irq.packets, (unsigned)irq.cpu_us,
+               (double)adaptive.wakeups / adaptive.packets, (unsigned)adaptive.cpu_us,
+               adaptive.mode == RxModeController::RX_MODE_POLL ? "poll" : "irq");
+
+        if (pps < RX_POLL_ENTER_PPS)
+        {
+            CHECK_EQ(adaptive.stats.to_poll, 0);
+            CHECK_EQ(adaptive.cpu_us, irq.cpu_us);
+        }
+        else
+        {
+            CHECK(adaptive.mode == RxModeController::RX_MODE_POLL);
+            CHECK_EQ(adaptive.stats.to_poll, 1);
+
+            // Near the threshold a poll takes about one packet, so the two
+            // are at break-even; the gain comes above it
+            if (pps >= 2 * RX_POLL_ENTER_PPS) {
+                CHECK(adaptive.cpu_us < irq.cpu_us);
+            } else {
+                CHECK(adaptive.cpu_us < irq.cpu_us + irq.cpu_us / 10);
+            }
+        }
+    }
+}
+
+static void test_hysteresis_and_idle()
+{
+    RxModeController ctl;
+    TickType_t tick = 0;
+    SimResult result = {};
+    ctl.start(tick);
+
+    simulate(ctl, tick, 2000, 200, true, &result);
+    CHECK(ctl.get_mode() == RxModeController::RX_MODE_POLL);
+
+    // Between the exit and the entry rate: stays polling, no flapping
+    simulate(ctl, tick, 600, 500, true, &result);
+    CHECK(ctl.get_mode() == RxModeController::RX_MODE_POLL);
+    CHECK_EQ(ctl.get_stats().to_irq, 0);
+
+    // Below the exit rate: back to the IRQ within one window
+    simulate(ctl, tick, 200, RX_POLL_RATE_WINDOW_MS + 1, true, &result);
+    CHECK(ctl.get_mode() == RxModeController::RX_MODE_IRQ);
+    CHECK_EQ(ctl.get_stats().to_irq, 1);
+
+    // Traffic stops dead: polling ends after RX_POLL_IDLE_POLLS empty polls
+    simulate(ctl, tick, 2000, 200, true, &result);
+    CHECK(ctl.get_mode() == RxModeController::RX_MODE_POLL);
+    TickType_t stopped = tick;
+    simulate(ctl, tick, 0, RX_POLL_IDLE_POLLS, true, &result);
+    CHECK(ctl.get_mode() == RxModeController::RX_MODE_IRQ);
+    CHECK(tick - stopped <= RX_POLL_IDLE_POLLS);
+
+    // Time in each mode adds up to the elapsed time (banked at every switch)
+    ctl.set_mode(RxModeController::RX_MODE_IRQ, tick);
+    CHECK_EQ(ctl.get_stats().irq_ticks + ctl.get_stats().poll_ticks, tick);
+    CHECK(ctl.get_stats().polls >= ctl.get_stats().empty_polls + RX_POLL_IDLE_POLLS - 1);
+}
+
+int main()
+{
+    test_throughput_table();
+    test_hysteresis_and_idle();
+    return host_test_result();
+}
@@ -0,0 +1,213 @@
+/*
+ * SecureLink: counter sync after boot, replay window, forgeries. A receiver
+ * that reboots must not take back any packet recorded before the reboot,
+ * sync answers included.
+ */
+#include "secure_link.h"
+#include "host.h"
+#include "host_test.h"
+#include <string.h>
+
+#define PIPE    1
+
+static const uint8_t KEY[CHACHAPOLY_KEY_LENGTH] = {0x42, 0x17, 0x99};
+static const uint8_t ADDRESS[5] = {0xEE, 0xDD, 0xCC, 0xBB, 0xAA};
+
+/**
+ * @brief The transmitter's side of the format in secure_link.h.
+ */
+struct Sender
+{
+    uint32_t counter;
+
+    nrf24l01p_rx_packet seal(const uint8_t* text, length len, uint32_t at)
+    {
+        nrf24l01p_rx_packet packet;
+        uint8_t nonce[CHACHAPOLY_NONCE_LENGTH] = {0};
+        uint8_t tag[CHACHAPOLY_TAG_LENGTH];
+        uint32_t ctr = this->counter++;
+
+        memset(&packet, 0, sizeof(packet));
+        packet.pipe = PIPE;
+        packet.arrival = at;
+        for (uint8_t i = 0; i < SECURE_COUNTER_LENGTH; i++) {
+            packet.payload[i] = (uint8_t)(ctr >> (8 * i));
+        }
+        memcpy(&packet.payload[SECURE_COUNTER_LENGTH], text, len);
+
+        memcpy(nonce, ADDRESS, sizeof(ADDRESS));
+        memcpy(&nonce[8], &packet.payload[0], SECURE_COUNTER_LENGTH);
+        chachapoly_seal(KEY, nonce, packet.payload, SECURE_COUNTER_LENGTH,
+                        &packet.payload[SECURE_COUNTER_LENGTH], len, tag);
+        memcpy(&packet.payload[SECURE_COUNTER_LENGTH + len], tag, SECURE_TAG_LENGTH);
+        packet.len = len + SECURE_OVERHEAD;
+        return packet;
+    }
+
+    nrf24l01p_rx_packet text(const char* text, uint32_t at)
+    {
+        return this->seal((const uint8_t*)text, strlen(text), at);
+    }
+};
+
+static bool opens(SecureLink& link, nrf24l01p_rx_packet packet)
+{
+    return link.open(&packet);
+}
+
+/**
+ * @brief First packet, the auto-ack with the challenge, the sealed echo.
+ * @return The echo, for replaying later.
+ */
+static nrf24l01p_rx_packet sync(SecureLink& link, Sender& sender, uint32_t at)
+{
+    uint8_t request[SECURE_SYNC_LENGTH];
+
+    CHECK(!opens(link, sender.text("hello?", at)));
+    CHECK(link.get_sync_request(PIPE, request));
+    CHECK_EQ(request[0], SECURE_SYNC_TAG);
+
+    nrf24l01p_rx_packet echo = sender.seal(request, sizeof(request), at + 1000);
+    CHECK(!opens(link, echo));
+    CHECK(!link.get_sync_request(PIPE, request));
+    return echo;
+}
+
+static void test_sync()
+{
+    SecureLink link;
+    Sender sender = {1000};
+    uint8_t request[SECURE_SYNC_LENGTH];
+
+    link.set_key(PIPE, KEY, ADDRESS);
+
+    // Nothing to ask before the sender has been heard
+    CHECK(!link.get_sync_request(PIPE, request));
+
+    CHECK(!opens(link, sender.text("data", 123456)));
+    CHECK(link.get_sync_request(PIPE, request));
+    CHECK(!opens(link, sender.text("more", 123999)));
+    CHECK_EQ(link.get_stats(PIPE).unsynced, 2);
+
+    // A wrong echo does not sync
+    uint8_t wrong[SECURE_SYNC_LENGTH];
+    memcpy(wrong, request, sizeof(wrong));
+    wrong[1] ^= 1;
+    CHECK(!opens(link, sender.seal(wrong, sizeof(wrong), 124000)));
+    CHECK(link.get_sync_request(PIPE, request));
+
+    // The right one does; data flows from then on
+    CHECK(!opens(link, sender.seal(request, sizeof(request), 125000)));
+    CHECK_EQ(link.get_stats(PIPE).syncs, 1);
+
+    nrf24l01p_rx_packet packet = sender.text("payload", 126000);
+    CHECK(link.open(&packet));
+    CHECK_EQ(packet.len, 7);
+    CHECK(memcmp(packet.payload, "payload", 7) == 0);
+    CHECK_EQ(link.get_stats(PIPE).accepted, 1);
+}
+
+static void test_replay_window()
+{
+    SecureLink link;
+    Sender sender = {0};
+
+    link.set_key(PIPE, KEY, ADDRESS);
+    sync(link, sender, 5000);
+
+    sender.counter = 100;
+    nrf24l01p_rx_packet first = sender.text("a", 0);
+    CHECK(opens(link, first));
+    CHECK(!opens(link, first));                             // Replay
+
+    sender.counter = 98;
+    nrf24l01p_rx_packet late = sender.text("late", 0);
+    CHECK(opens(link, late));                               // Reordered, inside the window
+    CHECK(!opens(link, late));
+
+    sender.counter = 30;
+    CHECK(!opens(link, sender.text("old", 0)));             // Behind the window
+
+    // A forgery far ahead must not move the window
+    sender.counter = 100000;
+    nrf24l01p_rx_packet forged = sender.text("jump", 0);
+    forged.payload[SECURE_COUNTER_LENGTH] ^= 1;
+    CHECK(!opens(link, forged));
+    sender.counter = 101;
+    CHECK(opens(link, sender.text("next", 0)));
+
+    CHECK_EQ(link.get_stats(PIPE).forged, 1);
+    CHECK_EQ(link.get_stats(PIPE).replayed, 3);
+}
+
+static void test_reboot()
+{
+    Sender sender = {0};
+    nrf24l01p_rx_packet recorded[8];
+    nrf24l01p_rx_packet old_echo;
+
+    // Before the reboot: an eavesdropper records the sync and the traffic
+    {
+        SecureLink link;
+        link.set_key(PIPE, KEY, ADDRESS);
+        old_echo = sync(link, sender, 777);
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            recorded[i] = sender.text("cmd", 0);
+            CHECK(opens(link, recorded[i]));
+        }
+    }
+
+    // After it, none of that is taken: not the data, not the old echo
+    host_advance_us(1234);
+    SecureLink link;
+    link.set_key(PIPE, KEY, ADDRESS);
+    for (uint8_t i = 0; i < 8; i++) {
+        CHECK(!opens(link, recorded[i]));
+    }
+    CHECK(!opens(link, old_echo));
+    CHECK_EQ(link.get_stats(PIPE).syncs, 0);
+    CHECK_EQ(link.get_stats(PIPE).accepted, 0);
+
+    // The sender answers the new challenge and carries on with its counter
+    uint8_t request[SECURE_SYNC_LENGTH];
+    CHECK(link.get_sync_request(PIPE, request));
+    CHECK(!opens(link, sender.seal(request, sizeof(request), 0)));
+    CHECK_EQ(link.get_stats(PIPE).syncs, 1);
+    CHECK(opens(link, sender.text("fresh", 0)));
+
+    // Recordings from before stay behind the new window
+    for (uint8_t i = 0; i < 8; i++) {
+        CHECK(!opens(link, recorded[i]));
+    }
+}
+
+static void test_rekey()
+{
+    SecureLink link;
+    Sender sender = {0};
+    uint8_t request[SECURE_SYNC_LENGTH];
+
+    link.set_key(PIPE, KEY, ADDRESS);
+    sync(link, sender, 42);
+    CHECK(opens(link, sender.text("x", 0)));
+
+    // A new key (same one here) starts over with a sync
+    link.set_key(PIPE, KEY, ADDRESS);
+    CHECK(!opens(link, sender.text("y", 99)));
+    CHECK(link.get_sync_request(PIPE, request));
+
+    link.clear_key(PIPE);
+    CHECK(!link.is_secure(PIPE));
+    CHECK(!link.get_sync_request(PIPE, request));
+}
+
+int main()
+{
+    host_reset();
+    test_sync();
+    test_replay_window();
+    test_reboot();
+    test_rekey();
+    return host_test_result();
+}
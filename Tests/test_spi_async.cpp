@@ -0,0 +1,155 @@
+/*
+ * Asynchronous (DMA) payload reads: the task sleeps in xTaskNotifyWait while
+ * the frame is clocked, the completion interrupt wakes it, and a transfer
+ * that never completes is aborted after its timeout.
+ */
+#include "nrf24l01p_device.h"
+#include "fake_nrf24.h"
+#include "host.h"
+#include "host_test.h"
+
+static Nrf24Device<hspi1, HostCsPin, HostPin> radio;
+static FakeNrf24* chip;
+
+static void spi_cplt(SPI_HandleTypeDef* hspi)
+{
+    radio.on_spi_txrx_cplt(hspi);
+}
+
+static void spi_error(SPI_HandleTypeDef* hspi)
+{
+    radio.on_spi_error(hspi);
+}
+
+static void setup(FakeNrf24& fake)
+{
+    host_reset();
+    chip = &fake;
+    host_spi_attach(FakeNrf24::spi, chip);
+    host_spi_on_complete(spi_cplt, spi_error);
+    radio.reset_spi_stats();
+}
+
+static void fill(uint8_t* data, uint8_t seed)
+{
+    for (uint8_t i = 0; i < NRF24L01P_PAYLOAD_LENGTH; i++) {
+        data[i] = (uint8_t)(seed + i);
+    }
+}
+
+static void test_read_sleeps_on_dma()
+{
+    FakeNrf24 fake;
+    uint8_t sent[NRF24L01P_PAYLOAD_LENGTH];
+    uint8_t got[NRF24L01P_PAYLOAD_LENGTH] = {0};
+    setup(fake);
+
+    fill(sent, 0x40);
+    fake.receive(1, sent, sizeof(sent));
+
+    uint8_t status = radio.read_rx_fifo(got);
+    const host_spi_stats* bus = host_spi_get_stats();
+
+    CHECK(memcmp(got, sent, sizeof(sent)) == 0);
+    CHECK_EQ(NRF24L01P_STATUS_RX_P_NO(status), 1);
+    CHECK_EQ(bus->dma, 1);
+    CHECK_EQ(bus->blocking, 0);
+    CHECK_EQ(bus->cs_windows, 1);
+    CHECK_EQ(bus->outside_cs, 0);
+    CHECK(!host_spi_dma_pending());
+    CHECK_EQ(xTaskGetTickCount(), 0);     // Woken by the completion, not the timeout
+
+    nrf24l01p_spi_stats stats;
+    radio.get_spi_stats(&stats);
+    CHECK_EQ(stats.spi_transactions, 1);
+    CHECK_EQ(stats.spi_bytes, NRF24L01P_PAYLOAD_LENGTH + 1);
+}
+
+static void test_blocking_before_scheduler()
+{
+    FakeNrf24 fake;
+    uint8_t sent[NRF24L01P_PAYLOAD_LENGTH];
+    uint8_t got[NRF24L01P_PAYLOAD_LENGTH] = {0};
+    setup(fake);
+    host_set_scheduler_running(false);
+
+    fill(sent, 0x10);
+    fake.receive(0, sent, sizeof(sent));
+    radio.read_rx_fifo(got);
+
+    CHECK(memcmp(got, sent, sizeof(sent)) == 0);
+    CHECK_EQ(host_spi_get_stats()->dma, 0);
+    CHECK_EQ(host_spi_get_stats()->blocking, 1);
+}
+
+static void test_foreign_bits_survive()
+{
+    FakeNrf24 fake;
+    uint8_t sent[NRF24L01P_PAYLOAD_LENGTH];
+    uint8_t got[NRF24L01P_PAYLOAD_LENGTH];
+    uint32_t value = 0;
+    setup(fake);
+
+    // An event for the task's own loop arrives before the read starts
+    xTaskNotify(xTaskGetCurrentTaskHandle(), 0x01, eSetBits);
+
+    fill(sent, 0x70);
+    fake.receive(2, sent, sizeof(sent));
+    radio.read_rx_fifo(got);
+
+    CHECK(memcmp(got, sent, sizeof(sent)) == 0);
+    CHECK(xTaskNotifyWait(0, 0xFFFFFFFFUL, &value, 0) == pdTRUE);
+    CHECK(value & 0x01);
+    CHECK(!(value & NRF24L01P_NOTIFY_SPI_DONE));
+}
+
+static void test_stalled_dma_times_out()
+{
+    FakeNrf24 fake;
+    uint8_t sent[NRF24L01P_PAYLOAD_LENGTH];
+    uint8_t got[NRF24L01P_PAYLOAD_LENGTH];
+    setup(fake);
+
+    host_spi_stall(true);
+    CHECK(radio.transfer_async(NRF24L01P_CMD_R_RX_PAYLOAD, NULL, NRF24L01P_PAYLOAD_LENGTH));
+    CHECK(!radio.transfer_async(NRF24L01P_CMD_R_RX_PAYLOAD, NULL, NRF24L01P_PAYLOAD_LENGTH));   // Busy
+    CHECK(!radio.transfer_wait(NULL, got, NRF24L01P_PAYLOAD_LENGTH, 5));
+
+    CHECK_EQ(host_spi_get_stats()->aborts, 1);
+    CHECK(!host_spi_dma_pending());
+    CHECK(xTaskGetTickCount() >= pdMS_TO_TICKS(5));
+
+    // The bus is usable again
+    host_spi_stall(false);
+    fill(sent, 0x33);
+    fake.receive(3, sent, sizeof(sent));
+    CHECK(radio.transfer_async(NRF24L01P_CMD_R_RX_PAYLOAD, NULL, NRF24L01P_PAYLOAD_LENGTH));
+    CHECK(radio.transfer_wait(NULL, got, NRF24L01P_PAYLOAD_LENGTH, 5));
+    CHECK(memcmp(got, sent, sizeof(sent)) == 0);
+}
+
+static void test_dma_error()
+{
+    FakeNrf24 fake;
+    uint8_t got[NRF24L01P_PAYLOAD_LENGTH];
+    setup(fake);
+
+    CHECK(radio.transfer_async(NRF24L01P_CMD_R_RX_PAYLOAD, NULL, NRF24L01P_PAYLOAD_LENGTH));
+    host_spi_complete_dma(true);
+    CHECK(!radio.transfer_wait(NULL, got, NRF24L01P_PAYLOAD_LENGTH, 5));
+    CHECK_EQ(host_spi_get_stats()->aborts, 0);
+
+    // A late completion of the failed transfer does not satisfy the next wait
+    CHECK(radio.transfer_async(NRF24L01P_CMD_NOP, NULL, 0));
+    CHECK(radio.transfer_wait(NULL, NULL, 0, 5));
+}
+
+int main()
+{
+    test_read_sleeps_on_dma();
+    test_blocking_before_scheduler();
+    test_foreign_bits_survive();
+    test_stalled_dma_times_out();
+    test_dma_error();
+    return host_test_result();
+}
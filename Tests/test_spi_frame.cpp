@@ -0,0 +1,188 @@
+/*
+ * Single-frame SPI primitive: every command clocks its command byte and data
+ * in one HAL call inside one CS window and hands back the STATUS byte shifted
+ * out with the command. Also prints the per-packet SPI cost of a receive
+ * before (the original split command/data frames, replayed through the fake)
+ * and after.
+ */
+#include "nrf24l01p_device.h"
+#include "fake_nrf24.h"
+#include "host.h"
+#include "host_test.h"
+
+static Nrf24Device<hspi1, HostCsPin, HostPin> radio;
+
+static void setup(FakeNrf24& fake)
+{
+    host_reset();
+    host_set_scheduler_running(false);
+    host_spi_attach(FakeNrf24::spi, &fake);
+    radio.reset_spi_stats();
+}
+
+static void check_one_frame_per_window(const FakeNrf24& fake)
+{
+    const host_spi_stats* bus = host_spi_get_stats();
+
+    CHECK_EQ(bus->split_windows, 0);
+    CHECK_EQ(bus->outside_cs, 0);
+    CHECK_EQ(bus->cs_windows, fake.counters.frames);
+}
+
+static void test_register_access()
+{
+    FakeNrf24 fake;
+    const uint8_t address[5] = {0x11, 0x22, 0x33, 0x44, 0x55};
+    nrf24l01p_spi_stats stats;
+    setup(fake);
+
+    radio.set_rf_channel(76);
+    CHECK_EQ(fake.reg(NRF24L01P_REG_RF_CH), 76);
+    CHECK_EQ(fake.counters.frames, 1);
+
+    radio.set_rx_address_p0(address);
+    CHECK(memcmp(fake.rx_address(0), address, 5) == 0);
+    CHECK_EQ(fake.counters.frames, 2);
+    CHECK_EQ(fake.counters.bytes, 2 + 6);
+
+    fake.set_reg(NRF24L01P_REG_RPD, 1);
+    CHECK(radio.get_rpd());
+    CHECK_EQ(fake.counters.frames, 3);
+
+    radio.get_spi_stats(&stats);
+    CHECK_EQ(stats.spi_transactions, 3);
+    CHECK_EQ(stats.spi_bytes, 2 + 6 + 2);
+    check_one_frame_per_window(fake);
+}
+
+static void test_status_from_command_byte()
+{
+    FakeNrf24 fake;
+    const uint8_t data[4] = {1, 2, 3, 4};
+    setup(fake);
+
+    CHECK_EQ(NRF24L01P_STATUS_RX_P_NO(radio.get_status()), NRF24L01P_RX_P_NO_EMPTY);
+    CHECK_EQ(fake.counters.bytes, 1);       // NOP alone
+
+    fake.receive(4, data, sizeof(data));
+    uint8_t status = radio.get_status();
+    CHECK(status & NRF24L01P_STATUS_RX_DR);
+    CHECK_EQ(NRF24L01P_STATUS_RX_P_NO(status), 4);
+    check_one_frame_per_window(fake);
+}
+
+// HAL calls of the replayed baseline: it clocked the command byte and its data separately
+static uint32_t g_baseline_calls;
+
+/**
+ * @brief One command as the original driver sent it: command byte, then data,
+ *        in one CS window. The fake decodes whole frames, so the bytes go in
+ *        one call and the split is counted.
+ */
+static uint8_t baseline_frame(uint8_t* tx, uint8_t* rx, uint16_t len)
+{
+    HostCsPin::reset();
+    HAL_SPI_TransmitReceive(&hspi1, tx, rx, len, 2000);
+    HostCsPin::set();
+    g_baseline_calls += (len > 1) ? 2 : 1;
+    return rx[0];
+}
+
+/**
+ * @brief The original nrf24l01p_rx_receive(): a fixed-width R_RX_PAYLOAD, then
+ *        clear_rx_dr() as a NOP for STATUS and a W_REGISTER of it with RX_DR set.
+ */
+static void baseline_rx_receive(uint8_t* payload)
+{
+    uint8_t tx[1 + NRF24L01P_PAYLOAD_LENGTH] = {NRF24L01P_CMD_R_RX_PAYLOAD};
+    uint8_t rx[1 + NRF24L01P_PAYLOAD_LENGTH];
+
+    baseline_frame(tx, rx, sizeof(tx));
+    memcpy(payload, &rx[1], NRF24L01P_PAYLOAD_LENGTH);
+
+    tx[0] = NRF24L01P_CMD_NOP;
+    uint8_t status = baseline_frame(tx, rx, 1);
+
+    tx[0] = NRF24L01P_CMD_W_REGISTER | NRF24L01P_REG_STATUS;
+    tx[1] = status | NRF24L01P_STATUS_RX_DR;
+    baseline_frame(tx, rx, 2);
+}
+
+static void test_cost_per_packet()
+{
+    FakeNrf24 fake;
+    uint8_t data[NRF24L01P_PAYLOAD_LENGTH];
+    uint8_t got[NRF24L01P_PAYLOAD_LENGTH];
+    nrf24l01p_spi_stats stats;
+    const host_spi_stats* bus = host_spi_get_stats();
+    setup(fake);
+
+    for (uint8_t i = 0; i < sizeof(data); i++) {
+        data[i] = i;
+    }
+
+    printf("receive                  CS windows/packet  HAL calls/packet  bytes/packet\n");
+
+    // Before: every command split in two HAL calls, and a read-modify-write of STATUS
+    g_baseline_calls = 0;
+    uint32_t windows = bus->cs_windows;
+    uint32_t bytes = fake.counters.bytes;
+    for (uint8_t n = 0; n < 3; n++)
+    {
+        fake.receive(1, data, sizeof(data));
+        baseline_rx_receive(got);
+        CHECK(memcmp(got, data, sizeof(data)) == 0);
+    }
+    CHECK_EQ(fake.counters.status_clears, 3);
+    CHECK_EQ(bus->cs_windows - windows, 3 * 3);
+    CHECK_EQ(g_baseline_calls, 3 * 5);
+    printf("before: rx_receive       %17.1f  %16.1f  %12.1f\n", (bus->cs_windows - windows) / 3.0,
+           g_baseline_calls / 3.0, (fake.counters.bytes - bytes) / 3.0);
+
+    // After: one frame per command, STATUS written without reading it first
+    radio.reset_spi_stats();
+    uint32_t calls = bus->blocking;
+    for (uint8_t n = 0; n < 3; n++)
+    {
+        fake.receive(1, data, sizeof(data));
+        radio.rx_receive(got);
+        CHECK(memcmp(got, data, sizeof(data)) == 0);
+    }
+    radio.get_spi_stats(&stats);
+    CHECK_EQ(stats.spi_transactions, 2 * 3);                      // R_RX_PAYLOAD + W_REGISTER STATUS
+    CHECK_EQ(fake.counters.status_clears, 6);
+    CHECK_EQ(bus->blocking - calls, 2 * 3);
+    printf("after:  rx_receive       %17.1f  %16.1f  %12.1f\n", stats.spi_transactions / 3.0,
+           (bus->blocking - calls) / 3.0, stats.spi_bytes / 3.0);
+
+    for (length width = 1; width <= NRF24L01P_PAYLOAD_LENGTH; width += 31)
+    {
+        radio.reset_spi_stats();
+        calls = bus->blocking;
+        for (uint8_t n = 0; n < 3; n++)
+        {
+            length len = 0;
+            fake.receive(1, data, width);
+            uint8_t status = radio.read_rx_fifo_dynamic(got, &len);
+            CHECK_EQ(len, width);
+            CHECK_EQ(NRF24L01P_STATUS_RX_P_NO(status), 1);
+            CHECK(memcmp(got, data, width) == 0);
+        }
+
+        radio.get_spi_stats(&stats);
+        CHECK_EQ(stats.rx_packets, 3);
+        CHECK_EQ(stats.spi_transactions, 2 * 3);                  // R_RX_PL_WID + R_RX_PAYLOAD
+        CHECK_EQ(stats.spi_bytes, 3 * (2 + 1 + width));
+        printf("after:  dynamic, %2u B    %17.1f  %16.1f  %12.1f\n", width, stats.spi_transactions / 3.0,
+               (bus->blocking - calls) / 3.0, stats.spi_bytes / 3.0);
+    }
+    check_one_frame_per_window(fake);
+}
+
+int main()
+{
+    test_register_access();
+    test_status_from_command_byte();
+    test_cost_per_packet();
+    return host_test_result();
+}
@@ -0,0 +1,144 @@
+/*
+ * SpscRing under two real threads: every element arrives once, in order and
+ * never half-written, through both the copying and the in-place interfaces.
+ */
+#include "spsc_ring.h"
+#include "host_test.h"
+#include <string.h>
+#include <thread>
+
+#define STRESS_COUNT    200000
+
+struct Item
+{
+    uint32_t seq;
+    uint8_t data[32];
+};
+
+static bool intact(const Item& item, uint32_t seq)
+{
+    if (item.seq != seq) {
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(item.data); i++)
+    {
+        if (item.data[i] != (uint8_t)(seq + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void fill(Item& item, uint32_t seq)
+{
+    item.seq = seq;
+    for (uint8_t i = 0; i < sizeof(item.data); i++) {
+        item.data[i] = (uint8_t)(seq + i);
+    }
+}
+
+static void test_single_thread()
+{
+    SpscRing<uint32_t, 4> ring;
+    uint32_t value = 0;
+
+    CHECK(ring.empty());
+    CHECK(!ring.pop(value));
+    for (uint32_t i = 0; i < 4; i++) {
+        CHECK(ring.push(i));
+    }
+    CHECK(ring.full());
+    CHECK(!ring.push(99));
+    CHECK_EQ(ring.overflow_count(), 1);
+
+    CHECK(ring.pop(value));
+    CHECK_EQ(value, 0);
+    CHECK(ring.push(4));
+    for (uint32_t i = 1; i <= 4; i++)
+    {
+        CHECK(ring.pop(value));
+        CHECK_EQ(value, i);
+    }
+    CHECK(ring.empty());
+}
+
+static void test_copy_stress()
+{
+    static SpscRing<Item, 8> ring;
+    uint32_t bad = 0;
+
+    std::thread producer([] {
+        for (uint32_t seq = 0; seq < STRESS_COUNT;)
+        {
+            Item item;
+            fill(item, seq);
+            if (ring.push(item)) {
+                seq++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (uint32_t seq = 0; seq < STRESS_COUNT;)
+    {
+        Item item;
+        if (!ring.pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        bad += intact(item, seq) ? 0 : 1;
+        seq++;
+    }
+    producer.join();
+
+    CHECK_EQ(bad, 0);
+    CHECK(ring.empty());
+    printf("copy: %u items, %u rejected pushes\n", STRESS_COUNT, (unsigned)ring.overflow_count());
+}
+
+static void test_in_place_stress()
+{
+    static SpscRing<Item, 4> ring;
+    uint32_t bad = 0;
+
+    std::thread producer([] {
+        for (uint32_t seq = 0; seq < STRESS_COUNT;)
+        {
+            Item* slot = ring.prepare();
+            if (slot == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            fill(*slot, seq++);
+            ring.commit();
+        }
+    });
+
+    for (uint32_t seq = 0; seq < STRESS_COUNT;)
+    {
+        const Item* slot = ring.front();
+        if (slot == nullptr)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        bad += intact(*slot, seq) ? 0 : 1;
+        ring.release();
+        seq++;
+    }
+    producer.join();
+
+    CHECK_EQ(bad, 0);
+    CHECK(ring.empty());
+}
+
+int main()
+{
+    test_single_thread();
+    test_copy_stress();
+    test_in_place_stress();
+    return host_test_result();
+}